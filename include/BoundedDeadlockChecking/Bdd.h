@@ -0,0 +1,245 @@
+/**
+ * @file Bdd.h
+ * @brief A small package of reduced ordered binary decision diagrams (ROBDD): a unique table per variable, a computed cache, garbage collection by reference counting and dynamic variable reordering by sifting.
+ * BDDs are numbers of nodes of a BddManager. The nodes reachable from a BDD stay valid as long as it is referenced (see bdd_ref): garbage collection and reordering only happen when an operation starts, and may free every node which is not referenced, except the operands of that operation. Reordering preserves the numbers of the nodes kept, so referenced BDDs keep denoting the same functions.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_BDD_H
+#define COCA_BDD_H
+
+#include <stdbool.h>
+
+/**
+ * @brief A set of BDD nodes over a fixed number of variables, with their tables.
+ */
+typedef struct BddManager_s *BddManager;
+
+/**
+ * @brief A BDD: the number of its root node in its BddManager.
+ */
+typedef int bdd;
+
+/**
+ * @brief The constant false.
+ */
+#define BDD_FALSE 0
+
+/**
+ * @brief The constant true.
+ */
+#define BDD_TRUE 1
+
+/**
+ * @brief Creates a manager for BDDs over variables 0 to @p num_vars - 1, initially ordered by their numbers.
+ *
+ * @param num_vars The number of variables.
+ * @return BddManager The manager, to be freed with bdd_manager_delete.
+ */
+BddManager bdd_manager_create(int num_vars);
+
+/**
+ * @brief Deallocates memory used by @p manager and all its BDDs.
+ *
+ * @param manager
+ */
+void bdd_manager_delete(BddManager manager);
+
+/**
+ * @brief Allows or forbids reordering the variables of @p manager by sifting when the number of nodes doubled since the last reordering.
+ *
+ * @param manager
+ * @param automatic
+ */
+void bdd_set_auto_reorder(BddManager manager, bool automatic);
+
+/**
+ * @brief Increments the reference count of @p f, protecting it from garbage collection.
+ *
+ * @param manager
+ * @param f
+ * @return bdd @p f.
+ */
+bdd bdd_ref(BddManager manager, bdd f);
+
+/**
+ * @brief Decrements the reference count of @p f. Its nodes are freed by the next garbage collection if they are no longer referenced.
+ *
+ * @param manager
+ * @param f
+ */
+void bdd_deref(BddManager manager, bdd f);
+
+/**
+ * @brief Returns the BDD of variable @p var.
+ *
+ * @param manager
+ * @param var
+ * @return bdd
+ */
+bdd bdd_var(BddManager manager, int var);
+
+/**
+ * @brief Returns the BDD of the negation of @p f.
+ *
+ * @param manager
+ * @param f
+ * @return bdd
+ */
+bdd bdd_not(BddManager manager, bdd f);
+
+/**
+ * @brief Returns the BDD of the conjunction of @p f and @p g.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @return bdd
+ */
+bdd bdd_and(BddManager manager, bdd f, bdd g);
+
+/**
+ * @brief Returns the BDD of the disjunction of @p f and @p g.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @return bdd
+ */
+bdd bdd_or(BddManager manager, bdd f, bdd g);
+
+/**
+ * @brief Returns the BDD of if @p f then @p g else @p h.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @param h
+ * @return bdd
+ */
+bdd bdd_ite(BddManager manager, bdd f, bdd g, bdd h);
+
+/**
+ * @brief Returns the BDD of the conjunction of the variables in @p vars (a cube, to give the variables to quantify).
+ *
+ * @param manager
+ * @param vars The variables.
+ * @param num_vars The number of variables.
+ * @return bdd
+ */
+bdd bdd_cube(BddManager manager, const int *vars, int num_vars);
+
+/**
+ * @brief Returns the BDD of the existential quantification of @p f over the variables of @p cube.
+ *
+ * @param manager
+ * @param f
+ * @param cube A cube (see bdd_cube).
+ * @return bdd
+ */
+bdd bdd_exists(BddManager manager, bdd f, bdd cube);
+
+/**
+ * @brief Returns the BDD of the existential quantification of the conjunction of @p f and @p g over the variables of @p cube (relational product), without building the conjunction.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @param cube A cube (see bdd_cube).
+ * @return bdd
+ */
+bdd bdd_and_exists(BddManager manager, bdd f, bdd g, bdd cube);
+
+/**
+ * @brief Returns the BDD of @p f in which every variable v is replaced by variable @p permutation[v].
+ *
+ * @param manager
+ * @param f
+ * @param permutation An array giving a variable for each variable of @p manager.
+ * @return bdd
+ */
+bdd bdd_permute(BddManager manager, bdd f, const int *permutation);
+
+/**
+ * @brief Evaluates @p f on @p assignment.
+ *
+ * @param manager
+ * @param f
+ * @param assignment An array giving a value to each variable of @p manager.
+ * @return true
+ * @return false
+ */
+bool bdd_evaluate(BddManager manager, bdd f, const bool *assignment);
+
+/**
+ * @brief Writes in @p assignment a value for each variable of @p manager satisfying @p f (variables on which the choice does not matter are false).
+ *
+ * @param manager
+ * @param f
+ * @param assignment An array of the size of the number of variables of @p manager.
+ * @return true if @p f is satisfiable.
+ * @return false otherwise (@p assignment is then left untouched).
+ */
+bool bdd_pick_assignment(BddManager manager, bdd f, bool *assignment);
+
+/**
+ * @brief Returns the number of assignments of all the variables of @p manager satisfying @p f.
+ *
+ * @param manager
+ * @param f
+ * @return double
+ */
+double bdd_sat_count(BddManager manager, bdd f);
+
+/**
+ * @brief Returns the number of nodes of @p f (terminals included).
+ *
+ * @param manager
+ * @param f
+ * @return long
+ */
+long bdd_node_count(BddManager manager, bdd f);
+
+/**
+ * @brief Returns the number of nodes allocated in @p manager (referenced or not).
+ *
+ * @param manager
+ * @return long
+ */
+long bdd_live_nodes(BddManager manager);
+
+/**
+ * @brief Returns the largest number of nodes allocated at the same time in @p manager.
+ *
+ * @param manager
+ * @return long
+ */
+long bdd_peak_nodes(BddManager manager);
+
+/**
+ * @brief Returns the number of reorderings of the variables of @p manager done so far.
+ *
+ * @param manager
+ * @return int
+ */
+int bdd_num_reorderings(BddManager manager);
+
+/**
+ * @brief Frees the nodes of @p manager which are not referenced.
+ *
+ * @param manager
+ */
+void bdd_gc(BddManager manager);
+
+/**
+ * @brief Reorders the variables of @p manager by sifting: each variable in turn is moved through all levels by swaps of adjacent levels, and left where the number of nodes was the smallest. Frees the nodes which are not referenced.
+ *
+ * @param manager
+ */
+void bdd_reorder(BddManager manager);
+
+#endif
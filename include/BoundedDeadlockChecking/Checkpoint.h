@@ -0,0 +1,121 @@
+/**
+ * @file Checkpoint.h
+ * @brief Checkpoint files of long-running deadlock searches, from which a search can be resumed after a crash or a preemption.
+ * A checkpoint file starts with a header identifying the engine and the automata it was written for (by a fingerprint of their structure), followed by data specific to the engine. It is written next to its final place and renamed, so that a crash while writing leaves the previous checkpoint intact, and it is read by mapping it in memory.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_CHECKPOINT_H
+#define COCA_CHECKPOINT_H
+
+#include "LockAutomaton.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The engines that can write checkpoints.
+ */
+typedef enum
+{
+    CHECKPOINT_EXPLICIT = 1, ///< The breadth-first search of deadlock_explicit_search_checkpointed.
+    CHECKPOINT_IC3 = 2       ///< The IC3/PDR engine of deadlock_ic3_checkpointed.
+} checkpoint_kind;
+
+/**
+ * @brief How a search is checkpointed.
+ */
+typedef struct
+{
+    const char *file; ///< The checkpoint file.
+    double interval;  ///< The minimal number of seconds between two checkpoints.
+    bool resume;      ///< Whether to resume from the checkpoint file if it exists (and matches the automata).
+} checkpoint_options;
+
+/**
+ * @brief A checkpoint file mapped in memory (see checkpoint_map).
+ */
+typedef struct
+{
+    void *address;     ///< The start of the mapping (NULL if no checkpoint was mapped).
+    size_t size;       ///< The size of the mapping.
+    const char *data;  ///< The data of the engine (just after the header).
+    size_t data_size;  ///< The size of the data of the engine.
+} checkpoint_mapping;
+
+/**
+ * @brief Returns a fingerprint of the structure of @p automata (number of nodes, initial node, edges and actions of each automaton), identifying the instance a checkpoint was written for.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return uint64_t
+ */
+uint64_t checkpoint_fingerprint(LockAutomaton *automata, int num_automata);
+
+/**
+ * @brief Returns the current time in seconds (monotonic clock), to schedule checkpoints.
+ *
+ * @return double
+ */
+double checkpoint_now(void);
+
+/**
+ * @brief Tells if a checkpoint is due: @p options is not NULL and at least @p options->interval seconds passed since *@p last. If so, *@p last is set to the current time.
+ *
+ * @param options The checkpoint options (possibly NULL).
+ * @param last The time of the last checkpoint (or of the start of the search).
+ * @return true
+ * @return false
+ */
+bool checkpoint_due(const checkpoint_options *options, double *last);
+
+/**
+ * @brief Starts writing a checkpoint: opens a temporary file next to @p options->file and writes the header.
+ *
+ * @param options The checkpoint options.
+ * @param kind The engine writing the checkpoint.
+ * @param fingerprint The fingerprint of the automata (see checkpoint_fingerprint).
+ * @return FILE* The file, in which the engine writes its data, or NULL if it cannot be opened.
+ */
+FILE *checkpoint_begin(const checkpoint_options *options, checkpoint_kind kind, uint64_t fingerprint);
+
+/**
+ * @brief Appends zero bytes to @p file so that its size is a multiple of 8 (to keep the next data aligned in the mapping).
+ *
+ * @param file A checkpoint file being written.
+ */
+void checkpoint_align(FILE *file);
+
+/**
+ * @brief Ends writing a checkpoint: closes @p file and renames it to @p options->file if no error happened.
+ *
+ * @param options The checkpoint options.
+ * @param file The file returned by checkpoint_begin.
+ * @return true if the checkpoint was written.
+ * @return false otherwise (the previous checkpoint is then kept).
+ */
+bool checkpoint_end(const checkpoint_options *options, FILE *file);
+
+/**
+ * @brief Maps the checkpoint file of @p options in memory, if resuming is asked and the file exists, was written by @p kind and for the automata of fingerprint @p fingerprint.
+ *
+ * @param options The checkpoint options (possibly NULL).
+ * @param kind The engine resuming.
+ * @param fingerprint The fingerprint of the automata.
+ * @param mapping Receives the mapping (its address is NULL if there is no valid checkpoint).
+ * @return true if a checkpoint was mapped.
+ * @return false otherwise.
+ */
+bool checkpoint_map(const checkpoint_options *options, checkpoint_kind kind, uint64_t fingerprint, checkpoint_mapping *mapping);
+
+/**
+ * @brief Unmaps a checkpoint mapped by checkpoint_map.
+ *
+ * @param mapping
+ */
+void checkpoint_unmap(checkpoint_mapping *mapping);
+
+#endif
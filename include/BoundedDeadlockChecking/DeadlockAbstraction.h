@@ -0,0 +1,46 @@
+/**
+ * @file DeadlockAbstraction.h
+ * @brief Counterexample-guided abstraction refinement on the locks for the Bounded Deadlock Checking problem: the SAT reduction is built over a few locks only (see deadlock_abstract_reduction), and locks are added when the solver finds a spurious deadlock.
+ * On instances with many locks where the deadlock (or its absence) only depends on a few, the formulae solved stay much smaller than the one of deadlock_reduction.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_ABSTRACTION_H
+#define COCA_DEADLOCK_ABSTRACTION_H
+
+#include "LockAutomaton.h"
+#include <z3.h>
+
+/**
+ * @brief Statistics of an abstraction refinement (see deadlock_abstraction_refinement).
+ */
+typedef struct
+{
+    int num_iterations; ///< The number of abstract formulae solved.
+    int num_locks;      ///< The number of locks which may be acquired.
+    int num_tracked;    ///< The number of locks tracked in the last abstraction.
+} abstraction_statistics;
+
+/**
+ * @brief Decides whether a deadlock of size @p bound exists between the automata in @p automata by abstraction refinement.
+ * No lock is tracked at first. At each iteration, the abstraction tracking the current locks is solved: if it is unsatisfiable, there is no deadlock of size @p bound. Otherwise, the path of its model is replayed on the automata (see witness_validate): if it is a deadlock, it is returned. If it is spurious, the locks explaining why are tracked from then on. Once the moves of the path are fixed, the locks are independent, so this explanation is computed by replaying each lock alone: the locks acquired while taken or released while free, and for each automaton which can still move at the end, the lock of one of its possible edges.
+ * Each iteration tracks at least one more lock, so that there are at most as many iterations as locks.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The size of the deadlock searched for.
+ * @param path An array of size @p bound, receiving the deadlock found (if any).
+ * @param statistics If not NULL, receives the statistics of the refinement.
+ * @return Z3_lbool Z3_L_TRUE if there is a deadlock of size @p bound, Z3_L_FALSE if there is none, Z3_L_UNDEF if the solver could not decide.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ */
+Z3_lbool deadlock_abstraction_refinement(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, step *path, abstraction_statistics *statistics);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file DeadlockCompiled.h
+ * @brief A compiled model checker for the Deadlock Checking problem: a C program specialised for an instance (successor function made of a switch on the node of each automaton, lock tests and updates folded into constants, fixed state width) is generated, compiled with the system compiler and run as the search engine.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_COMPILED_H
+#define COCA_DEADLOCK_COMPILED_H
+
+#include "LockAutomaton.h"
+#include <stdio.h>
+#include <z3.h>
+
+/**
+ * @brief Writes in @p file the source of a C program searching a deadlock in the parallel execution of the automata in @p automata.
+ * The program takes the bound as its only argument (a negative bound, or no argument, asks for a shortest deadlock of any length) and runs a breadth-first search of the product.
+ * It prints "states N" (the number of states visited), then either "no deadlock", or "deadlock K" followed by the K steps of a path leading to it, one per line as "automaton source target action".
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param file The file the source is written to.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+void deadlock_compiled_generate(LockAutomaton *automata, int num_automata, FILE *file);
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata with a program generated by deadlock_compiled_generate.
+ * The program is compiled in a temporary directory with the compiler given by the environment variable CC (cc by default), run, and removed.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound If non-negative, only deadlocks reached after exactly @p bound steps are looked for (Bounded Deadlock Checking problem). If negative, a shortest deadlock of any length is looked for.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param num_states If not NULL, will contain the number of states visited.
+ * @return Z3_lbool Z3_L_TRUE if a deadlock was found, Z3_L_FALSE if there is none, Z3_L_UNDEF if the program could not be generated, compiled or run.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_compiled_search(LockAutomaton *automata, int num_automata, int bound, step **path, int *size_path, long *num_states);
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file DeadlockCounter.h
+ * @brief Counter abstraction for the Deadlock Checking problem: identical automata (typically the same file given several times) are not distinguished, a state only records how many of them are in each node.
+ * Since locks have no owner, this abstraction is exact, and the number of states is polynomial in the number of identical automata instead of exponential.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_COUNTER_H
+#define COCA_DEADLOCK_COUNTER_H
+
+#include "LockAutomaton.h"
+
+/**
+ * @brief Returns the number of classes of identical automata in @p automata (two automata are identical if they have the same nodes, initial node, edges and actions; names do not matter).
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return int
+ */
+int counter_num_classes(LockAutomaton *automata, int num_automata);
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata by a breadth-first search of the counter-abstracted product.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound If non-negative, only deadlocks reached after exactly @p bound steps are looked for (Bounded Deadlock Checking problem). If negative, a shortest deadlock of any length is looked for.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller), over the automata of @p automata. Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param num_states If not NULL, will contain the number of abstract states visited.
+ * @return true if a deadlock is found.
+ * @return false otherwise.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_counter_search(LockAutomaton *automata, int num_automata, int bound, step **path, int *size_path, long *num_states);
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file DeadlockExplicit.h
+ * @brief Explicit-state algorithms deciding whether a deadlock is reachable (at any length) in the product of LockAutomata, built on LockProduct: exhaustive breadth-first search, and bitstate hashing for state spaces too big for memory.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_EXPLICIT_H
+#define COCA_DEADLOCK_EXPLICIT_H
+
+#include "LockAutomaton.h"
+#include "Checkpoint.h"
+#include <z3.h>
+
+/**
+ * @brief Decides whether a deadlock is reachable in the parallel execution of the automata in @p automata, by a breadth-first search of the reachable states of their product.
+ * The deadlock found (if any) is a shortest one.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param num_states If not NULL, will contain the number of states visited.
+ * @return true if a deadlock is reachable.
+ * @return false otherwise.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_explicit_search(LockAutomaton *automata, int num_automata, step **path, int *size_path, long *num_states);
+
+/**
+ * @brief Same as deadlock_explicit_search, checkpointing the search as described by @p options: every @p options->interval seconds, the states visited, their parents and the frontier are written in @p options->file.
+ * If @p options->resume is set and the file holds a checkpoint for the same automata, the search continues from it.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path See deadlock_explicit_search.
+ * @param size_path See deadlock_explicit_search.
+ * @param num_states See deadlock_explicit_search.
+ * @param options The checkpoint options (NULL for none).
+ * @return true if a deadlock is reachable.
+ * @return false otherwise.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_explicit_search_checkpointed(LockAutomaton *automata, int num_automata, step **path, int *size_path, long *num_states, const checkpoint_options *options);
+
+/**
+ * @brief The heuristics guiding deadlock_heuristic_search.
+ */
+typedef enum
+{
+    HEURISTIC_DISTANCE, ///< The sum over the automata of the distance to a node where they may get stuck (see la_distances_to_stuck_nodes). It is admissible, so the search is an A* and finds a shortest deadlock.
+    HEURISTIC_BLOCKED,  ///< The number of automata which can still move (greedy best-first search).
+    HEURISTIC_LOCKS     ///< The number of locks free (greedy best-first search).
+} search_heuristic;
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata by a best-first search of their product, expanding first the states closest to a deadlock according to @p heuristic.
+ * With HEURISTIC_DISTANCE, states are ordered by their depth plus the heuristic (A*), and states from which some automaton cannot reach a node where it may get stuck are pruned: the deadlock found is a shortest one. The other heuristics order states by the heuristic only, which finds deep deadlocks sooner but not necessarily shortest ones.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param heuristic The heuristic.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param num_states If not NULL, will contain the number of states visited.
+ * @return true if a deadlock is reachable.
+ * @return false otherwise.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_heuristic_search(LockAutomaton *automata, int num_automata, search_heuristic heuristic, step **path, int *size_path, long *num_states);
+
+/**
+ * @brief What deadlock_context_bounded_search bounds.
+ */
+typedef enum
+{
+    BOUND_CONTEXT_SWITCHES, ///< Every move of an automaton other than the last one to move is a context switch.
+    BOUND_PREEMPTIONS       ///< Only the context switches taking place while the last automaton to move could still move count (preemptions).
+} switch_bound;
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata reachable with few context switches (or preemptions), by iterative context bounding: the executions with no switch are explored first, then those with one switch, and so on up to @p max_switches.
+ * The states of the product are extended with the last automaton to move. Each iteration only expands the states which need exactly its number of switches, starting from the successors set aside by the previous iteration, so that states are never explored twice.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound What is bounded.
+ * @param max_switches The maximal number of switches.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param switches Will contain the number of switches of the path found (the smallest possible).
+ * @param num_states If not NULL, will contain the number of extended states visited.
+ * @return Z3_lbool Z3_L_TRUE if a deadlock was found, Z3_L_FALSE if every reachable state was explored without finding one (no deadlock is reachable), Z3_L_UNDEF if there is no deadlock within @p max_switches switches.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_context_bounded_search(LockAutomaton *automata, int num_automata, switch_bound bound, int max_switches, step **path, int *size_path, int *switches, long *num_states);
+
+/**
+ * @brief Statistics of a bitstate search (see deadlock_bitstate_search).
+ */
+typedef struct
+{
+    long num_states;           ///< The number of states stored (seen as new).
+    double fill_ratio;         ///< The proportion of bits set in the bit array at the end of the search.
+    double expected_omissions; ///< The expected number of states wrongly seen as visited because of hash collisions (sum over the states stored of the probability that all their bits were already set).
+    double coverage;           ///< The estimated proportion of the reachable states visited.
+} bitstate_statistics;
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata by a depth-first search of their product storing states in a bit array (bitstate hashing, or supertrace): a state is only represented by @p num_hashes bits, and is considered visited if they are all set.
+ * The memory used is 2^@p log_size bits plus the stack of the search, whatever the number of states. Collisions may make the search miss states (hence deadlocks), but a deadlock found is always real. The deadlock found is not necessarily a shortest one.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param log_size The base 2 logarithm of the number of bits of the array (between 6 and 40).
+ * @param num_hashes The number of bits (hash functions) per state.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param statistics If not NULL, receives the statistics of the search.
+ * @return true if a deadlock was found.
+ * @return false otherwise (no deadlock is reachable only if the coverage is complete).
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_bitstate_search(LockAutomaton *automata, int num_automata, int log_size, int num_hashes, step **path, int *size_path, bitstate_statistics *statistics);
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * @file DeadlockExternal.h
+ * @brief External-memory breadth-first search of the product of LockAutomata, for state spaces bigger than the memory.
+ * Each layer of the search is a file of states sorted without duplicates. Successors are buffered in memory, sorted and written as runs, which are merged; duplicates are removed afterwards by merging with the sorted file of the states already visited (delayed duplicate detection). Files are only read and written sequentially.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_EXTERNAL_H
+#define COCA_DEADLOCK_EXTERNAL_H
+
+#include "LockAutomaton.h"
+#include <z3.h>
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata by an external-memory breadth-first search of their product.
+ * The path to the deadlock is rebuilt afterwards by scanning the layer files backwards, looking for a predecessor of each state of the path in the previous layer.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound If non-negative, only deadlocks reached after exactly @p bound steps are looked for (Bounded Deadlock Checking problem; duplicates are then only removed inside each layer). If negative, a shortest deadlock of any length is looked for.
+ * @param directory The directory where the files of the search are written (a temporary subdirectory is created in it, and removed at the end).
+ * @param buffer_states The number of states buffered in memory before being sorted and written as a run.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param num_states If not NULL, will contain the number of states visited.
+ * @return Z3_lbool Z3_L_TRUE if a deadlock was found, Z3_L_FALSE if there is none, Z3_L_UNDEF if the files could not be written or read.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_external_search(LockAutomaton *automata, int num_automata, int bound, const char *directory, long buffer_states, step **path, int *size_path, long *num_states);
+
+#endif
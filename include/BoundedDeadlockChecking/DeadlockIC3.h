@@ -0,0 +1,50 @@
+/**
+ * @file DeadlockIC3.h
+ * @brief An unbounded deadlock checker for LockAutomata based on IC3/PDR (property directed reachability), using incremental Z3 queries over the one-step transition relation of the product of the automata.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+#ifndef COCA_DEADLOCK_IC3_H
+#define COCA_DEADLOCK_IC3_H
+
+#include "LockAutomaton.h"
+#include "Checkpoint.h"
+#include <z3.h>
+
+/**
+ * @brief Decides whether a deadlock is reachable (at any length) in the parallel execution of the automata in @p automata, using IC3/PDR.
+ * Contrary to deadlock_reduction, no bound has to be guessed: either a path leading to a deadlock is found, or an inductive invariant excluding every deadlock is computed.
+ *
+ * @param ctx The solver context, with or without reference counting (see make_context_rc).
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param print_invariant If true and no deadlock is reachable, prints the inductive invariant proving it (in terms of nodes of the automata and lock states).
+ * @return Z3_lbool Z3_L_TRUE if a deadlock is reachable, Z3_L_FALSE if no deadlock is reachable, Z3_L_UNDEF if the solver could not decide one of the queries.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_ic3(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path, bool print_invariant);
+
+/**
+ * @brief Same as deadlock_ic3, checkpointing the search as described by @p options: when a frame is completed and @p options->interval seconds passed since the last checkpoint, the number of frames and the lemmas learnt are written in @p options->file.
+ * If @p options->resume is set and the file holds a checkpoint for the same automata, the frames are rebuilt from its lemmas and the search continues with the next frame.
+ *
+ * @param ctx The solver context, with or without reference counting (see make_context_rc).
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path See deadlock_ic3.
+ * @param size_path See deadlock_ic3.
+ * @param print_invariant See deadlock_ic3.
+ * @param options The checkpoint options (NULL for none).
+ * @return Z3_lbool See deadlock_ic3.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_ic3_checkpointed(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path, bool print_invariant, const checkpoint_options *options);
+
+#endif
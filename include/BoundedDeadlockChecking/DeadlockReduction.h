@@ -14,6 +14,17 @@
 #include "Graph.h"
 #include "LockAutomaton.h"
 #include <z3.h>
+#include <stdio.h>
+
+/**
+ * @brief How the state of the locks is encoded in the formula.
+ */
+typedef enum
+{
+    LOCK_ENCODING_TAKEN,   ///< One variable per lock and step, telling whether the lock is taken.
+    LOCK_ENCODING_ONE_HOT, ///< One variable per lock, step and automaton which may acquire the lock, telling whether it holds it.
+    LOCK_ENCODING_BINARY   ///< The owner of each lock at each step (or none) is a number written on logarithmically many variables.
+} lock_encoding;
 
 /**
  * @brief Generates a propositional formula satisfiable if and only if there exists a parallel execution of size @p bound between the automata in @p automata.
@@ -22,13 +33,109 @@
  * @param automata The LockAutomata considered.
  * @param num_automata The number of automata.
  * @param bound The size of the deadlock searched for.
- * @return Z3_ast The formula
+ * @return Z3_ast The formula, kept (see keep_formula): to be released with release_formula once solved.
  * 
  * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
  * @pre bound >= 0.
  */
 Z3_ast deadlock_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound);
 
+/**
+ * @brief Generates a propositional formula satisfiable if and only if there exists a parallel execution of @p bound steps in the ∃-step semantics leading to a deadlock.
+ * In this semantics, several automata may move at the same step, provided their moves act on distinct locks (such moves are independent, so they can be executed in any order).
+ * A deadlock found is thus of size between @p bound and @p bound * @p num_automata in the usual interleaving semantics.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of parallel steps.
+ * @return Z3_ast The formula, kept (see keep_formula): to be released with release_formula once solved.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ */
+Z3_ast deadlock_parallel_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound);
+
+/**
+ * @brief Generates the formula of deadlock_reduction (or deadlock_parallel_reduction if @p parallel), with the state of the locks encoded as given by @p encoding.
+ * With an encoding of the owners, each acquisition records the automaton holding the lock, which lets the solver prune much earlier: an automaton in a node where it must hold a lock is its owner, and the owner of a lock is in a node where it may hold it (see la_compute_locksets). Only the automata which may acquire a lock are its possible owners.
+ * As locks have no owner in the semantics of the automata (a lock taken may be released by any automaton), releases are only tied to the owner when every automaton only releases the locks it holds: both semantics then coincide, and the formula is equisatisfiable with the one of deadlock_reduction. Models of both give paths with la_path_from_model (or la_parallel_path_from_model).
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param parallel Whether to use the ∃-step semantics.
+ * @param encoding How the state of the locks is encoded.
+ * @return Z3_ast The formula, kept (see keep_formula): to be released with release_formula once solved.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ */
+Z3_ast deadlock_encoded_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding);
+
+/**
+ * @brief Generates an abstraction of the formula of deadlock_reduction, where only the locks in @p tracked_lock are constrained. The others may be taken or not at any step, whatever the moves: the edges acting on them are always possible and change nothing, and may or may not be blocked at the end.
+ * Every deadlock of size @p bound is thus a model of the formula (if it is unsatisfiable, so is the one of deadlock_reduction), but a model may give a spurious path. The formula only grows with the locks tracked.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The size of the deadlock searched for.
+ * @param tracked_lock For each lock number from 0 to the biggest lock used, whether it is tracked.
+ * @return Z3_ast The formula, kept (see keep_formula): to be released with release_formula once solved.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ */
+Z3_ast deadlock_abstract_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, const bool *tracked_lock);
+
+/**
+ * @brief Writes the formula of deadlock_encoded_reduction in @p file, in CNF in the DIMACS format (see fb_write_dimacs), for external SAT solvers.
+ * The variables keep their names in comments ("c NUMBER NAME").
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param parallel Whether to use the ∃-step semantics.
+ * @param encoding How the state of the locks is encoded.
+ * @param file The file written, opened for writing.
+ * @return long The number of clauses written.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ */
+long deadlock_reduction_dimacs(LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding, FILE *file);
+
+/**
+ * @brief A call to the solver made by deadlock_minimal_length.
+ */
+typedef struct
+{
+    int bound;       ///< The bound probed: is a deadlock reachable in at most this number of steps?
+    Z3_lbool result; ///< The answer of the solver.
+    double seconds;  ///< The time spent by the solver.
+} bound_probe;
+
+/**
+ * @brief Looks for the minimal length of a deadlock between the automata in @p automata, up to @p max_bound steps, with a single incremental solver.
+ * Since a deadlock of a given size does not imply one of a bigger size, the probes ask for a deadlock in at most k steps: the transitions of each step and the deadlock at each step are only enforced under a selector variable, and each probe is a query under the assumption that one of the steps up to k is deadlocked. The bound gallops (1, 2, 4, 8, ...) until a deadlock is found, then a binary search between the last two bounds finds the minimal one. The steps are only encoded once, when a probe first needs them, and every query reuses the clauses learnt by the previous ones. A probe finding a deadlock also gives its exact length, which may already be smaller than the bound probed.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param max_bound The biggest length considered.
+ * @param path An array of size at least @p max_bound, receiving a shortest deadlock (if any).
+ * @param length Receives the length of the shortest deadlock, or -1 if none was found.
+ * @param probes Will point to a newly allocated array of the probes made, in order (to be freed by the caller).
+ * @param num_probes Receives the number of probes made.
+ * @return Z3_lbool Z3_L_TRUE if a shortest deadlock was found, Z3_L_FALSE if there is no deadlock of at most @p max_bound steps, Z3_L_UNDEF if a query could not be decided.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre max_bound >= 0.
+ */
+Z3_lbool deadlock_minimal_length(Z3_context ctx, LockAutomaton *automata, int num_automata, int max_bound, step *path, int *length, bound_probe **probes, int *num_probes);
+
 /**
  * @brief Constructs a path from a @p model.
  * 
@@ -45,6 +152,24 @@ Z3_ast deadlock_reduction(Z3_context ctx, LockAutomaton *automata, int num_autom
  */
 void la_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, step *path, int bound);
 
+/**
+ * @brief Constructs a path from a @p model of deadlock_parallel_reduction, linearising the moves of each parallel step (in increasing order of automata).
+ *
+ * @param ctx The solver context.
+ * @param model A variable assignment.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path An array representing a path.
+ * @param bound The number of parallel steps.
+ * @return int The size of the path obtained.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre bound >= 0.
+ * @pre @p path must be an array of size at least @p bound * @p num_automata.
+ * @pre @p model must be a valid model having a truth value for variables used by deadlock_parallel_reduction with @p automata and @p bound.
+ */
+int la_parallel_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, step *path, int bound);
+
 /**
  * @brief Prints (in pretty format) which variables used by deadlock_reduction are true in @p model.
  * 
@@ -53,11 +178,12 @@ void la_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata,
  * @param automata The LockAutomata considered.
  * @param num_automata The number of automata.
  * @param bound The size of the expected deadlock.
+ * @param encoding The encoding of the locks used by the formula (see deadlock_encoded_reduction). With an encoding of the owners, the owner of each lock taken is displayed too.
  * 
  * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
  * @pre bound >= 0.
- * @pre @p model must be a valid model having a truth value for variables used by deadlock_reduction with @p automata and @p bound.
+ * @pre @p model must be a valid model having a truth value for variables used by deadlock_encoded_reduction with @p automata, @p bound and @p encoding.
  */
-void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, int bound);
+void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, int bound, lock_encoding encoding);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+/**
+ * @file DeadlockScreening.h
+ * @brief Subset-first deadlock screening: most deadlocks involve only two or three automata, so subsets of automata sharing locks are checked first (pairs, then triples...), in parallel, before the whole product.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_SCREENING_H
+#define COCA_DEADLOCK_SCREENING_H
+
+#include "LockAutomaton.h"
+#include <z3.h>
+
+/**
+ * @brief The engine used to check each subset.
+ */
+typedef enum
+{
+    SCREENING_EXPLICIT, ///< Breadth-first search of the product (see deadlock_explicit_search).
+    SCREENING_SAT       ///< IC3/PDR with Z3 (see deadlock_ic3).
+} screening_engine;
+
+/**
+ * @brief Looks for a deadlock among subsets of @p automata of increasing size, from 2 to @p max_subset_size, then in the whole product.
+ * Only subsets connected by shared locks are considered (two automata share a lock if both act on it): other subsets deadlock only if a smaller one does.
+ * The subsets of a given size are checked in parallel by @p num_threads threads. The first deadlocking subset (in lexicographic order) of the smallest size is reported.
+ * A deadlock of a strict subset is a partial deadlock of the whole system, the other automata staying in their initial node: the automata of the subset are stuck (forever if they only release locks they hold, see la_releases_only_held_locks), while the others may still move.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param max_subset_size The size of the biggest subsets screened before the whole product.
+ * @param engine The engine used for each check.
+ * @param num_threads The number of threads.
+ * @param subset Array of size @p num_automata. If a deadlock is found, receives the automata of the deadlocking subset (all of them if it was found in the whole product).
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller), numbering automata as in @p automata. Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @return Z3_lbool Z3_L_TRUE if a deadlock was found, Z3_L_FALSE if no deadlock is reachable, Z3_L_UNDEF if the engine could not decide.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool deadlock_screening(LockAutomaton *automata, int num_automata, int max_subset_size, screening_engine engine, int num_threads, bool *subset, step **path, int *size_path);
+
+#endif
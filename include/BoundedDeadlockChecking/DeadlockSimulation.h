@@ -0,0 +1,49 @@
+/**
+ * @file DeadlockSimulation.h
+ * @brief Deadlock hunting by simulation: random executions of the product of LockAutomata, run in parallel with diverse scheduling biases (swarm testing).
+ * It cannot prove the absence of deadlock, but quickly finds deadlocks in products too big to be explored exhaustively.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_SIMULATION_H
+#define COCA_DEADLOCK_SIMULATION_H
+
+#include "LockAutomaton.h"
+#include <stdint.h>
+
+/**
+ * @brief Statistics of a simulation (see deadlock_simulation).
+ */
+typedef struct
+{
+    double seconds;       ///< The time spent (wall clock).
+    long num_walks;       ///< The number of executions run.
+    long num_steps;       ///< The total number of steps of these executions.
+    long distinct_states; ///< A lower bound of the number of distinct states hit (the number of bits set by their hashes in a bit array).
+} simulation_statistics;
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata by random executions of their product, stopping at the first deadlock found.
+ * Each execution draws its own scheduling bias (swarm configuration): a weight per automaton, some automata only moving when no other one can, a preference for acquisitions or releases, and a maximal length between @p max_depth / 4 and @p max_depth. Moves are then drawn according to these weights.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param max_depth The maximal length of an execution.
+ * @param time_limit The number of seconds after which the simulation stops.
+ * @param num_threads The number of threads running executions.
+ * @param seed The seed of the random generators (thread i uses a generator derived from @p seed and i).
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param statistics If not NULL, receives the statistics of the simulation.
+ * @return true if a deadlock was found.
+ * @return false otherwise (which does not prove that there is none).
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_simulation(LockAutomaton *automata, int num_automata, int max_depth, double time_limit, int num_threads, uint64_t seed, step **path, int *size_path, simulation_statistics *statistics);
+
+#endif
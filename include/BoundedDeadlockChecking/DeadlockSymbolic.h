@@ -0,0 +1,78 @@
+/**
+ * @file DeadlockSymbolic.h
+ * @brief Symbolic reachability for the Deadlock Checking problem: the set of reachable states of the product of LockAutomata is computed with BDDs (see Bdd.h), layer by layer, by image computation, and intersected with the set of deadlocked states.
+ * It also offers the converse search, backwards from the candidate deadlocks to the initial state.
+ * The node of each automaton is encoded in binary and each lock by one variable, each variable having a primed copy for the next state, adjacent to it in the initial order. For regular systems (e.g. dining philosophers), the BDDs stay small while the number of states explodes.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_SYMBOLIC_H
+#define COCA_DEADLOCK_SYMBOLIC_H
+
+#include "LockAutomaton.h"
+
+/**
+ * @brief Statistics of a symbolic search (see deadlock_symbolic_search).
+ */
+typedef struct
+{
+    int num_vars;          ///< The number of BDD variables (current and next states).
+    int depth;             ///< The number of images computed.
+    double num_states;     ///< The number of reachable states found.
+    long reachable_nodes;  ///< The number of nodes of the BDD of these states.
+    long peak_nodes;       ///< The largest number of BDD nodes allocated at the same time.
+    int num_reorderings;   ///< The number of reorderings of the variables.
+} symbolic_statistics;
+
+/**
+ * @brief Looks for a shortest deadlock in the parallel execution of the automata in @p automata by symbolic breadth-first search: the frontier of each layer is intersected with the deadlocked states, then its image by the transitions of each automaton (partitioned transition relation) gives the next frontier, until a deadlock is met or no new state is reached.
+ * The path is rebuilt backwards through the frontiers kept.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param reorder Whether the variables may be reordered dynamically.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (to be freed by the caller). Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param statistics If not NULL, receives the statistics of the search.
+ * @return true if a deadlock is reachable.
+ * @return false otherwise (whatever the length).
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_symbolic_search(LockAutomaton *automata, int num_automata, bool reorder, step **path, int *size_path, symbolic_statistics *statistics);
+
+/**
+ * @brief Statistics of a backward search (see deadlock_backward_search).
+ */
+typedef struct
+{
+    int num_candidates;        ///< The number of candidate deadlocks examined.
+    int num_refuted;           ///< The number of candidates proven unreachable.
+    long num_preimages;        ///< The number of pre-images computed.
+    double unreachable_states; ///< The number of states proven unreachable (cached across candidates).
+    long peak_nodes;           ///< The largest number of BDD nodes allocated at the same time.
+} backward_statistics;
+
+/**
+ * @brief Looks for a deadlock in the parallel execution of the automata in @p automata backwards, from the deadlocked states to the initial state.
+ * The lockset analysis of each automaton gives an invariant of the reachable states: every automaton is in a node it can reach alone, and every lock taken may be held by the node of some automaton. The candidate deadlocks are the tuples of nodes in which every automaton can be stuck (all its edges need locks in the wrong state) for some value of the locks satisfying the invariant. They are enumerated symbolically, and for each of them in turn, a breadth-first search by pre-images looks for the initial state among the states which can reach its deadlocked states. When a candidate is refuted, all the states which can reach it are known to be unreachable: they are cached, and the searches of the next candidates stop at them, as well as at the states violating the invariant.
+ * On systems where few tuples of nodes can deadlock, this explores much less than a forward search.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param reorder Whether the variables may be reordered dynamically.
+ * @param path If a deadlock is found, will point to a newly allocated array of size *@p size_path containing a path leading to it (a shortest path to its candidate, not necessarily a shortest deadlock), to be freed by the caller. Set to NULL otherwise.
+ * @param size_path Will contain the length of the path found (0 if none).
+ * @param statistics If not NULL, receives the statistics of the search.
+ * @return true if a deadlock is reachable.
+ * @return false otherwise (whatever the length).
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+bool deadlock_backward_search(LockAutomaton *automata, int num_automata, bool reorder, step **path, int *size_path, backward_statistics *statistics);
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file DeadlockWitness.h
+ * @brief Post-processing of the deadlocks found: validating a path leading to a deadlock independently of the engine which found it, shrinking it into a shorter one, and checking that no shorter deadlock exists.
+ * Witnesses found by depth-first or random searches, or read from models of long unrollings, are often much longer than needed, which makes them hard to read.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_DEADLOCK_WITNESS_H
+#define COCA_DEADLOCK_WITNESS_H
+
+#include "LockAutomaton.h"
+#include <z3.h>
+
+/**
+ * @brief The outcome of the validation of a path (see witness_validate).
+ */
+typedef enum
+{
+    WITNESS_VALID,            ///< The path is executable and ends in a deadlock.
+    WITNESS_UNKNOWN_STEP,     ///< A step refers to an automaton or a node which does not exist.
+    WITNESS_WRONG_SOURCE,     ///< A step starts from another node than the one its automaton is in.
+    WITNESS_MISSING_EDGE,     ///< A step follows an edge which does not exist.
+    WITNESS_WRONG_ACTION,     ///< The action of a step is not the one of its edge.
+    WITNESS_LOCK_TAKEN,       ///< A step acquires a lock already taken.
+    WITNESS_LOCK_FREE,        ///< A step releases a lock which is not taken.
+    WITNESS_NOT_DEADLOCKED    ///< The path is executable, but some automaton can still move at its end.
+} witness_verdict;
+
+/**
+ * @brief Replays @p path from the initial state of the automata in @p automata and checks that each step follows an existing edge of its automaton, from the node it is in, with the action of that edge, that each lock is only acquired when free and released when taken, and that no automaton can move at the end.
+ * It works directly on the automata, with the locks in a bitset, and takes time linear in the size of the path (plus the number of nodes of the automata, for the final state), so that the answers of all the engines can be checked at no real cost.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path The path to check.
+ * @param size_path The size of @p path.
+ * @param position If not NULL, will contain the position in @p path of the step at fault, or the number of an automaton which can still move for WITNESS_NOT_DEADLOCKED (-1 if the path is valid).
+ * @return witness_verdict WITNESS_VALID if the path is executable and leads to a deadlock, the first fault found otherwise.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+witness_verdict witness_validate(LockAutomaton *automata, int num_automata, const step *path, int size_path, int *position);
+
+/**
+ * @brief Describes @p verdict in words.
+ *
+ * @param verdict
+ * @return const char* A constant string.
+ */
+const char *witness_verdict_description(witness_verdict verdict);
+
+/**
+ * @brief Statistics of the shrinking of a path (see witness_minimise).
+ */
+typedef struct
+{
+    int original_size;      ///< The size of the path given.
+    int size_after_pruning; ///< The size after removing cycles of states and local detours of automata.
+    int size_after_search;  ///< The size after the search of the neighbourhood of the path.
+    long neighbourhood;     ///< The number of states of that neighbourhood.
+} witness_statistics;
+
+/**
+ * @brief Shrinks @p path, leading to a deadlock of the automata in @p automata, into a path leading to a deadlock, as short as found in three stages:
+ * - the steps between two visits of the same state are removed;
+ * - detours of single automata (steps of an automaton leaving a node and coming back to it) are removed whenever the rest of the path stays executable and still ends in a deadlock;
+ * - a breadth-first search from the initial state, restricted to the states of the path and the states at most @p radius steps away from them, gives a shortest deadlock in that neighbourhood.
+ * The first stage is linear in the size of the path. Each pass of the second one is quadratic at worst, as it looks for the end of each detour, whose steps are checked against the locks alone; the whole path is only replayed for the rare detours which change the locks. The last stage is linear in the size of the neighbourhood.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path A path leading to a deadlock.
+ * @param size_path The size of @p path.
+ * @param radius The number of steps the search may go away from the path.
+ * @param size_minimised Will contain the size of the path returned.
+ * @param statistics If not NULL, receives the statistics of the shrinking.
+ * @return step* A newly allocated path leading to a deadlock (to be freed by the caller), of size at most @p size_path.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ * @pre @p path must be executable from the initial state and lead to a deadlock.
+ */
+step *witness_minimise(LockAutomaton *automata, int num_automata, const step *path, int size_path, int radius, int *size_minimised, witness_statistics *statistics);
+
+/**
+ * @brief Checks with the SAT reduction that no deadlock is reachable in fewer than *@p size_path steps. If one is, *@p path is replaced by a shortest one.
+ * This is a single incremental search (see deadlock_minimal_length) up to *@p size_path - 1 steps, and is meant for paths already shrunk.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path A path leading to a deadlock, allocated with malloc. Replaced (and freed) if a shorter deadlock is found.
+ * @param size_path The size of *@p path, updated if a shorter deadlock is found.
+ * @return Z3_lbool Z3_L_TRUE if *@p path is a shortest deadlock, Z3_L_FALSE if a shorter deadlock was found (*@p path is then a shortest deadlock), Z3_L_UNDEF if the solver could not decide.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+Z3_lbool witness_check_shortest(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path);
+
+#endif
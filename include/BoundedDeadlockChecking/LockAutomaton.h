@@ -13,6 +13,7 @@
 #define COCA_LOCK_AUTOMATON_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "Graph.h"
 
 /**
@@ -20,6 +21,11 @@
  */
 typedef struct LockAutomaton_s *LockAutomaton;
 
+/**
+ * @brief The result of the lockset analysis of an automaton: for each node, whether it is reachable, and the locks it may hold and must hold (as bitsets).
+ */
+typedef struct LockSets_s *LockSets;
+
 /**
  * @brief Structure to store a step of an execution path over several automata.
  *
@@ -44,7 +50,20 @@ typedef struct step
 LockAutomaton la_initialize(Graph graph);
 
 /**
- * @brief Deallocates memory used by @a automaton (initialized by la_initialize). Does NOT deallocates the graph.
+ * @brief Creates a LockAutomaton from its components (typically an automaton computed from another one). Contrary to la_initialize, the automaton builds and owns its graph: the arguments are copied.
+ *
+ * @param name The name of the automaton.
+ * @param num_nodes The number of nodes.
+ * @param node_names The name of each node.
+ * @param initial The initial node.
+ * @param edges A matrix of size @p num_nodes * @p num_nodes: edges[source * num_nodes + target] tells if (source, target) is an edge.
+ * @param edge_actions A matrix of size @p num_nodes * @p num_nodes giving the action of each edge.
+ * @return LockAutomaton
+ */
+LockAutomaton la_create(char *name, int num_nodes, char **node_names, int initial, bool *edges, int *edge_actions);
+
+/**
+ * @brief Deallocates memory used by @a automaton. Does NOT deallocates the graph if @a automaton was initialized by la_initialize.
  *
  * @param automaton
  */
@@ -133,6 +152,14 @@ bool la_is_initial(LockAutomaton automaton, int node);
  */
 int la_get_initial(LockAutomaton automaton);
 
+/**
+ * @brief Computes the distance (minimal number of edges) from the initial node of @p automaton to each of its nodes, ignoring the locks. Unreachable nodes get distance -1.
+ *
+ * @param automaton
+ * @param distances An array of size la_get_num_nodes(@p automaton) receiving the distances.
+ */
+void la_distances_from_initial(LockAutomaton automaton, int *distances);
+
 /**
  * @brief Gets the biggest lock used by @p automaton.
  *
@@ -187,4 +214,139 @@ step la_step_empty();
  * @return step 
  */
 step la_step_create(int automaton, int source, int target, int action);
-#endif
\ No newline at end of file
+
+/**
+ * @brief Computes the locks held at each node of @p automaton by a forward dataflow analysis over its edge actions (acq adds a lock, rel removes it), iterated to a fixpoint.
+ * A lock may be held at a node if it is held on some path from the initial node to it, and must be held if it is held on every such path (the automaton being considered alone, locks being taken by itself).
+ *
+ * @param automaton
+ * @return LockSets The result of the analysis, to be freed with la_delete_locksets.
+ */
+LockSets la_compute_locksets(LockAutomaton automaton);
+
+/**
+ * @brief Deallocates memory used by @p sets.
+ *
+ * @param sets
+ */
+void la_delete_locksets(LockSets sets);
+
+/**
+ * @brief Returns the number of 64-bit words of the bitsets of @p sets (lock l is bit l % 64 of word l / 64).
+ *
+ * @param sets
+ * @return int
+ */
+int la_lockset_words(LockSets sets);
+
+/**
+ * @brief Returns the bitset of locks @p node may hold.
+ *
+ * @pre @p node must be between 0 and la_get_num_nodes of the automaton analysed.
+ * @param sets
+ * @param node
+ * @return const uint64_t*
+ */
+const uint64_t *la_get_may_hold(LockSets sets, int node);
+
+/**
+ * @brief Returns the bitset of locks @p node must hold.
+ *
+ * @pre @p node must be between 0 and la_get_num_nodes of the automaton analysed.
+ * @param sets
+ * @param node
+ * @return const uint64_t*
+ */
+const uint64_t *la_get_must_hold(LockSets sets, int node);
+
+/**
+ * @brief Returns true if @p node is reachable from the initial node (ignoring locks).
+ *
+ * @param sets
+ * @param node
+ * @return true
+ * @return false
+ */
+bool la_is_reachable(LockSets sets, int node);
+
+/**
+ * @brief Returns true if @p lock may be held at @p node.
+ *
+ * @param sets
+ * @param node
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool la_may_hold(LockSets sets, int node, int lock);
+
+/**
+ * @brief Returns true if @p lock must be held at @p node.
+ *
+ * @param sets
+ * @param node
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool la_must_hold(LockSets sets, int node, int lock);
+
+/**
+ * @brief Returns true if some edge of @p automaton from a reachable node acquires @p lock.
+ *
+ * @param automaton
+ * @param sets The lockset analysis of @p automaton.
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool la_acquires_lock(LockAutomaton automaton, LockSets sets, int lock);
+
+/**
+ * @brief Returns true if every edge of @p automaton from a reachable node releasing a lock releases a lock that must be held there.
+ *
+ * @param automaton
+ * @param sets The lockset analysis of @p automaton.
+ * @return true
+ * @return false
+ */
+bool la_releases_only_held_locks(LockAutomaton automaton, LockSets sets);
+
+/**
+ * @brief Returns true if the edge (@p source, @p target) can never be blocked: it is a noop, or it releases a lock that must be held at @p source while every automaton only releases locks it holds (so that no one else may release it).
+ *
+ * @pre la_is_edge(@p automaton, @p source, @p target) must return true.
+ * @param automaton
+ * @param sets The lockset analysis of @p automaton.
+ * @param source
+ * @param target
+ * @param releases_well_formed Must be true only if la_releases_only_held_locks is true for every automaton of the system.
+ * @return true
+ * @return false
+ */
+bool la_is_edge_never_blocked(LockAutomaton automaton, LockSets sets, int source, int target, bool releases_well_formed);
+
+/**
+ * @brief Returns true if @p automaton can never be stuck at @p node: @p node is unreachable or has an outgoing edge which can never be blocked.
+ *
+ * @param automaton
+ * @param sets The lockset analysis of @p automaton.
+ * @param node
+ * @param releases_well_formed Must be true only if la_releases_only_held_locks is true for every automaton of the system.
+ * @return true
+ * @return false
+ */
+bool la_is_node_never_deadlocked(LockAutomaton automaton, LockSets sets, int node, bool releases_well_formed);
+
+/**
+ * @brief Computes, for each node of @p automaton, the minimal number of moves leading to a node where it may get stuck (see la_is_node_never_deadlocked), by a backward breadth-first search.
+ * In a product, reaching a deadlock from a state takes at least the sum of these distances over the automata, which makes this sum an admissible (and consistent) heuristic.
+ *
+ * @param automaton
+ * @param sets The lockset analysis of @p automaton.
+ * @param releases_well_formed Must be true only if la_releases_only_held_locks is true for every automaton of the system.
+ * @param distances An array of size la_get_num_nodes(@p automaton) receiving the distances (-1 for nodes from which no such node is reachable).
+ */
+void la_distances_to_stuck_nodes(LockAutomaton automaton, LockSets sets, bool releases_well_formed, int *distances);
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @file LockMinimisation.h
+ * @brief Minimisation of LockAutomata before verification: strong bisimulation quotient (by partition refinement, edges being labelled by their action), optionally preceded by the collapse of chains of noop edges.
+ * Keeps the mapping between the nodes of the minimised automaton and the original ones, so that paths found on minimised automata can be translated back.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_LOCK_MINIMISATION_H
+#define COCA_LOCK_MINIMISATION_H
+
+#include "LockAutomaton.h"
+
+/**
+ * @brief A LockAutomaton minimised, together with the mapping to the original automaton.
+ */
+typedef struct MinimisedAutomaton_s *MinimisedAutomaton;
+
+/**
+ * @brief Minimises @p automaton: only the nodes reachable from the initial node are kept, and bisimilar nodes are merged.
+ * The product of bisimulation quotients is bisimilar to the product of the original automata: deadlocks of every length are preserved, so the quotient can be used for the bounded problem.
+ * If @p collapse_noops is true, a node whose only outgoing edge is a noop to another node is first merged with the end of its chain of such nodes. This only preserves the existence of a deadlock of some length (every such chain is shortened), so it must only be used for unbounded checking.
+ *
+ * @param automaton The LockAutomaton to minimise (it must outlive the result).
+ * @param collapse_noops Whether to collapse chains of noop edges.
+ * @return MinimisedAutomaton The result, to be freed with lm_delete.
+ */
+MinimisedAutomaton lm_minimise(LockAutomaton automaton, bool collapse_noops);
+
+/**
+ * @brief Deallocates memory used by @p minimised (including its minimised automaton).
+ *
+ * @param minimised
+ */
+void lm_delete(MinimisedAutomaton minimised);
+
+/**
+ * @brief Returns the minimised automaton. Its nodes are named after one of the original nodes they stand for.
+ *
+ * @param minimised
+ * @return LockAutomaton
+ */
+LockAutomaton lm_get_automaton(MinimisedAutomaton minimised);
+
+/**
+ * @brief Returns the node of the minimised automaton standing for @p node of the original automaton, or -1 if @p node is unreachable or was collapsed into another node.
+ *
+ * @param minimised
+ * @param node A node of the original automaton.
+ * @return int
+ */
+int lm_get_minimised_node(MinimisedAutomaton minimised, int node);
+
+/**
+ * @brief Translates @p path, a path over the minimised automata, into a path over the original automata leading to a deadlock as well.
+ * Without collapse of noop chains, the translated path has the same size. Otherwise, the noop edges collapsed are added back.
+ *
+ * @param minimised The minimised automata.
+ * @param num_automata The number of automata.
+ * @param path A path over the automata lm_get_automaton(minimised[i]) from their initial state.
+ * @param size_path The size of @p path.
+ * @param size_translated Receives the size of the translated path.
+ * @return step* The translated path, newly allocated (to be freed by the caller).
+ */
+step *lm_translate_path(MinimisedAutomaton *minimised, int num_automata, step *path, int size_path, int *size_translated);
+
+#endif
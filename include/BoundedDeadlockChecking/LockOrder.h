@@ -0,0 +1,87 @@
+/**
+ * @file LockOrder.h
+ * @brief A static (Goodlock-style) pre-analysis of LockAutomata: builds the lock-order graph (an edge l1 -> l2 when some automaton may acquire l2 while holding l1) and looks for its cycles.
+ * It runs in time linear in the size of the automata, and can prove that no deadlock is reachable (whatever the length) before any SAT call or state-space search.
+ * Otherwise, the locks and automata involved in cycles are reported, as hints for the user. The engines are not restricted to them: an automaton involved may wait for a lock held by one which is not, so checking the automata involved alone may miss deadlocks.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_LOCK_ORDER_H
+#define COCA_LOCK_ORDER_H
+
+#include "LockAutomaton.h"
+
+/**
+ * @brief The result of the lock-order analysis of an array of automata.
+ */
+typedef struct LockOrder_s *LockOrder;
+
+/**
+ * @brief Computes the lock-order graph of @p automata (using the locks each node may hold), its strongly connected components (Tarjan's algorithm), and the automata which may get stuck without waiting for a lock.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return LockOrder The result of the analysis, to be freed with lo_delete.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+LockOrder lo_analyse(LockAutomaton *automata, int num_automata);
+
+/**
+ * @brief Deallocates the memory used by @p order.
+ *
+ * @param order
+ */
+void lo_delete(LockOrder order);
+
+/**
+ * @brief Tells if the analysis proves that no deadlock is reachable. This is the case when the lock-order graph is acyclic, every automaton only releases locks it holds, and no automaton can reach a node without outgoing edges.
+ * Indeed, in a deadlock, every automaton would then wait for a lock held by another one waiting in turn, which would give a cycle.
+ *
+ * @param order
+ * @return true if no deadlock is reachable.
+ * @return false if the analysis is inconclusive.
+ */
+bool lo_proves_deadlock_freedom(LockOrder order);
+
+/**
+ * @brief Returns the number of cycles (cyclic strongly connected components) of the lock-order graph.
+ *
+ * @param order
+ * @return int
+ */
+int lo_num_cycles(LockOrder order);
+
+/**
+ * @brief Tells if @p lock belongs to a cycle of the lock-order graph.
+ *
+ * @param order
+ * @param lock A lock (strictly positive).
+ * @return true
+ * @return false
+ */
+bool lo_is_lock_in_cycle(LockOrder order, int lock);
+
+/**
+ * @brief Tells if automaton number @p automaton may be involved in a deadlock: it induces an edge of a cycle of the lock-order graph, releases locks it may not hold, or may reach a node without outgoing edges.
+ *
+ * @param order
+ * @param automaton An automaton number.
+ * @return true
+ * @return false
+ */
+bool lo_is_automaton_involved(LockOrder order, int automaton);
+
+/**
+ * @brief Prints the result of the analysis: the cycles of the lock-order graph (with the automata inducing each edge) and the automata which may get stuck otherwise.
+ *
+ * @param order
+ * @param automata The LockAutomata analysed.
+ */
+void lo_print(LockOrder order, LockAutomaton *automata);
+
+#endif
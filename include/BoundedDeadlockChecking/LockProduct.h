@@ -0,0 +1,238 @@
+/**
+ * @file LockProduct.h
+ * @brief The explicit product of several LockAutomata: compact states (the node of every automaton followed by a bitset of the locks taken), successor computation, deadlock detection, and hash sets of states.
+ * It is the common ground of the explicit-state algorithms for the Deadlock Checking problem.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_LOCK_PRODUCT_H
+#define COCA_LOCK_PRODUCT_H
+
+#include "LockAutomaton.h"
+#include <stdint.h>
+
+/**
+ * @brief The product of an array of LockAutomata.
+ * A state of the product is an array of lp_state_size(product) unsigned words: word i < num_automata is the node of automaton i, and the next words are a bitset of the locks taken (lock l is bit l % 32 of word num_automata + l / 32).
+ */
+typedef struct LockProduct_s *LockProduct;
+
+/**
+ * @brief A hash set of fixed-size arrays of unsigned words (typically states of a LockProduct). Keys are numbered from 0 in insertion order, so that a breadth-first search can use these numbers as its queue.
+ */
+typedef struct StateSet_s *StateSet;
+
+/**
+ * @brief Creates the product of @p automata. The automata must outlive the product.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return LockProduct The product, to be freed with lp_delete.
+ *
+ * @pre @p automata must be an array of valid LockAutomata of size @p num_automata.
+ */
+LockProduct lp_initialize(LockAutomaton *automata, int num_automata);
+
+/**
+ * @brief Deallocates memory used by @p product.
+ *
+ * @param product
+ */
+void lp_delete(LockProduct product);
+
+/**
+ * @brief Returns the number of automata of @p product.
+ *
+ * @param product
+ * @return int
+ */
+int lp_get_num_automata(LockProduct product);
+
+/**
+ * @brief Returns the biggest lock used by the automata of @p product.
+ *
+ * @param product
+ * @return int
+ */
+int lp_get_max_lock(LockProduct product);
+
+/**
+ * @brief Returns the number of unsigned words of a state of @p product.
+ *
+ * @param product
+ * @return int
+ */
+int lp_state_size(LockProduct product);
+
+/**
+ * @brief Returns the maximal number of moves enabled in a state of @p product (the sum of the maximal out-degrees of the automata).
+ *
+ * @param product
+ * @return int
+ */
+int lp_max_moves(LockProduct product);
+
+/**
+ * @brief Writes the initial state of @p product (every automaton in its initial node, every lock free) in @p state.
+ *
+ * @param product
+ * @param state An array of size lp_state_size(@p product).
+ */
+void lp_initial_state(LockProduct product, unsigned *state);
+
+/**
+ * @brief Returns the node of automaton @p aut in @p state.
+ *
+ * @param product
+ * @param state
+ * @param aut
+ * @return int
+ */
+int lp_get_node(LockProduct product, const unsigned *state, int aut);
+
+/**
+ * @brief Tells if @p lock is taken in @p state.
+ *
+ * @param product
+ * @param state
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool lp_is_lock_taken(LockProduct product, const unsigned *state, int lock);
+
+/**
+ * @brief Tells if @p move (a step of one automaton) can be taken from @p state: the automaton is in the source of the edge, and its action is possible.
+ *
+ * @param product
+ * @param state
+ * @param move
+ * @return true
+ * @return false
+ */
+bool lp_is_enabled(LockProduct product, const unsigned *state, step move);
+
+/**
+ * @brief Performs @p move on @p state (in place).
+ *
+ * @param product
+ * @param state
+ * @param move
+ * @pre lp_is_enabled(@p product, @p state, @p move).
+ */
+void lp_apply(LockProduct product, unsigned *state, step move);
+
+/**
+ * @brief Undoes @p move on @p state (in place), @p move being the last move applied to it.
+ *
+ * @param product
+ * @param state
+ * @param move
+ */
+void lp_undo(LockProduct product, unsigned *state, step move);
+
+/**
+ * @brief Computes the moves enabled in @p state, by increasing automaton number.
+ *
+ * @param product
+ * @param state
+ * @param moves An array of size at least lp_max_moves(@p product) receiving the moves.
+ * @return int The number of moves enabled.
+ */
+int lp_enabled_moves(LockProduct product, const unsigned *state, step *moves);
+
+/**
+ * @brief Tells if @p state is a deadlock, i.e. if no move is enabled in it.
+ *
+ * @param product
+ * @param state
+ * @return true
+ * @return false
+ */
+bool lp_is_deadlock(LockProduct product, const unsigned *state);
+
+/**
+ * @brief Hashes @p size words of @p key with @p seed (different seeds give independent hash functions).
+ *
+ * @param key
+ * @param size
+ * @param seed
+ * @return uint64_t
+ */
+uint64_t lp_hash(const unsigned *key, int size, uint64_t seed);
+
+/**
+ * @brief Prints @p state (the node of every automaton and the locks taken).
+ *
+ * @param product
+ * @param automata The LockAutomata of @p product.
+ * @param state
+ */
+void lp_print_state(LockProduct product, LockAutomaton *automata, const unsigned *state);
+
+/**
+ * @brief Creates an empty hash set of keys of @p key_size words.
+ *
+ * @param key_size
+ * @return StateSet The set, to be freed with lp_set_delete.
+ */
+StateSet lp_set_create(int key_size);
+
+/**
+ * @brief Deallocates memory used by @p set.
+ *
+ * @param set
+ */
+void lp_set_delete(StateSet set);
+
+/**
+ * @brief Adds @p key to @p set.
+ *
+ * @param set
+ * @param key
+ * @return true if @p key was not already in @p set.
+ * @return false otherwise.
+ */
+bool lp_set_insert(StateSet set, const unsigned *key);
+
+/**
+ * @brief Tells if @p key is in @p set.
+ *
+ * @param set
+ * @param key
+ * @return true
+ * @return false
+ */
+bool lp_set_contains(StateSet set, const unsigned *key);
+
+/**
+ * @brief Returns the number of @p key in @p set (its insertion rank), or -1 if it is not in @p set.
+ *
+ * @param set
+ * @param key
+ * @return long
+ */
+long lp_set_find(StateSet set, const unsigned *key);
+
+/**
+ * @brief Returns the key numbered @p index in @p set. The pointer is invalidated by the next insertion.
+ *
+ * @param set
+ * @param index Between 0 and lp_set_size(@p set) - 1.
+ * @return const unsigned*
+ */
+const unsigned *lp_set_get(StateSet set, long index);
+
+/**
+ * @brief Returns the number of keys in @p set.
+ *
+ * @param set
+ * @return long
+ */
+long lp_set_size(StateSet set);
+
+#endif
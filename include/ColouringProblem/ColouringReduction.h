@@ -23,7 +23,7 @@
  * @param ctx The solver context.
  * @param graph A ColouredGraph.
  * @param num_colours The number of colours available for colouring the graph.
- * @return Z3_ast The formula.
+ * @return Z3_ast The formula, kept (see keep_formula): to be released with release_formula once solved.
  * @pre @p graph must be initialized.
  */
 Z3_ast colouring_reduction(Z3_context ctx, const ColouredGraph graph, int num_colours);
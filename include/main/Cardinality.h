@@ -0,0 +1,103 @@
+/**
+ * @file Cardinality.h
+ * @brief Cardinality constraints (at most one, exactly one, at most k of a set of formulae) over a FormulaBuilder, with several encodings and an automatic choice by size.
+ * The pairwise encoding of at most one is quadratic: it is the best one for a handful of formulae, but automata with thousands of nodes or colourings with many colours need the linear ones.
+ * All the encodings except the native one are circuits of conjunctions and disjunctions of the formulae, without auxiliary variables: the auxiliary variables of the usual clausal encodings are the nodes of the circuit,
+ * which the solver (or fb_write_dimacs) introduces by the Tseitin encoding. The formulae built are thus equivalent to the constraint, not only equisatisfiable, and can be used anywhere, negated or not.
+ * @version 1
+ * @date 2026-10-19
+ *
+ * @copyright Creative Commons.
+ *
+ */
+
+#ifndef COCA_CARDINALITY_H
+#define COCA_CARDINALITY_H
+
+#include "Z3Tools.h"
+
+/**
+ * @brief The encodings of cardinality constraints.
+ */
+typedef enum
+{
+    CARD_AUTO,       ///< Chosen by card_select.
+    CARD_PAIRWISE,   ///< At most one: no two formulae are true. Quadratic.
+    CARD_SEQUENTIAL, ///< A counter of the formulae true so far, up to k + 1, along the formulae. Linear in n * k.
+    CARD_TOTALISER,  ///< A tree of unary adders of the two halves of the formulae, truncated to k + 1. Linear in n * k, with a logarithmic depth.
+    CARD_COMMANDER,  ///< At most one: in each group of three formulae, and among the disjunctions of the groups (recursively). Linear.
+    CARD_PRODUCT,    ///< At most one: the formulae on a grid of about sqrt(n) rows and columns, at most one row and at most one column having a true formula (recursively). Linear.
+    CARD_BIMANDER,   ///< At most one: in each pair of formulae, and for each bit of the number of the pairs, not both a pair with this bit and a pair without it. In n log n.
+    CARD_NATIVE      ///< A pseudo-Boolean constraint of Z3 (see fb_at_most).
+} card_encoding;
+
+/**
+ * @brief Chooses an encoding of the constraint that at most @p k of @p size formulae are true: pairwise for up to 6 formulae, commander up to 128, product beyond for at most one;
+ *        totaliser for k > 1 (a few clauses less than the sequential counter in CNF, and of logarithmic depth instead of linear).
+ *
+ * @param size The number of formulae.
+ * @param k
+ * @return card_encoding Never CARD_AUTO nor CARD_NATIVE.
+ */
+card_encoding card_select(int size, int k);
+
+/**
+ * @brief Returns the formula stating that at most @p k of the formulae of @p formulae are true.
+ * The encodings of at most one (pairwise, commander, product and bimander) are replaced by the one of card_select when @p k is not 1.
+ *
+ * @param builder The formula builder.
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @param k
+ * @param encoding The encoding used.
+ * @return fb_node
+ */
+fb_node card_at_most_k(FormulaBuilder builder, int size, const fb_node *formulae, int k, card_encoding encoding);
+
+/**
+ * @brief Returns the formula stating that at most one of the formulae of @p formulae is true.
+ *
+ * @param builder The formula builder.
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @param encoding The encoding used.
+ * @return fb_node
+ */
+fb_node card_at_most_one(FormulaBuilder builder, int size, const fb_node *formulae, card_encoding encoding);
+
+/**
+ * @brief Returns the formula stating that exactly one of the formulae of @p formulae is true: their disjunction and card_at_most_one.
+ *
+ * @param builder The formula builder.
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @param encoding The encoding used.
+ * @return fb_node
+ */
+fb_node card_exactly_one(FormulaBuilder builder, int size, const fb_node *formulae, card_encoding encoding);
+
+/**
+ * @brief Generates a Z3 formula stating that at most @p k of the formulae from @p formulae are true, built with card_at_most_k over variables replaced by the formulae afterwards.
+ *        Safe in contexts with reference counting: the formulae of @p formulae must be kept, and the result lives until the next call creating a formula.
+ *
+ * @param ctx The solver context.
+ * @param size The number of formulae.
+ * @param formulae The formulae. They must not contain the variables "card input N" used for the construction.
+ * @param k
+ * @param encoding The encoding used.
+ * @return Z3_ast
+ */
+Z3_ast card_z3_at_most_k(Z3_context ctx, int size, Z3_ast *formulae, int k, card_encoding encoding);
+
+/**
+ * @brief Generates a Z3 formula stating that exactly one of the formulae from @p formulae is true (see card_z3_at_most_k and card_exactly_one).
+ *
+ * @param ctx The solver context.
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @param encoding The encoding used.
+ * @return Z3_ast
+ */
+Z3_ast card_z3_exactly_one(Z3_context ctx, int size, Z3_ast *formulae, card_encoding encoding);
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <z3.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 /**
  * @brief Creates a basic Z3 context with basic config (sufficient for this project). Must be freed at end of program with Z3_del_context.
@@ -24,6 +25,67 @@
  */
 Z3_context make_context(void);
 
+/**
+ * @brief Creates a Z3 context with reference counting. Unlike in the context of make_context, where every formula lives until the context is freed, a formula is freed as soon as nothing refers to it anymore,
+ *        so that memory stays flat over long runs. A formula returned by Z3 is only guaranteed to live until the next call creating a formula: to use it longer, keep it with keep_formula and release it
+ *        with release_formula once done. Must be freed with Z3_del_context.
+ * 
+ * @return Z3_context The created context.
+ */
+Z3_context make_context_rc(void);
+
+/**
+ * @brief Adds a reference to @p formula, so that it lives until released with release_formula (see make_context_rc). Harmless in a context without reference counting.
+ * 
+ * @param ctx The solver context.
+ * @param formula The formula to keep.
+ * @return Z3_ast @p formula.
+ */
+Z3_ast keep_formula(Z3_context ctx, Z3_ast formula);
+
+/**
+ * @brief Removes a reference to @p formula, added by keep_formula.
+ * 
+ * @param ctx The solver context.
+ * @param formula The formula to release.
+ */
+void release_formula(Z3_context ctx, Z3_ast formula);
+
+/**
+ * @brief Removes a reference to each formula of @p formulae, added by keep_formula.
+ * 
+ * @param ctx The solver context.
+ * @param formulae The formulae to release.
+ * @param size The number of formulae.
+ */
+void release_formulae(Z3_context ctx, Z3_ast *formulae, int size);
+
+/**
+ * @brief Returns the context pooled by the calling thread, created with make_context_rc on first use. It is meant to be reused across instances (see reset_pool), and to be freed with free_pool, not with Z3_del_context.
+ *        The functions of this file solving formulae in it all reuse the same solver instead of creating one per call.
+ * 
+ * @return Z3_context The pooled context of the calling thread.
+ */
+Z3_context pooled_context(void);
+
+/**
+ * @brief Returns an empty solver of @p ctx, with a reference owned by the caller (to be released with Z3_solver_dec_ref). It is the pooled solver, emptied, if @p ctx is the pooled context of the calling thread, and a new solver otherwise.
+ * 
+ * @param ctx The solver context.
+ * @return Z3_solver An empty solver.
+ */
+Z3_solver pooled_solver(Z3_context ctx);
+
+/**
+ * @brief Empties the pooled solver of the calling thread, to be called between instances. The formulae of the previous instance are freed as soon as they are released, so that the pooled context can be reused indefinitely.
+ */
+void reset_pool(void);
+
+/**
+ * @brief Frees the pooled context and solver of the calling thread (if any). To be called before the thread ends.
+ */
+void free_pool(void);
+
 /**
  * @brief Creates a formula containing a single variable whose name is given in parameter. Example mk_bool_var(ctx,"toto") will create the formula «toto». Each call with
  *        same name will produce the same formula (so it can be used to have the same variable in different formulae.)
@@ -35,8 +97,9 @@ Z3_context make_context(void);
 Z3_ast mk_bool_var(Z3_context ctx, const char *name);
 
 /**
- * @brief Generates a formula stating that exactly one of the formulae from @p formulae is true.
- *
+ * @brief Generates a formula stating that exactly one of the formulae from @p formulae is true, with the encoding chosen by size (see card_z3_exactly_one).
+ *        Safe in contexts with reference counting: the formulae of @p formulae must be kept, and the result lives until the next call creating a formula.
+ * 
  * @param ctx The solver context.
  * @param formulae The formulae.
  * @param size The number of formulae.
@@ -68,7 +131,7 @@ Z3_model get_model_from_sat_formula(Z3_context ctx, Z3_ast formula);
  * 
  * @param ctx The context of the solver.
  * @param formula The formula to check.
- * @param model A pointer towards a model. Will contain a model of @p formula if it is satisfiable (otherwise, will not be modified).
+ * @param model A pointer towards a model. Will contain a model of @p formula if it is satisfiable (otherwise, will not be modified), with a reference owned by the caller (to be released with Z3_model_dec_ref).
  * @return Z3_lbool Z3_L_FALSE if @p formula is unsatisfiable, Z3_L_TRUE if @p formula is satisfiable and Z3_L_UNDEF if the solver cannot decide if @p formula is satisfiable or not.
  */
 Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model);
@@ -85,4 +148,152 @@ Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model);
  */
 bool value_of_var_in_model(Z3_context ctx, Z3_model model, Z3_ast variable);
 
-#endif
\ No newline at end of file
+/**
+ * @brief A builder of propositional formulae, kept as a DAG of conjunctions, equivalences and cardinality constraints before being handed to Z3 (see fb_to_z3) or written in CNF (see fb_write_dimacs).
+ *        Nodes are hash-consed, so that building the same formula twice gives the same node, and simplified as they are built: nested conjunctions (and disjunctions) are flattened,
+ *        constants are propagated, duplicate children are removed, and a conjunction containing a formula and its negation is false. Formulae built directly with Z3 contain many
+ *        such trivial or duplicate subterms (singleton disjunctions, conjunctions of conjunctions, constants of pruned variables).
+ */
+typedef struct FormulaBuilder_s *FormulaBuilder;
+
+/**
+ * @brief A formula of a FormulaBuilder: the number of its root node, negative for the negation of the node.
+ */
+typedef int fb_node;
+
+/**
+ * @brief The constant true.
+ */
+#define FB_TRUE 1
+
+/**
+ * @brief The constant false.
+ */
+#define FB_FALSE (-1)
+
+/**
+ * @brief Creates an empty FormulaBuilder.
+ * 
+ * @return FormulaBuilder The builder, to be freed with fb_delete.
+ */
+FormulaBuilder fb_create(void);
+
+/**
+ * @brief Deallocates memory used by @p builder, and releases the formulae of its nodes lowered to Z3.
+ * 
+ * @param builder
+ */
+void fb_delete(FormulaBuilder builder);
+
+/**
+ * @brief Returns the number of nodes of @p builder (the constant, the variables and the connectives).
+ * 
+ * @param builder
+ * @return int
+ */
+int fb_num_nodes(FormulaBuilder builder);
+
+/**
+ * @brief Returns the variable called @p name. Each call with the same name gives the same node, lowered to the Z3 variable of that name (see mk_bool_var).
+ * 
+ * @param builder
+ * @param name The name of the variable.
+ * @return fb_node
+ */
+fb_node fb_var(FormulaBuilder builder, const char *name);
+
+/**
+ * @brief Returns the negation of @p f (this creates no node).
+ * 
+ * @param f
+ * @return fb_node
+ */
+fb_node fb_not(fb_node f);
+
+/**
+ * @brief Returns the conjunction of the formulae of @p formulae (true if @p size is 0), simplified.
+ * 
+ * @param builder
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @return fb_node
+ */
+fb_node fb_and(FormulaBuilder builder, int size, const fb_node *formulae);
+
+/**
+ * @brief Returns the disjunction of the formulae of @p formulae (false if @p size is 0), simplified. It is the negation of the conjunction of their negations.
+ * 
+ * @param builder
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @return fb_node
+ */
+fb_node fb_or(FormulaBuilder builder, int size, const fb_node *formulae);
+
+/**
+ * @brief Returns the formula stating that @p premise implies @p conclusion.
+ * 
+ * @param builder
+ * @param premise
+ * @param conclusion
+ * @return fb_node
+ */
+fb_node fb_implies(FormulaBuilder builder, fb_node premise, fb_node conclusion);
+
+/**
+ * @brief Returns the formula stating that @p f and @p g are equivalent, simplified.
+ * 
+ * @param builder
+ * @param f
+ * @param g
+ * @return fb_node
+ */
+fb_node fb_iff(FormulaBuilder builder, fb_node f, fb_node g);
+
+/**
+ * @brief Returns a formula equivalent to @p f which fb_and and fb_or use as a whole: if @p f is a conjunction (or a disjunction), its children are not flattened into the ones of the formulae built over it.
+ *        Flattening copies the children into each formula using @p f: a formula grown one step at a time from the previous one (like the registers of a counter) would then be quadratic.
+ *        Shared nodes are lowered to the formula of @p f, and written in CNF with its variable.
+ * 
+ * @param builder
+ * @param f
+ * @return fb_node
+ */
+fb_node fb_share(FormulaBuilder builder, fb_node f);
+
+/**
+ * @brief Returns the formula stating that at most @p bound of the formulae of @p formulae are true, as a single node (true formulae lower the bound, false ones are removed).
+ *        It is lowered to a native pseudo-Boolean constraint of Z3 (Z3_mk_atmost) and written in CNF with a sequential counter. See Cardinality.h for encodings with connectives only.
+ * 
+ * @param builder
+ * @param size The number of formulae.
+ * @param formulae The formulae.
+ * @param bound The number of formulae which may be true.
+ * @return fb_node
+ */
+fb_node fb_at_most(FormulaBuilder builder, int size, const fb_node *formulae, int bound);
+
+/**
+ * @brief Lowers @p f to a Z3 formula of @p ctx. Each node is lowered once: the formulae of the nodes are kept by @p builder, and shared by all the formulae lowered afterwards,
+ *        so that the formula returned lives until fb_delete, also in contexts with reference counting.
+ * 
+ * @param builder
+ * @param ctx The solver context.
+ * @param f
+ * @return Z3_ast
+ * @pre All the formulae of @p builder are lowered to the same context.
+ */
+Z3_ast fb_to_z3(FormulaBuilder builder, Z3_context ctx, fb_node f);
+
+/**
+ * @brief Writes @p f in @p file in the DIMACS CNF format, with the Tseitin encoding of its nodes (one DIMACS variable per node reachable from @p f, plus a sequential counter per at-most node, the conjuncts of @p f being asserted directly).
+ *        Comment lines give the DIMACS variable of each variable of @p f, so that models of external SAT solvers can be read back.
+ * 
+ * @param builder
+ * @param f
+ * @param file An open file.
+ * @return long The number of clauses written.
+ */
+long fb_write_dimacs(FormulaBuilder builder, fb_node f, FILE *file);
+
+#endif
@@ -0,0 +1,896 @@
+#include "Bdd.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The number of entries of the computed cache (a power of 2).
+ */
+#define BDD_CACHE_SIZE (1 << 18)
+
+/**
+ * @brief The initial number of nodes of a manager.
+ */
+#define BDD_INITIAL_NODES 4096
+
+/**
+ * @brief The number of nodes from which garbage is first collected, and from which variables are first reordered.
+ */
+#define BDD_INITIAL_THRESHOLD 100000
+
+/**
+ * @brief While sifting a variable in a direction, the factor of the best number of nodes beyond which the variable is not moved further.
+ */
+#define BDD_MAX_GROWTH 1.2
+
+/**
+ * @brief A node of a BDD.
+ */
+typedef struct
+{
+    int var;  ///< The variable of the node (-1 for the terminals, -2 for free nodes).
+    int low;  ///< The child when the variable is false.
+    int high; ///< The child when the variable is true.
+    int next; ///< The next node in the same bucket of the unique table (or in the list of free nodes).
+    int refs; ///< The number of references to the node: from its parents and from the users of the manager.
+} bdd_node;
+
+/**
+ * @brief The unique table of the nodes of a variable: a hash table of their children, chaining the nodes through their field next.
+ */
+typedef struct
+{
+    int *buckets; ///< The first node of each bucket (-1 if empty).
+    int size;     ///< The number of buckets (a power of 2).
+    int count;    ///< The number of nodes in the table.
+} bdd_subtable;
+
+/**
+ * @brief An entry of the computed cache.
+ */
+typedef struct
+{
+    int op;     ///< The operation (0 if the entry is empty).
+    int a;      ///< The first operand.
+    int b;      ///< The second operand.
+    int c;      ///< The third operand.
+    int result; ///< The result.
+} bdd_cache_entry;
+
+/**
+ * @brief The operations of the computed cache.
+ */
+enum
+{
+    BDD_OP_ITE = 1,
+    BDD_OP_EXISTS,
+    BDD_OP_AND_EXISTS,
+    BDD_OP_PERMUTE
+};
+
+struct BddManager_s
+{
+    int num_vars;             ///< The number of variables.
+    bdd_node *nodes;          ///< The nodes (0 and 1 are the terminals).
+    int capacity;             ///< The number of nodes allocated.
+    int free_list;            ///< The first free node (-1 if none).
+    long live;                ///< The number of nodes in use.
+    long peak;                ///< The largest number of nodes in use.
+    bdd_subtable *subtables;  ///< The unique table of each variable.
+    int *var_level;           ///< The level of each variable (its position in the order).
+    int *level_var;           ///< The variable at each level.
+    bdd_cache_entry *cache;   ///< The computed cache.
+    long gc_threshold;        ///< The number of nodes in use from which garbage is collected.
+    long reorder_threshold;   ///< The number of nodes in use from which variables are reordered.
+    bool auto_reorder;        ///< Whether variables are reordered automatically.
+    int num_reorderings;      ///< The number of reorderings done.
+    const int *permutation;   ///< The permutation of the current bdd_permute.
+    int permutation_id;       ///< The number of the current bdd_permute (to tell its entries in the cache).
+};
+
+/**
+ * @brief Returns the level of node @p f (the number of variables for terminals).
+ *
+ * @param manager
+ * @param f
+ * @return int
+ */
+int bdd_level(BddManager manager, bdd f)
+{
+    int var = manager->nodes[f].var;
+    return var < 0 ? manager->num_vars : manager->var_level[var];
+}
+
+/**
+ * @brief Returns the bucket of the node of children @p low and @p high in a table of @p size buckets.
+ *
+ * @param low
+ * @param high
+ * @param size
+ * @return int
+ */
+int bdd_hash(int low, int high, int size)
+{
+    return (int)(((unsigned)low * 2654435761u ^ (unsigned)high * 40503u) & (unsigned)(size - 1));
+}
+
+/**
+ * @brief Inserts node @p f in @p table, doubling the number of buckets when the table gets crowded.
+ *
+ * @param manager
+ * @param table
+ * @param f
+ */
+void bdd_subtable_insert(BddManager manager, bdd_subtable *table, bdd f)
+{
+    if (table->count >= 2 * table->size)
+    {
+        int size = 2 * table->size;
+        int *buckets = (int *)malloc(size * sizeof(int));
+        for (int i = 0; i < size; i++)
+            buckets[i] = -1;
+        for (int i = 0; i < table->size; i++)
+            for (int node = table->buckets[i]; node != -1;)
+            {
+                int next = manager->nodes[node].next;
+                int bucket = bdd_hash(manager->nodes[node].low, manager->nodes[node].high, size);
+                manager->nodes[node].next = buckets[bucket];
+                buckets[bucket] = node;
+                node = next;
+            }
+        free(table->buckets);
+        table->buckets = buckets;
+        table->size = size;
+    }
+    int bucket = bdd_hash(manager->nodes[f].low, manager->nodes[f].high, table->size);
+    manager->nodes[f].next = table->buckets[bucket];
+    table->buckets[bucket] = f;
+    table->count++;
+}
+
+/**
+ * @brief Removes node @p f from @p table.
+ *
+ * @param manager
+ * @param table
+ * @param f
+ */
+void bdd_subtable_remove(BddManager manager, bdd_subtable *table, bdd f)
+{
+    int *link = &table->buckets[bdd_hash(manager->nodes[f].low, manager->nodes[f].high, table->size)];
+    while (*link != f)
+        link = &manager->nodes[*link].next;
+    *link = manager->nodes[f].next;
+    table->count--;
+}
+
+/**
+ * @brief Empties the computed cache of @p manager.
+ *
+ * @param manager
+ */
+void bdd_clear_cache(BddManager manager)
+{
+    memset(manager->cache, 0, BDD_CACHE_SIZE * sizeof(bdd_cache_entry));
+}
+
+/**
+ * @brief Returns the entry of the computed cache for operation @p op on @p a, @p b and @p c.
+ *
+ * @param manager
+ * @param op
+ * @param a
+ * @param b
+ * @param c
+ * @return bdd_cache_entry*
+ */
+bdd_cache_entry *bdd_cache_entry_of(BddManager manager, int op, int a, int b, int c)
+{
+    unsigned hash = (unsigned)op * 0x9E3779B1u;
+    hash = (hash ^ (unsigned)a) * 0x85EBCA6Bu;
+    hash = (hash ^ (unsigned)b) * 0xC2B2AE35u;
+    hash = (hash ^ (unsigned)c) * 0x27D4EB2Fu;
+    return &manager->cache[(hash ^ (hash >> 15)) & (BDD_CACHE_SIZE - 1)];
+}
+
+/**
+ * @brief Looks for the result of operation @p op on @p a, @p b and @p c in the computed cache.
+ *
+ * @param manager
+ * @param op
+ * @param a
+ * @param b
+ * @param c
+ * @return int The result, or -1 if it is not in the cache.
+ */
+int bdd_cache_lookup(BddManager manager, int op, int a, int b, int c)
+{
+    bdd_cache_entry *entry = bdd_cache_entry_of(manager, op, a, b, c);
+    if (entry->op == op && entry->a == a && entry->b == b && entry->c == c)
+        return entry->result;
+    return -1;
+}
+
+/**
+ * @brief Stores @p result as the result of operation @p op on @p a, @p b and @p c in the computed cache.
+ *
+ * @param manager
+ * @param op
+ * @param a
+ * @param b
+ * @param c
+ * @param result
+ */
+void bdd_cache_insert(BddManager manager, int op, int a, int b, int c, int result)
+{
+    bdd_cache_entry *entry = bdd_cache_entry_of(manager, op, a, b, c);
+    entry->op = op;
+    entry->a = a;
+    entry->b = b;
+    entry->c = c;
+    entry->result = result;
+}
+
+/**
+ * @brief Returns a free node of @p manager, allocating more nodes if needed.
+ * The array of nodes may move: no pointer to a node may be kept across this call.
+ *
+ * @param manager
+ * @return int
+ */
+int bdd_allocate(BddManager manager)
+{
+    if (manager->free_list == -1)
+    {
+        int capacity = 2 * manager->capacity;
+        manager->nodes = (bdd_node *)realloc(manager->nodes, capacity * sizeof(bdd_node));
+        for (int i = manager->capacity; i < capacity; i++)
+        {
+            manager->nodes[i].var = -2;
+            manager->nodes[i].next = i + 1 < capacity ? i + 1 : -1;
+        }
+        manager->free_list = manager->capacity;
+        manager->capacity = capacity;
+    }
+    int f = manager->free_list;
+    manager->free_list = manager->nodes[f].next;
+    manager->live++;
+    if (manager->live > manager->peak)
+        manager->peak = manager->live;
+    return f;
+}
+
+/**
+ * @brief Returns the node of variable @p var and children @p low and @p high, creating it if it does not exist (or @p low if both children are equal).
+ * A new node has no reference but those of its children are incremented.
+ *
+ * @param manager
+ * @param var
+ * @param low
+ * @param high
+ * @return bdd
+ */
+bdd bdd_make_node(BddManager manager, int var, bdd low, bdd high)
+{
+    if (low == high)
+        return low;
+    bdd_subtable *table = &manager->subtables[var];
+    for (int f = table->buckets[bdd_hash(low, high, table->size)]; f != -1; f = manager->nodes[f].next)
+        if (manager->nodes[f].low == low && manager->nodes[f].high == high)
+            return f;
+    int f = bdd_allocate(manager);
+    manager->nodes[f].var = var;
+    manager->nodes[f].low = low;
+    manager->nodes[f].high = high;
+    manager->nodes[f].refs = 0;
+    manager->nodes[low].refs++;
+    manager->nodes[high].refs++;
+    bdd_subtable_insert(manager, table, f);
+    return f;
+}
+
+/**
+ * @brief Frees node @p f, which has no reference, and then its descendants which are no longer referenced.
+ *
+ * @param manager
+ * @param f
+ */
+void bdd_free_node(BddManager manager, bdd f)
+{
+    bdd_node *node = &manager->nodes[f];
+    bdd_subtable_remove(manager, &manager->subtables[node->var], f);
+    int low = node->low;
+    int high = node->high;
+    node->var = -2;
+    node->next = manager->free_list;
+    manager->free_list = f;
+    manager->live--;
+    if (--manager->nodes[low].refs == 0)
+        bdd_free_node(manager, low);
+    if (--manager->nodes[high].refs == 0)
+        bdd_free_node(manager, high);
+}
+
+BddManager bdd_manager_create(int num_vars)
+{
+    BddManager manager = (BddManager)malloc(sizeof(struct BddManager_s));
+    manager->num_vars = num_vars;
+    manager->capacity = BDD_INITIAL_NODES;
+    manager->nodes = (bdd_node *)malloc(manager->capacity * sizeof(bdd_node));
+    for (int terminal = 0; terminal < 2; terminal++)
+    {
+        manager->nodes[terminal].var = -1;
+        manager->nodes[terminal].low = terminal;
+        manager->nodes[terminal].high = terminal;
+        manager->nodes[terminal].next = -1;
+        manager->nodes[terminal].refs = INT_MAX / 2;
+    }
+    for (int i = 2; i < manager->capacity; i++)
+    {
+        manager->nodes[i].var = -2;
+        manager->nodes[i].next = i + 1 < manager->capacity ? i + 1 : -1;
+    }
+    manager->free_list = 2;
+    manager->live = 2;
+    manager->peak = 2;
+    manager->subtables = (bdd_subtable *)malloc(num_vars * sizeof(bdd_subtable));
+    manager->var_level = (int *)malloc(num_vars * sizeof(int));
+    manager->level_var = (int *)malloc(num_vars * sizeof(int));
+    for (int var = 0; var < num_vars; var++)
+    {
+        manager->subtables[var].size = 64;
+        manager->subtables[var].count = 0;
+        manager->subtables[var].buckets = (int *)malloc(64 * sizeof(int));
+        for (int i = 0; i < 64; i++)
+            manager->subtables[var].buckets[i] = -1;
+        manager->var_level[var] = var;
+        manager->level_var[var] = var;
+    }
+    manager->cache = (bdd_cache_entry *)calloc(BDD_CACHE_SIZE, sizeof(bdd_cache_entry));
+    manager->gc_threshold = BDD_INITIAL_THRESHOLD;
+    manager->reorder_threshold = BDD_INITIAL_THRESHOLD;
+    manager->auto_reorder = true;
+    manager->num_reorderings = 0;
+    manager->permutation = NULL;
+    manager->permutation_id = 0;
+    return manager;
+}
+
+void bdd_manager_delete(BddManager manager)
+{
+    for (int var = 0; var < manager->num_vars; var++)
+        free(manager->subtables[var].buckets);
+    free(manager->subtables);
+    free(manager->var_level);
+    free(manager->level_var);
+    free(manager->cache);
+    free(manager->nodes);
+    free(manager);
+}
+
+void bdd_set_auto_reorder(BddManager manager, bool automatic)
+{
+    manager->auto_reorder = automatic;
+}
+
+bdd bdd_ref(BddManager manager, bdd f)
+{
+    manager->nodes[f].refs++;
+    return f;
+}
+
+void bdd_deref(BddManager manager, bdd f)
+{
+    manager->nodes[f].refs--;
+}
+
+void bdd_gc(BddManager manager)
+{
+    for (int f = 2; f < manager->capacity; f++)
+        if (manager->nodes[f].var >= 0 && manager->nodes[f].refs == 0)
+            bdd_free_node(manager, f);
+    bdd_clear_cache(manager);
+}
+
+/**
+ * @brief Swaps the variables at levels @p level and @p level + 1 of @p manager, in place: the nodes of the upper variable depending on the lower one are rewritten as nodes of the lower variable, so that every node keeps its function.
+ *
+ * @param manager
+ * @param level
+ *
+ * @pre Every node of @p manager must be referenced.
+ */
+void bdd_swap(BddManager manager, int level)
+{
+    int x = manager->level_var[level];
+    int y = manager->level_var[level + 1];
+    bdd_subtable *table = &manager->subtables[x];
+    int *nodes = (int *)malloc((table->count + 1) * sizeof(int));
+    int count = 0;
+    for (int i = 0; i < table->size; i++)
+        for (int f = table->buckets[i]; f != -1; f = manager->nodes[f].next)
+            nodes[count++] = f;
+    // The table is emptied, and shrunk if garbage collection left it sparse (swaps visit all its buckets).
+    int size = table->size;
+    while (size > 64 && 2 * count < size)
+        size /= 2;
+    if (size != table->size)
+    {
+        free(table->buckets);
+        table->buckets = (int *)malloc(size * sizeof(int));
+        table->size = size;
+    }
+    for (int i = 0; i < size; i++)
+        table->buckets[i] = -1;
+    table->count = 0;
+    manager->level_var[level] = y;
+    manager->level_var[level + 1] = x;
+    manager->var_level[y] = level;
+    manager->var_level[x] = level + 1;
+
+    // The nodes of x with no child labelled by y keep their function as they are: they are put back first, so that the nodes of x created below find them.
+    int num_moving = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int f = nodes[i];
+        if (manager->nodes[manager->nodes[f].low].var != y && manager->nodes[manager->nodes[f].high].var != y)
+            bdd_subtable_insert(manager, table, f);
+        else
+            nodes[num_moving++] = f;
+    }
+    for (int i = 0; i < num_moving; i++)
+    {
+        int f = nodes[i];
+        int f1 = manager->nodes[f].high;
+        int f0 = manager->nodes[f].low;
+        int f11 = f1, f10 = f1, f01 = f0, f00 = f0;
+        if (manager->nodes[f1].var == y)
+        {
+            f11 = manager->nodes[f1].high;
+            f10 = manager->nodes[f1].low;
+        }
+        if (manager->nodes[f0].var == y)
+        {
+            f01 = manager->nodes[f0].high;
+            f00 = manager->nodes[f0].low;
+        }
+        int high = bdd_ref(manager, bdd_make_node(manager, x, f01, f11));
+        int low = bdd_ref(manager, bdd_make_node(manager, x, f00, f10));
+        manager->nodes[f].var = y;
+        manager->nodes[f].low = low;
+        manager->nodes[f].high = high;
+        bdd_subtable_insert(manager, &manager->subtables[y], f);
+        if (--manager->nodes[f1].refs == 0)
+            bdd_free_node(manager, f1);
+        if (--manager->nodes[f0].refs == 0)
+            bdd_free_node(manager, f0);
+    }
+    free(nodes);
+}
+
+/**
+ * @brief Moves variable @p var of @p manager towards level @p level by swaps of adjacent levels, recording the smallest number of nodes met on the way together with its level.
+ *
+ * @param manager
+ * @param var
+ * @param level
+ * @param best Updated with the smallest number of nodes met.
+ * @param best_level Updated with the level of @p var when @p best was met.
+ * @param bounded Whether to stop early when the number of nodes grows beyond BDD_MAX_GROWTH times @p best.
+ */
+void bdd_sift_to(BddManager manager, int var, int level, long *best, int *best_level, bool bounded)
+{
+    while (manager->var_level[var] != level)
+    {
+        int current = manager->var_level[var];
+        bdd_swap(manager, current < level ? current : current - 1);
+        if (manager->live < *best)
+        {
+            *best = manager->live;
+            *best_level = manager->var_level[var];
+        }
+        else if (bounded && manager->live > BDD_MAX_GROWTH * *best)
+            return;
+    }
+}
+
+void bdd_reorder(BddManager manager)
+{
+    bdd_gc(manager);
+    int num_vars = manager->num_vars;
+    // Variables with the most nodes are sifted first.
+    int order[num_vars];
+    for (int var = 0; var < num_vars; var++)
+    {
+        int position = var;
+        while (position > 0 && manager->subtables[order[position - 1]].count < manager->subtables[var].count)
+        {
+            order[position] = order[position - 1];
+            position--;
+        }
+        order[position] = var;
+    }
+    for (int i = 0; i < num_vars; i++)
+    {
+        int var = order[i];
+        long best = manager->live;
+        int best_level = manager->var_level[var];
+        // The closest end is visited first.
+        bool down_first = manager->var_level[var] >= num_vars / 2;
+        bdd_sift_to(manager, var, down_first ? num_vars - 1 : 0, &best, &best_level, true);
+        bdd_sift_to(manager, var, down_first ? 0 : num_vars - 1, &best, &best_level, true);
+        bdd_sift_to(manager, var, best_level, &best, &best_level, false);
+    }
+    manager->num_reorderings++;
+    bdd_clear_cache(manager);
+}
+
+/**
+ * @brief Called when a top-level operation starts: collects garbage when the number of nodes reached its threshold, and then reorders the variables if allowed and the number of nodes left still reaches the threshold of reordering. The operands @p a, @p b and @p c (-1 if unused) are protected.
+ *
+ * @param manager
+ * @param a
+ * @param b
+ * @param c
+ */
+void bdd_maintain(BddManager manager, bdd a, bdd b, bdd c)
+{
+    bool collect = manager->live >= manager->gc_threshold;
+    bool reorder = manager->auto_reorder && manager->live >= manager->reorder_threshold;
+    if (!collect && !reorder)
+        return;
+    int operands[3] = {a, b, c};
+    for (int i = 0; i < 3; i++)
+        if (operands[i] >= 0)
+            bdd_ref(manager, operands[i]);
+    bdd_gc(manager);
+    // Only the nodes surviving garbage collection tell whether the order got bad.
+    if (reorder && manager->live >= manager->reorder_threshold)
+    {
+        bdd_reorder(manager);
+        manager->reorder_threshold = 2 * manager->live > BDD_INITIAL_THRESHOLD ? 2 * manager->live : BDD_INITIAL_THRESHOLD;
+    }
+    if (2 * manager->live > manager->gc_threshold)
+        manager->gc_threshold = 2 * manager->live;
+    for (int i = 0; i < 3; i++)
+        if (operands[i] >= 0)
+            bdd_deref(manager, operands[i]);
+}
+
+/**
+ * @brief Writes in @p high and @p low the cofactors of @p f with respect to the variable at level @p level.
+ *
+ * @param manager
+ * @param f
+ * @param level
+ * @param high
+ * @param low
+ */
+void bdd_cofactors(BddManager manager, bdd f, int level, bdd *high, bdd *low)
+{
+    if (bdd_level(manager, f) == level)
+    {
+        *high = manager->nodes[f].high;
+        *low = manager->nodes[f].low;
+    }
+    else
+    {
+        *high = f;
+        *low = f;
+    }
+}
+
+/**
+ * @brief Recursive part of bdd_ite.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @param h
+ * @return bdd
+ */
+bdd bdd_ite_rec(BddManager manager, bdd f, bdd g, bdd h)
+{
+    if (f == BDD_TRUE)
+        return g;
+    if (f == BDD_FALSE)
+        return h;
+    if (g == h)
+        return g;
+    if (g == BDD_TRUE && h == BDD_FALSE)
+        return f;
+    int result = bdd_cache_lookup(manager, BDD_OP_ITE, f, g, h);
+    if (result != -1)
+        return result;
+    int level = bdd_level(manager, f);
+    if (bdd_level(manager, g) < level)
+        level = bdd_level(manager, g);
+    if (bdd_level(manager, h) < level)
+        level = bdd_level(manager, h);
+    bdd f1, f0, g1, g0, h1, h0;
+    bdd_cofactors(manager, f, level, &f1, &f0);
+    bdd_cofactors(manager, g, level, &g1, &g0);
+    bdd_cofactors(manager, h, level, &h1, &h0);
+    bdd high = bdd_ite_rec(manager, f1, g1, h1);
+    bdd low = bdd_ite_rec(manager, f0, g0, h0);
+    result = bdd_make_node(manager, manager->level_var[level], low, high);
+    bdd_cache_insert(manager, BDD_OP_ITE, f, g, h, result);
+    return result;
+}
+
+/**
+ * @brief Recursive part of bdd_exists.
+ *
+ * @param manager
+ * @param f
+ * @param cube
+ * @return bdd
+ */
+bdd bdd_exists_rec(BddManager manager, bdd f, bdd cube)
+{
+    if (f <= BDD_TRUE)
+        return f;
+    int level = bdd_level(manager, f);
+    while (cube != BDD_TRUE && bdd_level(manager, cube) < level)
+        cube = manager->nodes[cube].high;
+    if (cube == BDD_TRUE)
+        return f;
+    int result = bdd_cache_lookup(manager, BDD_OP_EXISTS, f, cube, 0);
+    if (result != -1)
+        return result;
+    bdd high = manager->nodes[f].high;
+    bdd low = manager->nodes[f].low;
+    if (bdd_level(manager, cube) == level)
+    {
+        bdd rest = manager->nodes[cube].high;
+        result = bdd_exists_rec(manager, low, rest);
+        if (result != BDD_TRUE)
+            result = bdd_ite_rec(manager, result, BDD_TRUE, bdd_exists_rec(manager, high, rest));
+    }
+    else
+    {
+        high = bdd_exists_rec(manager, high, cube);
+        low = bdd_exists_rec(manager, low, cube);
+        result = bdd_make_node(manager, manager->nodes[f].var, low, high);
+    }
+    bdd_cache_insert(manager, BDD_OP_EXISTS, f, cube, 0, result);
+    return result;
+}
+
+/**
+ * @brief Recursive part of bdd_and_exists.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ * @param cube
+ * @return bdd
+ */
+bdd bdd_and_exists_rec(BddManager manager, bdd f, bdd g, bdd cube)
+{
+    if (f == BDD_FALSE || g == BDD_FALSE)
+        return BDD_FALSE;
+    if (f == BDD_TRUE || f == g)
+        return bdd_exists_rec(manager, g, cube);
+    if (g == BDD_TRUE)
+        return bdd_exists_rec(manager, f, cube);
+    if (f > g)
+    {
+        bdd swap = f;
+        f = g;
+        g = swap;
+    }
+    int level = bdd_level(manager, f);
+    if (bdd_level(manager, g) < level)
+        level = bdd_level(manager, g);
+    while (cube != BDD_TRUE && bdd_level(manager, cube) < level)
+        cube = manager->nodes[cube].high;
+    if (cube == BDD_TRUE)
+        return bdd_ite_rec(manager, f, g, BDD_FALSE);
+    int result = bdd_cache_lookup(manager, BDD_OP_AND_EXISTS, f, g, cube);
+    if (result != -1)
+        return result;
+    bdd f1, f0, g1, g0;
+    bdd_cofactors(manager, f, level, &f1, &f0);
+    bdd_cofactors(manager, g, level, &g1, &g0);
+    if (bdd_level(manager, cube) == level)
+    {
+        bdd rest = manager->nodes[cube].high;
+        result = bdd_and_exists_rec(manager, f0, g0, rest);
+        if (result != BDD_TRUE)
+            result = bdd_ite_rec(manager, result, BDD_TRUE, bdd_and_exists_rec(manager, f1, g1, rest));
+    }
+    else
+    {
+        bdd high = bdd_and_exists_rec(manager, f1, g1, cube);
+        bdd low = bdd_and_exists_rec(manager, f0, g0, cube);
+        result = bdd_make_node(manager, manager->level_var[level], low, high);
+    }
+    bdd_cache_insert(manager, BDD_OP_AND_EXISTS, f, g, cube, result);
+    return result;
+}
+
+/**
+ * @brief Recursive part of bdd_permute, using the permutation stored in @p manager.
+ *
+ * @param manager
+ * @param f
+ * @return bdd
+ */
+bdd bdd_permute_rec(BddManager manager, bdd f)
+{
+    if (f <= BDD_TRUE)
+        return f;
+    int result = bdd_cache_lookup(manager, BDD_OP_PERMUTE, f, manager->permutation_id, 0);
+    if (result != -1)
+        return result;
+    bdd high = bdd_permute_rec(manager, manager->nodes[f].high);
+    bdd low = bdd_permute_rec(manager, manager->nodes[f].low);
+    bdd var = bdd_make_node(manager, manager->permutation[manager->nodes[f].var], BDD_FALSE, BDD_TRUE);
+    result = bdd_ite_rec(manager, var, high, low);
+    bdd_cache_insert(manager, BDD_OP_PERMUTE, f, manager->permutation_id, 0, result);
+    return result;
+}
+
+bdd bdd_var(BddManager manager, int var)
+{
+    bdd_maintain(manager, -1, -1, -1);
+    return bdd_make_node(manager, var, BDD_FALSE, BDD_TRUE);
+}
+
+bdd bdd_not(BddManager manager, bdd f)
+{
+    bdd_maintain(manager, f, -1, -1);
+    return bdd_ite_rec(manager, f, BDD_FALSE, BDD_TRUE);
+}
+
+bdd bdd_and(BddManager manager, bdd f, bdd g)
+{
+    bdd_maintain(manager, f, g, -1);
+    return bdd_ite_rec(manager, f, g, BDD_FALSE);
+}
+
+bdd bdd_or(BddManager manager, bdd f, bdd g)
+{
+    bdd_maintain(manager, f, g, -1);
+    return bdd_ite_rec(manager, f, BDD_TRUE, g);
+}
+
+bdd bdd_ite(BddManager manager, bdd f, bdd g, bdd h)
+{
+    bdd_maintain(manager, f, g, h);
+    return bdd_ite_rec(manager, f, g, h);
+}
+
+bdd bdd_cube(BddManager manager, const int *vars, int num_vars)
+{
+    bdd_maintain(manager, -1, -1, -1);
+    // The cube is built from its lowest variable up.
+    int sorted[num_vars + 1];
+    for (int i = 0; i < num_vars; i++)
+    {
+        int position = i;
+        while (position > 0 && manager->var_level[sorted[position - 1]] < manager->var_level[vars[i]])
+        {
+            sorted[position] = sorted[position - 1];
+            position--;
+        }
+        sorted[position] = vars[i];
+    }
+    bdd cube = BDD_TRUE;
+    for (int i = 0; i < num_vars; i++)
+        cube = bdd_make_node(manager, sorted[i], BDD_FALSE, cube);
+    return cube;
+}
+
+bdd bdd_exists(BddManager manager, bdd f, bdd cube)
+{
+    bdd_maintain(manager, f, cube, -1);
+    return bdd_exists_rec(manager, f, cube);
+}
+
+bdd bdd_and_exists(BddManager manager, bdd f, bdd g, bdd cube)
+{
+    bdd_maintain(manager, f, g, cube);
+    return bdd_and_exists_rec(manager, f, g, cube);
+}
+
+bdd bdd_permute(BddManager manager, bdd f, const int *permutation)
+{
+    bdd_maintain(manager, f, -1, -1);
+    manager->permutation = permutation;
+    manager->permutation_id++;
+    return bdd_permute_rec(manager, f);
+}
+
+bool bdd_evaluate(BddManager manager, bdd f, const bool *assignment)
+{
+    while (f > BDD_TRUE)
+        f = assignment[manager->nodes[f].var] ? manager->nodes[f].high : manager->nodes[f].low;
+    return f == BDD_TRUE;
+}
+
+bool bdd_pick_assignment(BddManager manager, bdd f, bool *assignment)
+{
+    if (f == BDD_FALSE)
+        return false;
+    memset(assignment, 0, manager->num_vars * sizeof(bool));
+    while (f > BDD_TRUE)
+    {
+        // Every node but false is satisfiable, so false children are the only ones to avoid.
+        bool value = manager->nodes[f].low == BDD_FALSE;
+        assignment[manager->nodes[f].var] = value;
+        f = value ? manager->nodes[f].high : manager->nodes[f].low;
+    }
+    return true;
+}
+
+/**
+ * @brief Recursive part of bdd_sat_count: returns the probability that a random assignment satisfies @p f.
+ *
+ * @param manager
+ * @param f
+ * @param memory The probability of the nodes already visited (negative for the others).
+ * @return double
+ */
+double bdd_probability(BddManager manager, bdd f, double *memory)
+{
+    if (f <= BDD_TRUE)
+        return f;
+    if (memory[f] < 0)
+        memory[f] = (bdd_probability(manager, manager->nodes[f].low, memory) + bdd_probability(manager, manager->nodes[f].high, memory)) / 2;
+    return memory[f];
+}
+
+double bdd_sat_count(BddManager manager, bdd f)
+{
+    double *memory = (double *)malloc(manager->capacity * sizeof(double));
+    for (int i = 0; i < manager->capacity; i++)
+        memory[i] = -1;
+    double count = bdd_probability(manager, f, memory);
+    for (int var = 0; var < manager->num_vars; var++)
+        count *= 2;
+    free(memory);
+    return count;
+}
+
+/**
+ * @brief Recursive part of bdd_node_count.
+ *
+ * @param manager
+ * @param f
+ * @param visited The nodes already counted.
+ * @return long The number of nodes reachable from @p f not counted yet.
+ */
+long bdd_count_nodes(BddManager manager, bdd f, bool *visited)
+{
+    if (visited[f])
+        return 0;
+    visited[f] = true;
+    if (f <= BDD_TRUE)
+        return 1;
+    return 1 + bdd_count_nodes(manager, manager->nodes[f].low, visited) + bdd_count_nodes(manager, manager->nodes[f].high, visited);
+}
+
+long bdd_node_count(BddManager manager, bdd f)
+{
+    bool *visited = (bool *)calloc(manager->capacity, sizeof(bool));
+    long count = bdd_count_nodes(manager, f, visited);
+    free(visited);
+    return count;
+}
+
+long bdd_live_nodes(BddManager manager)
+{
+    return manager->live;
+}
+
+long bdd_peak_nodes(BddManager manager)
+{
+    return manager->peak;
+}
+
+int bdd_num_reorderings(BddManager manager)
+{
+    return manager->num_reorderings;
+}
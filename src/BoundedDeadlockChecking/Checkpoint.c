@@ -0,0 +1,176 @@
+#include "Checkpoint.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief The header of a checkpoint file.
+ */
+typedef struct
+{
+    char magic[8];        ///< CHECKPOINT_MAGIC.
+    uint32_t version;     ///< CHECKPOINT_VERSION.
+    uint32_t kind;        ///< The engine which wrote the file (a checkpoint_kind).
+    uint64_t fingerprint; ///< The fingerprint of the automata.
+} checkpoint_header;
+
+/**
+ * @brief The first bytes of every checkpoint file.
+ */
+#define CHECKPOINT_MAGIC "COCACKP"
+
+/**
+ * @brief The version of the format of checkpoint files.
+ */
+#define CHECKPOINT_VERSION 1
+
+/**
+ * @brief Mixes @p value into @p hash (FNV-1a on 32-bit words).
+ *
+ * @param hash
+ * @param value
+ * @return uint64_t
+ */
+uint64_t checkpoint_mix(uint64_t hash, int value)
+{
+    hash ^= (uint32_t)value;
+    return hash * 0x100000001B3ULL;
+}
+
+uint64_t checkpoint_fingerprint(LockAutomaton *automata, int num_automata)
+{
+    uint64_t hash = checkpoint_mix(0xCBF29CE484222325ULL, num_automata);
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        hash = checkpoint_mix(hash, num_nodes);
+        hash = checkpoint_mix(hash, la_get_initial(automata[aut]));
+        for (int source = 0; source < num_nodes; source++)
+            for (int target = 0; target < num_nodes; target++)
+            {
+                bool edge = la_is_edge(automata[aut], source, target);
+                hash = checkpoint_mix(hash, edge);
+                if (edge)
+                    hash = checkpoint_mix(hash, la_get_edge_action(automata[aut], source, target));
+            }
+    }
+    return hash;
+}
+
+double checkpoint_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+bool checkpoint_due(const checkpoint_options *options, double *last)
+{
+    if (options == NULL || options->file == NULL)
+        return false;
+    double now = checkpoint_now();
+    if (now - *last < options->interval)
+        return false;
+    *last = now;
+    return true;
+}
+
+/**
+ * @brief Writes in @p name the path of the temporary file used while writing the checkpoint of @p options.
+ *
+ * @param options The checkpoint options.
+ * @param name Receives the path.
+ * @param length The size of @p name.
+ */
+void checkpoint_temporary_name(const checkpoint_options *options, char *name, int length)
+{
+    snprintf(name, length, "%s.tmp", options->file);
+}
+
+FILE *checkpoint_begin(const checkpoint_options *options, checkpoint_kind kind, uint64_t fingerprint)
+{
+    int length = strlen(options->file) + 8;
+    char name[length];
+    checkpoint_temporary_name(options, name, length);
+    FILE *file = fopen(name, "wb");
+    if (file == NULL)
+        return NULL;
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+    checkpoint_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.kind = kind;
+    header.fingerprint = fingerprint;
+    fwrite(&header, sizeof(header), 1, file);
+    return file;
+}
+
+void checkpoint_align(FILE *file)
+{
+    static const char zeros[8] = {0};
+    long position = ftell(file);
+    if (position % 8 != 0)
+        fwrite(zeros, 1, 8 - position % 8, file);
+}
+
+bool checkpoint_end(const checkpoint_options *options, FILE *file)
+{
+    int length = strlen(options->file) + 8;
+    char name[length];
+    checkpoint_temporary_name(options, name, length);
+    bool ok = !ferror(file);
+    ok = fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+    if (ok)
+        ok = rename(name, options->file) == 0;
+    if (!ok)
+        unlink(name);
+    return ok;
+}
+
+bool checkpoint_map(const checkpoint_options *options, checkpoint_kind kind, uint64_t fingerprint, checkpoint_mapping *mapping)
+{
+    mapping->address = NULL;
+    mapping->size = 0;
+    mapping->data = NULL;
+    mapping->data_size = 0;
+    if (options == NULL || options->file == NULL || !options->resume)
+        return false;
+    int descriptor = open(options->file, O_RDONLY);
+    if (descriptor == -1)
+        return false;
+    struct stat status;
+    if (fstat(descriptor, &status) == -1 || (size_t)status.st_size < sizeof(checkpoint_header))
+    {
+        close(descriptor);
+        return false;
+    }
+    void *address = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED)
+        return false;
+    const checkpoint_header *header = (const checkpoint_header *)address;
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0 || header->version != CHECKPOINT_VERSION || header->kind != (uint32_t)kind || header->fingerprint != fingerprint)
+    {
+        munmap(address, status.st_size);
+        return false;
+    }
+    mapping->address = address;
+    mapping->size = status.st_size;
+    mapping->data = (const char *)address + sizeof(checkpoint_header);
+    mapping->data_size = status.st_size - sizeof(checkpoint_header);
+    return true;
+}
+
+void checkpoint_unmap(checkpoint_mapping *mapping)
+{
+    if (mapping->address != NULL)
+        munmap(mapping->address, mapping->size);
+    mapping->address = NULL;
+}
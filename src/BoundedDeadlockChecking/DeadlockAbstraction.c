@@ -0,0 +1,106 @@
+#include "DeadlockAbstraction.h"
+#include "DeadlockReduction.h"
+#include "DeadlockWitness.h"
+#include "Z3Tools.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tracks in @p tracked the locks explaining why @p path, obtained from a model of the abstraction tracking @p tracked, is not a deadlock of @p automata.
+ * Each lock is replayed alone along the path: it is added if it is acquired while taken or released while free. Then, for each automaton which can still move at the end of the path, the lock of one of its possible edges is added (the abstraction let this edge be blocked).
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param path A path given by the abstraction.
+ * @param size_path The size of @p path.
+ * @param max_lock The biggest lock used.
+ * @param tracked For each lock, whether it is tracked. Updated.
+ * @return int The number of locks added.
+ */
+int refine_abstraction(LockAutomaton *automata, int num_automata, const step *path, int size_path, int max_lock, bool *tracked)
+{
+    bool taken[max_lock + 1];
+    bool faulty[max_lock + 1];
+    memset(taken, 0, sizeof(taken));
+    memset(faulty, 0, sizeof(faulty));
+    int nodes[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+        nodes[aut] = la_get_initial(automata[aut]);
+    for (int i = 0; i < size_path; i++)
+    {
+        nodes[path[i].automaton] = path[i].target;
+        int lock = abs(path[i].action);
+        if (lock == 0)
+            continue;
+        if ((path[i].action > 0) == taken[lock])
+            faulty[lock] = true;
+        taken[lock] = path[i].action > 0;
+    }
+    for (int aut = 0; aut < num_automata; aut++)
+        for (int target = 0; target < la_get_num_nodes(automata[aut]); target++)
+        {
+            if (!la_is_edge(automata[aut], nodes[aut], target))
+                continue;
+            int action = la_get_edge_action(automata[aut], nodes[aut], target);
+            if (action != 0 && !tracked[abs(action)] && (action > 0) != taken[abs(action)])
+            {
+                faulty[abs(action)] = true;
+                break;
+            }
+        }
+    int added = 0;
+    for (int lock = 1; lock <= max_lock; lock++)
+        if (faulty[lock] && !tracked[lock])
+        {
+            tracked[lock] = true;
+            added++;
+        }
+    return added;
+}
+
+Z3_lbool deadlock_abstraction_refinement(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, step *path, abstraction_statistics *statistics)
+{
+    int max_lock = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        if (max_lock < la_get_max_lock(automata[aut]))
+            max_lock = la_get_max_lock(automata[aut]);
+    bool tracked[max_lock + 1];
+    memset(tracked, 0, sizeof(tracked));
+    abstraction_statistics local;
+    if (statistics == NULL)
+        statistics = &local;
+    statistics->num_iterations = 0;
+    statistics->num_locks = max_lock;
+    statistics->num_tracked = 0;
+
+    Z3_lbool result = Z3_L_UNDEF;
+    bool refined = true;
+    while (refined)
+    {
+        statistics->num_iterations++;
+        Z3_solver solver = pooled_solver(ctx);
+        Z3_ast formula = deadlock_abstract_reduction(ctx, automata, num_automata, bound, tracked);
+        Z3_solver_assert(ctx, solver, formula);
+        release_formula(ctx, formula);
+        result = Z3_solver_check(ctx, solver);
+        refined = false;
+        if (result == Z3_L_TRUE)
+        {
+            Z3_model model = Z3_solver_get_model(ctx, solver);
+            Z3_model_inc_ref(ctx, model);
+            la_path_from_model(ctx, model, automata, num_automata, path, bound);
+            Z3_model_dec_ref(ctx, model);
+            if (witness_validate(automata, num_automata, path, bound, NULL) != WITNESS_VALID)
+            {
+                int added = refine_abstraction(automata, num_automata, path, bound, max_lock, tracked);
+                statistics->num_tracked += added;
+                refined = added > 0;
+                // A spurious path which no lock explains cannot happen: the locks tracked behave as in the automata.
+                if (!refined)
+                    result = Z3_L_UNDEF;
+            }
+        }
+        Z3_solver_dec_ref(ctx, solver);
+    }
+    return result;
+}
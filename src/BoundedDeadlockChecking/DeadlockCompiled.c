@@ -0,0 +1,314 @@
+#include "DeadlockCompiled.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief The part of the generated program that does not depend on the instance: the store of visited states, its hash table and the breadth-first search.
+ * It relies on NUM_AUTOMATA, STATE_SIZE, MAX_MOVES, initial_state and successors, written before it by deadlock_compiled_generate.
+ */
+static const char *compiled_runtime =
+    "static unsigned *states;\n"
+    "static long *parents;\n"
+    "static move *moves_to;\n"
+    "static long num_states, states_capacity;\n"
+    "static long *table;\n"
+    "static long table_capacity, table_start;\n"
+    "\n"
+    "static uint64_t hash_state(const unsigned *key)\n"
+    "{\n"
+    "    uint64_t hash = 0x9E3779B97F4A7C15ULL;\n"
+    "    for (int i = 0; i < STATE_SIZE; i++)\n"
+    "    {\n"
+    "        hash ^= key[i];\n"
+    "        hash *= 0xFF51AFD7ED558CCDULL;\n"
+    "        hash ^= hash >> 32;\n"
+    "    }\n"
+    "    hash ^= hash >> 33;\n"
+    "    hash *= 0xC4CEB9FE1A85EC53ULL;\n"
+    "    hash ^= hash >> 33;\n"
+    "    return hash;\n"
+    "}\n"
+    "\n"
+    "static long find_slot(const unsigned *key)\n"
+    "{\n"
+    "    long mask = table_capacity - 1;\n"
+    "    long slot = hash_state(key) & mask;\n"
+    "    while (table[slot] != -1 && memcmp(states + table[slot] * STATE_SIZE, key, STATE_SIZE * sizeof(unsigned)) != 0)\n"
+    "        slot = (slot + 1) & mask;\n"
+    "    return slot;\n"
+    "}\n"
+    "\n"
+    "static void reset_table(long capacity)\n"
+    "{\n"
+    "    free(table);\n"
+    "    table_capacity = capacity;\n"
+    "    table = (long *)malloc(table_capacity * sizeof(long));\n"
+    "    for (long slot = 0; slot < table_capacity; slot++)\n"
+    "        table[slot] = -1;\n"
+    "    for (long index = table_start; index < num_states; index++)\n"
+    "        table[find_slot(states + index * STATE_SIZE)] = index;\n"
+    "}\n"
+    "\n"
+    "static void insert(const unsigned *key, long parent, move last)\n"
+    "{\n"
+    "    if (2 * (num_states - table_start + 1) > table_capacity)\n"
+    "        reset_table(2 * table_capacity);\n"
+    "    long slot = find_slot(key);\n"
+    "    if (table[slot] != -1)\n"
+    "        return;\n"
+    "    if (num_states == states_capacity)\n"
+    "    {\n"
+    "        states_capacity *= 2;\n"
+    "        states = (unsigned *)realloc(states, states_capacity * STATE_SIZE * sizeof(unsigned));\n"
+    "        parents = (long *)realloc(parents, states_capacity * sizeof(long));\n"
+    "        moves_to = (move *)realloc(moves_to, states_capacity * sizeof(move));\n"
+    "    }\n"
+    "    memcpy(states + num_states * STATE_SIZE, key, STATE_SIZE * sizeof(unsigned));\n"
+    "    parents[num_states] = parent;\n"
+    "    moves_to[num_states] = last;\n"
+    "    table[slot] = num_states++;\n"
+    "}\n"
+    "\n"
+    "static void print_deadlock(long index)\n"
+    "{\n"
+    "    int length = 0;\n"
+    "    for (long current = index; parents[current] != -1; current = parents[current])\n"
+    "        length++;\n"
+    "    move *path = (move *)malloc((length + 1) * sizeof(move));\n"
+    "    int position = length;\n"
+    "    for (long current = index; parents[current] != -1; current = parents[current])\n"
+    "        path[--position] = moves_to[current];\n"
+    "    printf(\"states %ld\\ndeadlock %d\\n\", num_states, length);\n"
+    "    for (int i = 0; i < length; i++)\n"
+    "        printf(\"%d %d %d %d\\n\", path[i].automaton, path[i].source, path[i].target, path[i].action);\n"
+    "    free(path);\n"
+    "}\n"
+    "\n"
+    "int main(int argc, char **argv)\n"
+    "{\n"
+    "    int bound = argc > 1 ? atoi(argv[1]) : -1;\n"
+    "    unsigned state[STATE_SIZE];\n"
+    "    unsigned next[MAX_MOVES * STATE_SIZE + 1];\n"
+    "    move moves[MAX_MOVES + 1];\n"
+    "    states_capacity = 1024;\n"
+    "    states = (unsigned *)malloc(states_capacity * STATE_SIZE * sizeof(unsigned));\n"
+    "    parents = (long *)malloc(states_capacity * sizeof(long));\n"
+    "    moves_to = (move *)malloc(states_capacity * sizeof(move));\n"
+    "    reset_table(1024);\n"
+    "    move none = {-1, -1, -1, 0};\n"
+    "    insert(initial_state, -1, none);\n"
+    "    int depth = -1;\n"
+    "    long layer_end = 0;\n"
+    "    for (long head = 0; head < num_states; head++)\n"
+    "    {\n"
+    "        if (head == layer_end)\n"
+    "        {\n"
+    "            depth++;\n"
+    "            layer_end = num_states;\n"
+    "            if (bound >= 0)\n"
+    "            {\n"
+    "                table_start = num_states;\n"
+    "                reset_table(table_capacity);\n"
+    "            }\n"
+    "        }\n"
+    "        memcpy(state, states + head * STATE_SIZE, STATE_SIZE * sizeof(unsigned));\n"
+    "        int count = successors(state, next, moves);\n"
+    "        if (count == 0 && (bound < 0 || depth == bound))\n"
+    "        {\n"
+    "            print_deadlock(head);\n"
+    "            return 0;\n"
+    "        }\n"
+    "        if (depth == bound)\n"
+    "            continue;\n"
+    "        for (int i = 0; i < count; i++)\n"
+    "            insert(next + i * STATE_SIZE, head, moves[i]);\n"
+    "    }\n"
+    "    printf(\"states %ld\\nno deadlock\\n\", num_states);\n"
+    "    return 0;\n"
+    "}\n";
+
+/**
+ * @brief Writes in @p file the successor function of the product of @p automata: a switch on the node of each automaton, whose cases test and update the lock words directly.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param file The file the source is written to.
+ */
+void compiled_generate_successors(LockAutomaton *automata, int num_automata, FILE *file)
+{
+    fprintf(file, "static int successors(const unsigned *state, unsigned *next, move *moves)\n{\n");
+    fprintf(file, "    int count = 0;\n");
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        fprintf(file, "    switch (state[%d])\n    {\n", aut);
+        for (int source = 0; source < num_nodes; source++)
+        {
+            bool has_edge = false;
+            for (int target = 0; target < num_nodes; target++)
+            {
+                if (!la_is_edge(automata[aut], source, target))
+                    continue;
+                if (!has_edge)
+                    fprintf(file, "    case %d:\n", source);
+                has_edge = true;
+                int action = la_get_edge_action(automata[aut], source, target);
+                int word = num_automata + abs(action) / 32;
+                unsigned mask = 1u << (abs(action) % 32);
+                if (action > 0)
+                    fprintf(file, "        if (!(state[%d] & 0x%xu))\n", word, mask);
+                else if (action < 0)
+                    fprintf(file, "        if (state[%d] & 0x%xu)\n", word, mask);
+                fprintf(file, "        {\n");
+                fprintf(file, "            unsigned *successor = next + count * STATE_SIZE;\n");
+                fprintf(file, "            memcpy(successor, state, STATE_SIZE * sizeof(unsigned));\n");
+                fprintf(file, "            successor[%d] = %d;\n", aut, target);
+                if (action != 0)
+                    fprintf(file, "            successor[%d] ^= 0x%xu;\n", word, mask);
+                fprintf(file, "            moves[count].automaton = %d;\n", aut);
+                fprintf(file, "            moves[count].source = %d;\n", source);
+                fprintf(file, "            moves[count].target = %d;\n", target);
+                fprintf(file, "            moves[count].action = %d;\n", action);
+                fprintf(file, "            count++;\n");
+                fprintf(file, "        }\n");
+            }
+            if (has_edge)
+                fprintf(file, "        break;\n");
+        }
+        fprintf(file, "    default:\n        break;\n    }\n");
+    }
+    fprintf(file, "    return count;\n}\n\n");
+}
+
+void deadlock_compiled_generate(LockAutomaton *automata, int num_automata, FILE *file)
+{
+    int max_lock = 0;
+    int max_moves = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        if (max_lock < la_get_max_lock(automata[aut]))
+            max_lock = la_get_max_lock(automata[aut]);
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        int max_degree = 0;
+        for (int source = 0; source < num_nodes; source++)
+        {
+            int degree = 0;
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automata[aut], source, target))
+                    degree++;
+            if (max_degree < degree)
+                max_degree = degree;
+        }
+        max_moves += max_degree;
+    }
+    int state_size = num_automata + max_lock / 32 + 1;
+
+    fprintf(file, "/* Deadlock checker generated for %d automata. */\n", num_automata);
+    fprintf(file, "#include <stdint.h>\n#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n\n");
+    fprintf(file, "#define NUM_AUTOMATA %d\n", num_automata);
+    fprintf(file, "#define STATE_SIZE %d\n", state_size);
+    fprintf(file, "#define MAX_MOVES %d\n\n", max_moves);
+    fprintf(file, "typedef struct\n{\n    int automaton;\n    int source;\n    int target;\n    int action;\n} move;\n\n");
+    fprintf(file, "static const unsigned initial_state[STATE_SIZE] = {");
+    for (int word = 0; word < state_size; word++)
+        fprintf(file, "%s%d", word == 0 ? "" : ", ", word < num_automata ? la_get_initial(automata[word]) : 0);
+    fprintf(file, "};\n\n");
+    compiled_generate_successors(automata, num_automata, file);
+    fputs(compiled_runtime, file);
+}
+
+/**
+ * @brief Reads the output of a generated program (see deadlock_compiled_generate).
+ *
+ * @param output The output of the program.
+ * @param path Receives the path found, or NULL.
+ * @param size_path Receives the size of the path found.
+ * @param num_states If not NULL, receives the number of states visited.
+ * @return Z3_lbool Z3_L_TRUE if a deadlock was found, Z3_L_FALSE if there is none, Z3_L_UNDEF if the output is malformed.
+ */
+Z3_lbool compiled_read_result(FILE *output, step **path, int *size_path, long *num_states)
+{
+    long states;
+    char word[16];
+    if (fscanf(output, "states %ld %15s", &states, word) != 2)
+        return Z3_L_UNDEF;
+    if (num_states != NULL)
+        *num_states = states;
+    if (strcmp(word, "no") == 0)
+        return Z3_L_FALSE;
+    int length;
+    if (strcmp(word, "deadlock") != 0 || fscanf(output, "%d", &length) != 1 || length < 0)
+        return Z3_L_UNDEF;
+    step *result = (step *)malloc((length + 1) * sizeof(step));
+    for (int i = 0; i < length; i++)
+    {
+        int automaton, source, target, action;
+        if (fscanf(output, "%d %d %d %d", &automaton, &source, &target, &action) != 4)
+        {
+            free(result);
+            return Z3_L_UNDEF;
+        }
+        result[i] = la_step_create(automaton, source, target, action);
+    }
+    *path = result;
+    *size_path = length;
+    return Z3_L_TRUE;
+}
+
+Z3_lbool deadlock_compiled_search(LockAutomaton *automata, int num_automata, int bound, step **path, int *size_path, long *num_states)
+{
+    *path = NULL;
+    *size_path = 0;
+    if (num_states != NULL)
+        *num_states = 0;
+
+    const char *tmp = getenv("TMPDIR");
+    if (tmp == NULL || tmp[0] == '\0')
+        tmp = "/tmp";
+    int length = strlen(tmp) + 32;
+    char directory[length];
+    snprintf(directory, length, "%s/cocaXXXXXX", tmp);
+    if (mkdtemp(directory) == NULL)
+        return Z3_L_UNDEF;
+    char source[length + 16];
+    char program[length + 16];
+    snprintf(source, length + 16, "%s/checker.c", directory);
+    snprintf(program, length + 16, "%s/checker", directory);
+
+    Z3_lbool res = Z3_L_UNDEF;
+    FILE *file = fopen(source, "w");
+    if (file != NULL)
+    {
+        deadlock_compiled_generate(automata, num_automata, file);
+        fclose(file);
+
+        const char *compiler = getenv("CC");
+        if (compiler == NULL || compiler[0] == '\0')
+            compiler = "cc";
+        int command_length = strlen(compiler) + 2 * length + 64;
+        char command[command_length];
+        snprintf(command, command_length, "%s -O2 -o '%s' '%s'", compiler, program, source);
+        if (system(command) == 0)
+        {
+            snprintf(command, command_length, "'%s' %d", program, bound);
+            FILE *output = popen(command, "r");
+            if (output != NULL)
+            {
+                res = compiled_read_result(output, path, size_path, num_states);
+                if (pclose(output) != 0)
+                {
+                    free(*path);
+                    *path = NULL;
+                    *size_path = 0;
+                    res = Z3_L_UNDEF;
+                }
+            }
+        }
+    }
+
+    unlink(program);
+    unlink(source);
+    rmdir(directory);
+    return res;
+}
@@ -0,0 +1,308 @@
+#include "DeadlockCounter.h"
+#include "LockProduct.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief The counter-abstracted product: classes of identical automata, and the layout of abstract states.
+ * An abstract state has, for each class, the number of its automata in each node of the class, then a bitset of the locks taken, then (for bounded searches) the number of steps done.
+ */
+typedef struct
+{
+    int num_automata;  ///< The number of automata.
+    int num_classes;   ///< The number of classes of identical automata.
+    int *class_of;     ///< The class of each automaton.
+    int *first_automaton; ///< An automaton of each class.
+    int *offset;       ///< The position of the counters of each class in a state (num_classes + 1 entries).
+    int **first_edge;  ///< For each class, the index of the first edge leaving each node in the arrays below.
+    int **edge_target; ///< For each class, the target of each edge, sorted by source.
+    int **edge_action; ///< For each class, the action of each edge, sorted by source.
+    int max_moves;     ///< The maximal number of abstract moves enabled in a state.
+    int lock_offset;   ///< The position of the bitset of locks.
+    int state_size;    ///< The number of words of a state (without the step counter).
+} counter_product;
+
+/**
+ * @brief Tells if @p first and @p second are identical (same nodes, initial node, edges and actions).
+ *
+ * @param first
+ * @param second
+ * @return true
+ * @return false
+ */
+bool counter_same_automaton(LockAutomaton first, LockAutomaton second)
+{
+    int num_nodes = la_get_num_nodes(first);
+    if (num_nodes != la_get_num_nodes(second) || la_get_initial(first) != la_get_initial(second))
+        return false;
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (la_is_edge(first, source, target) != la_is_edge(second, source, target))
+                return false;
+            if (la_is_edge(first, source, target) && la_get_edge_action(first, source, target) != la_get_edge_action(second, source, target))
+                return false;
+        }
+    return true;
+}
+
+/**
+ * @brief Computes the class of identical automata of each automaton (classes are numbered by order of first appearance).
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param class_of Receives the class of each automaton.
+ * @return int The number of classes.
+ */
+int counter_compute_classes(LockAutomaton *automata, int num_automata, int *class_of)
+{
+    int num_classes = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        class_of[aut] = -1;
+        for (int other = 0; other < aut && class_of[aut] == -1; other++)
+            if (counter_same_automaton(automata[other], automata[aut]))
+                class_of[aut] = class_of[other];
+        if (class_of[aut] == -1)
+            class_of[aut] = num_classes++;
+    }
+    return num_classes;
+}
+
+int counter_num_classes(LockAutomaton *automata, int num_automata)
+{
+    int class_of[num_automata];
+    return counter_compute_classes(automata, num_automata, class_of);
+}
+
+/**
+ * @brief Builds the counter-abstracted product of @p automata.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return counter_product* The product, to be freed with counter_delete.
+ */
+counter_product *counter_initialize(LockAutomaton *automata, int num_automata)
+{
+    counter_product *product = (counter_product *)malloc(sizeof(counter_product));
+    product->num_automata = num_automata;
+    product->class_of = (int *)malloc(num_automata * sizeof(int));
+    product->num_classes = counter_compute_classes(automata, num_automata, product->class_of);
+    int num_classes = product->num_classes;
+    product->first_automaton = (int *)malloc(num_classes * sizeof(int));
+    product->offset = (int *)malloc((num_classes + 1) * sizeof(int));
+    product->first_edge = (int **)malloc(num_classes * sizeof(int *));
+    product->edge_target = (int **)malloc(num_classes * sizeof(int *));
+    product->edge_action = (int **)malloc(num_classes * sizeof(int *));
+    product->max_moves = 0;
+    for (int aut = num_automata - 1; aut >= 0; aut--)
+        product->first_automaton[product->class_of[aut]] = aut;
+
+    int max_lock = 0;
+    product->offset[0] = 0;
+    for (int c = 0; c < num_classes; c++)
+    {
+        LockAutomaton automaton = automata[product->first_automaton[c]];
+        int num_nodes = la_get_num_nodes(automaton);
+        product->offset[c + 1] = product->offset[c] + num_nodes;
+        if (max_lock < la_get_max_lock(automaton))
+            max_lock = la_get_max_lock(automaton);
+        product->first_edge[c] = (int *)malloc((num_nodes + 1) * sizeof(int));
+        product->edge_target[c] = (int *)malloc((la_get_num_edges(automaton) + 1) * sizeof(int));
+        product->edge_action[c] = (int *)malloc((la_get_num_edges(automaton) + 1) * sizeof(int));
+        int count = 0;
+        for (int source = 0; source < num_nodes; source++)
+        {
+            product->first_edge[c][source] = count;
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automaton, source, target))
+                {
+                    product->edge_target[c][count] = target;
+                    product->edge_action[c][count] = la_get_edge_action(automaton, source, target);
+                    count++;
+                }
+        }
+        product->first_edge[c][num_nodes] = count;
+        product->max_moves += count;
+    }
+    product->lock_offset = product->offset[num_classes];
+    product->state_size = product->lock_offset + max_lock / 32 + 1;
+    return product;
+}
+
+/**
+ * @brief Frees the product built by counter_initialize.
+ *
+ * @param product
+ */
+void counter_delete(counter_product *product)
+{
+    for (int c = 0; c < product->num_classes; c++)
+    {
+        free(product->first_edge[c]);
+        free(product->edge_target[c]);
+        free(product->edge_action[c]);
+    }
+    free(product->class_of);
+    free(product->first_automaton);
+    free(product->offset);
+    free(product->first_edge);
+    free(product->edge_target);
+    free(product->edge_action);
+    free(product);
+}
+
+/**
+ * @brief Tells if @p action is possible given the locks of the abstract @p state.
+ *
+ * @param product
+ * @param state
+ * @param action An action code.
+ * @return true
+ * @return false
+ */
+bool counter_is_action_possible(counter_product *product, const unsigned *state, int action)
+{
+    if (action == 0)
+        return true;
+    int lock = abs(action);
+    bool taken = (state[product->lock_offset + lock / 32] >> (lock % 32)) & 1;
+    return action > 0 ? !taken : taken;
+}
+
+/**
+ * @brief Computes the abstract moves enabled in @p state: a move is an edge of a class leaving a node where at least one automaton of the class is (the automaton field of the step is the class).
+ *
+ * @param product
+ * @param state
+ * @param moves Receives the moves (array of size max_moves).
+ * @return int The number of moves.
+ */
+int counter_enabled_moves(counter_product *product, const unsigned *state, step *moves)
+{
+    int count = 0;
+    for (int c = 0; c < product->num_classes; c++)
+    {
+        int num_nodes = product->offset[c + 1] - product->offset[c];
+        for (int source = 0; source < num_nodes; source++)
+        {
+            if (state[product->offset[c] + source] == 0)
+                continue;
+            for (int edge = product->first_edge[c][source]; edge < product->first_edge[c][source + 1]; edge++)
+                if (counter_is_action_possible(product, state, product->edge_action[c][edge]))
+                    moves[count++] = la_step_create(c, source, product->edge_target[c][edge], product->edge_action[c][edge]);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Performs the abstract @p move on @p state (in place): one automaton of the class leaves the source for the target, and the lock of the action is flipped.
+ *
+ * @param product
+ * @param state
+ * @param move
+ */
+void counter_apply(counter_product *product, unsigned *state, step move)
+{
+    state[product->offset[move.automaton] + move.source]--;
+    state[product->offset[move.automaton] + move.target]++;
+    if (move.action != 0)
+        state[product->lock_offset + abs(move.action) / 32] ^= 1u << (abs(move.action) % 32);
+}
+
+/**
+ * @brief Turns a path of abstract moves into a path over the automata, by choosing for each move an automaton of its class standing in its source.
+ *
+ * @param product
+ * @param automata The LockAutomata considered.
+ * @param moves The abstract moves.
+ * @param size_path The number of moves.
+ * @return step* The concrete path, newly allocated.
+ */
+step *counter_concretise_path(counter_product *product, LockAutomaton *automata, const step *moves, int size_path)
+{
+    step *path = (step *)malloc((size_path + 1) * sizeof(step));
+    int current[product->num_automata];
+    for (int aut = 0; aut < product->num_automata; aut++)
+        current[aut] = la_get_initial(automata[aut]);
+    for (int i = 0; i < size_path; i++)
+    {
+        int aut = 0;
+        while (product->class_of[aut] != moves[i].automaton || current[aut] != moves[i].source)
+            aut++;
+        path[i] = la_step_create(aut, moves[i].source, moves[i].target, moves[i].action);
+        current[aut] = moves[i].target;
+    }
+    return path;
+}
+
+bool deadlock_counter_search(LockAutomaton *automata, int num_automata, int bound, step **path, int *size_path, long *num_states)
+{
+    counter_product *product = counter_initialize(automata, num_automata);
+    bool bounded = bound >= 0;
+    int size = product->state_size + (bounded ? 1 : 0);
+    StateSet visited = lp_set_create(size);
+    long capacity = 1024;
+    long *parent = (long *)malloc(capacity * sizeof(long));
+    step *discovery = (step *)malloc(capacity * sizeof(step));
+    step moves[product->max_moves + 1];
+    unsigned state[size];
+
+    memset(state, 0, size * sizeof(unsigned));
+    for (int aut = 0; aut < num_automata; aut++)
+        state[product->offset[product->class_of[aut]] + la_get_initial(automata[aut])]++;
+    lp_set_insert(visited, state);
+    parent[0] = -1;
+    *path = NULL;
+    *size_path = 0;
+    bool found = false;
+    for (long index = 0; index < lp_set_size(visited); index++)
+    {
+        memcpy(state, lp_set_get(visited, index), size * sizeof(unsigned));
+        int num_moves = counter_enabled_moves(product, state, moves);
+        if (num_moves == 0 && (!bounded || (int)state[size - 1] == bound))
+        {
+            int length = 0;
+            for (long current = index; parent[current] != -1; current = parent[current])
+                length++;
+            step abstract[length + 1];
+            int position = length;
+            for (long current = index; parent[current] != -1; current = parent[current])
+                abstract[--position] = discovery[current];
+            *path = counter_concretise_path(product, automata, abstract, length);
+            *size_path = length;
+            found = true;
+            break;
+        }
+        if (bounded && (int)state[size - 1] == bound)
+            continue;
+        if (bounded)
+            state[size - 1]++;
+        for (int i = 0; i < num_moves; i++)
+        {
+            unsigned next[size];
+            memcpy(next, state, size * sizeof(unsigned));
+            counter_apply(product, next, moves[i]);
+            if (!lp_set_insert(visited, next))
+                continue;
+            long new_index = lp_set_size(visited) - 1;
+            if (new_index == capacity)
+            {
+                capacity *= 2;
+                parent = (long *)realloc(parent, capacity * sizeof(long));
+                discovery = (step *)realloc(discovery, capacity * sizeof(step));
+            }
+            parent[new_index] = index;
+            discovery[new_index] = moves[i];
+        }
+    }
+    if (num_states != NULL)
+        *num_states = lp_set_size(visited);
+    free(parent);
+    free(discovery);
+    lp_set_delete(visited);
+    counter_delete(product);
+    return found;
+}
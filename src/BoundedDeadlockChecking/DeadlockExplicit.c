@@ -0,0 +1,687 @@
+#include "DeadlockExplicit.h"
+#include "LockProduct.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Rebuilds the path leading to the state numbered @p index of a breadth-first search, by following the parents of the states.
+ *
+ * @param parent The number of the state from which each state was discovered (-1 for the initial state).
+ * @param moves The move by which each state was discovered.
+ * @param index The number of the last state of the path.
+ * @param size_path Receives the size of the path.
+ * @return step* The path, newly allocated.
+ */
+step *explicit_build_path(const long *parent, const step *moves, long index, int *size_path)
+{
+    int size = 0;
+    for (long current = index; parent[current] != -1; current = parent[current])
+        size++;
+    step *path = (step *)malloc((size + 1) * sizeof(step));
+    int position = size;
+    for (long current = index; parent[current] != -1; current = parent[current])
+        path[--position] = moves[current];
+    *size_path = size;
+    return path;
+}
+
+/**
+ * @brief The breadth-first search of deadlock_explicit_search_checkpointed: the states visited (numbered in the order of discovery), and how each one was discovered.
+ */
+typedef struct
+{
+    StateSet visited; ///< The states visited.
+    long capacity;    ///< The capacity of the arrays below.
+    long *parent;     ///< The number of the state from which each state was discovered (-1 for the initial state).
+    step *discovery;  ///< The move by which each state was discovered.
+} explicit_bfs;
+
+/**
+ * @brief Records the discovery of the state numbered @p index in @p bfs from state @p parent by @p move.
+ *
+ * @param bfs The search.
+ * @param index The number of the new state.
+ * @param parent The number of its parent.
+ * @param move The move from the parent to the new state.
+ */
+void explicit_record(explicit_bfs *bfs, long index, long parent, step move)
+{
+    if (index == bfs->capacity)
+    {
+        bfs->capacity *= 2;
+        bfs->parent = (long *)realloc(bfs->parent, bfs->capacity * sizeof(long));
+        bfs->discovery = (step *)realloc(bfs->discovery, bfs->capacity * sizeof(step));
+    }
+    bfs->parent[index] = parent;
+    bfs->discovery[index] = move;
+}
+
+/**
+ * @brief Writes a checkpoint of @p bfs: the size of the states, the number of states visited and the number of the next state to expand, then the states, their parents and the moves discovering them.
+ * The states from @p next_index on form the frontier of the search.
+ *
+ * @param bfs The search.
+ * @param size The number of words of a state.
+ * @param next_index The number of the next state to expand.
+ * @param options The checkpoint options.
+ * @param fingerprint The fingerprint of the automata.
+ */
+void explicit_checkpoint(explicit_bfs *bfs, int size, long next_index, const checkpoint_options *options, uint64_t fingerprint)
+{
+    FILE *file = checkpoint_begin(options, CHECKPOINT_EXPLICIT, fingerprint);
+    if (file == NULL)
+        return;
+    long num_keys = lp_set_size(bfs->visited);
+    int64_t counts[3] = {size, num_keys, next_index};
+    fwrite(counts, sizeof(int64_t), 3, file);
+    for (long index = 0; index < num_keys; index++)
+        fwrite(lp_set_get(bfs->visited, index), sizeof(unsigned), size, file);
+    checkpoint_align(file);
+    fwrite(bfs->parent, sizeof(long), num_keys, file);
+    fwrite(bfs->discovery, sizeof(step), num_keys, file);
+    checkpoint_end(options, file);
+}
+
+/**
+ * @brief Restores @p bfs from the checkpoint of @p options, if there is a valid one.
+ *
+ * @param bfs The search, with an empty set of states.
+ * @param size The number of words of a state.
+ * @param options The checkpoint options.
+ * @param fingerprint The fingerprint of the automata.
+ * @return long The number of the next state to expand, or -1 if no checkpoint was restored.
+ */
+long explicit_resume(explicit_bfs *bfs, int size, const checkpoint_options *options, uint64_t fingerprint)
+{
+    checkpoint_mapping mapping;
+    if (!checkpoint_map(options, CHECKPOINT_EXPLICIT, fingerprint, &mapping))
+        return -1;
+    const int64_t *counts = (const int64_t *)mapping.data;
+    long num_keys = mapping.data_size >= 3 * sizeof(int64_t) ? counts[1] : 0;
+    size_t keys_size = (num_keys * size * sizeof(unsigned) + 7) / 8 * 8;
+    size_t expected = 3 * sizeof(int64_t) + keys_size + num_keys * (sizeof(long) + sizeof(step));
+    if (num_keys <= 0 || counts[0] != size || counts[2] < 0 || counts[2] > num_keys || mapping.data_size < expected)
+    {
+        checkpoint_unmap(&mapping);
+        return -1;
+    }
+    const unsigned *keys = (const unsigned *)(counts + 3);
+    const long *parent = (const long *)((const char *)keys + keys_size);
+    const step *discovery = (const step *)(parent + num_keys);
+    for (long index = 0; index < num_keys; index++)
+    {
+        lp_set_insert(bfs->visited, keys + index * size);
+        explicit_record(bfs, index, parent[index], discovery[index]);
+    }
+    long next_index = counts[2];
+    checkpoint_unmap(&mapping);
+    printf("Resuming from checkpoint %s (%ld states visited, %ld in the frontier).\n", options->file, num_keys, num_keys - next_index);
+    return next_index;
+}
+
+bool deadlock_explicit_search(LockAutomaton *automata, int num_automata, step **path, int *size_path, long *num_states)
+{
+    return deadlock_explicit_search_checkpointed(automata, num_automata, path, size_path, num_states, NULL);
+}
+
+bool deadlock_explicit_search_checkpointed(LockAutomaton *automata, int num_automata, step **path, int *size_path, long *num_states, const checkpoint_options *options)
+{
+    LockProduct product = lp_initialize(automata, num_automata);
+    int size = lp_state_size(product);
+    uint64_t fingerprint = options != NULL ? checkpoint_fingerprint(automata, num_automata) : 0;
+    explicit_bfs bfs;
+    bfs.visited = lp_set_create(size);
+    bfs.capacity = 1024;
+    bfs.parent = (long *)malloc(bfs.capacity * sizeof(long));
+    bfs.discovery = (step *)malloc(bfs.capacity * sizeof(step));
+    step moves[lp_max_moves(product) + 1];
+    unsigned state[size];
+
+    long first = explicit_resume(&bfs, size, options, fingerprint);
+    if (first == -1)
+    {
+        lp_initial_state(product, state);
+        lp_set_insert(bfs.visited, state);
+        explicit_record(&bfs, 0, -1, la_step_empty());
+        first = 0;
+    }
+    double last_checkpoint = checkpoint_now();
+    *path = NULL;
+    *size_path = 0;
+    bool found = false;
+    for (long index = first; index < lp_set_size(bfs.visited) && !found; index++)
+    {
+        if (index % 4096 == 0 && checkpoint_due(options, &last_checkpoint))
+            explicit_checkpoint(&bfs, size, index, options, fingerprint);
+        memcpy(state, lp_set_get(bfs.visited, index), size * sizeof(unsigned));
+        int num_moves = lp_enabled_moves(product, state, moves);
+        if (num_moves == 0)
+        {
+            *path = explicit_build_path(bfs.parent, bfs.discovery, index, size_path);
+            found = true;
+            break;
+        }
+        for (int i = 0; i < num_moves; i++)
+        {
+            lp_apply(product, state, moves[i]);
+            if (lp_set_insert(bfs.visited, state))
+                explicit_record(&bfs, lp_set_size(bfs.visited) - 1, index, moves[i]);
+            lp_undo(product, state, moves[i]);
+        }
+    }
+    if (num_states != NULL)
+        *num_states = lp_set_size(bfs.visited);
+    free(bfs.parent);
+    free(bfs.discovery);
+    lp_set_delete(bfs.visited);
+    lp_delete(product);
+    return found;
+}
+
+/**
+ * @brief An entry of the priority queue of a best-first search.
+ */
+typedef struct
+{
+    int priority; ///< The priority of the state (the smaller, the sooner it is expanded).
+    int depth;    ///< The depth at which the state was reached (ties are broken in favour of the deepest states).
+    long index;   ///< The number of the state.
+} heuristic_entry;
+
+/**
+ * @brief The best-first search of deadlock_heuristic_search.
+ */
+typedef struct
+{
+    LockProduct product;        ///< The product of the automata.
+    search_heuristic heuristic; ///< The heuristic.
+    int **to_stuck;             ///< For HEURISTIC_DISTANCE, the distance of each node of each automaton to a node where it may get stuck.
+    explicit_bfs states;        ///< The states visited, their parents and the moves discovering them.
+    int *depth;                 ///< The smallest depth at which each state was reached.
+    bool *closed;               ///< Whether each state was expanded.
+    heuristic_entry *heap;      ///< The priority queue (a binary heap).
+    long heap_size;             ///< The number of entries of the heap.
+    long heap_capacity;         ///< The capacity of the heap.
+} heuristic_search;
+
+/**
+ * @brief Tells if @p first must be expanded before @p second.
+ *
+ * @param first
+ * @param second
+ * @return true
+ * @return false
+ */
+bool heuristic_before(heuristic_entry first, heuristic_entry second)
+{
+    return first.priority < second.priority || (first.priority == second.priority && first.depth > second.depth);
+}
+
+/**
+ * @brief Adds @p entry to the heap of @p search.
+ *
+ * @param search The search.
+ * @param entry The entry.
+ */
+void heuristic_push(heuristic_search *search, heuristic_entry entry)
+{
+    if (search->heap_size == search->heap_capacity)
+    {
+        search->heap_capacity *= 2;
+        search->heap = (heuristic_entry *)realloc(search->heap, search->heap_capacity * sizeof(heuristic_entry));
+    }
+    long position = search->heap_size++;
+    while (position > 0 && heuristic_before(entry, search->heap[(position - 1) / 2]))
+    {
+        search->heap[position] = search->heap[(position - 1) / 2];
+        position = (position - 1) / 2;
+    }
+    search->heap[position] = entry;
+}
+
+/**
+ * @brief Removes and returns the first entry of the heap of @p search.
+ *
+ * @param search The search.
+ * @return heuristic_entry
+ * @pre The heap is not empty.
+ */
+heuristic_entry heuristic_pop(heuristic_search *search)
+{
+    heuristic_entry first = search->heap[0];
+    heuristic_entry last = search->heap[--search->heap_size];
+    long position = 0;
+    while (true)
+    {
+        long child = 2 * position + 1;
+        if (child >= search->heap_size)
+            break;
+        if (child + 1 < search->heap_size && heuristic_before(search->heap[child + 1], search->heap[child]))
+            child++;
+        if (!heuristic_before(search->heap[child], last))
+            break;
+        search->heap[position] = search->heap[child];
+        position = child;
+    }
+    search->heap[position] = last;
+    return first;
+}
+
+/**
+ * @brief Evaluates the heuristic of @p search on @p state.
+ *
+ * @param search The search.
+ * @param state The state.
+ * @return int The value of the heuristic, or -1 if no deadlock is reachable from @p state.
+ */
+int heuristic_evaluate(heuristic_search *search, const unsigned *state)
+{
+    LockProduct product = search->product;
+    int value = 0;
+    switch (search->heuristic)
+    {
+    case HEURISTIC_DISTANCE:
+        for (int aut = 0; aut < lp_get_num_automata(product); aut++)
+        {
+            int distance = search->to_stuck[aut][lp_get_node(product, state, aut)];
+            if (distance == -1)
+                return -1;
+            value += distance;
+        }
+        break;
+    case HEURISTIC_BLOCKED:
+    {
+        step moves[lp_max_moves(product) + 1];
+        int num_moves = lp_enabled_moves(product, state, moves);
+        for (int i = 0; i < num_moves; i++)
+            if (i == 0 || moves[i].automaton != moves[i - 1].automaton)
+                value++;
+        break;
+    }
+    case HEURISTIC_LOCKS:
+        for (int lock = 1; lock <= lp_get_max_lock(product); lock++)
+            if (!lp_is_lock_taken(product, state, lock))
+                value++;
+        break;
+    }
+    return value;
+}
+
+/**
+ * @brief Records that @p state, of number @p index, was reached at @p depth, and queues it if it may lead to a deadlock.
+ *
+ * @param search The search.
+ * @param state The state.
+ * @param index Its number.
+ * @param depth The depth at which it was reached.
+ */
+void heuristic_queue(heuristic_search *search, const unsigned *state, long index, int depth)
+{
+    if (index == search->states.capacity)
+    {
+        search->depth = (int *)realloc(search->depth, 2 * search->states.capacity * sizeof(int));
+        search->closed = (bool *)realloc(search->closed, 2 * search->states.capacity * sizeof(bool));
+    }
+    search->depth[index] = depth;
+    search->closed[index] = false;
+    int value = heuristic_evaluate(search, state);
+    if (value == -1)
+        return;
+    heuristic_entry entry = {search->heuristic == HEURISTIC_DISTANCE ? depth + value : value, depth, index};
+    heuristic_push(search, entry);
+}
+
+bool deadlock_heuristic_search(LockAutomaton *automata, int num_automata, search_heuristic heuristic, step **path, int *size_path, long *num_states)
+{
+    heuristic_search search;
+    search.product = lp_initialize(automata, num_automata);
+    search.heuristic = heuristic;
+    search.to_stuck = NULL;
+    if (heuristic == HEURISTIC_DISTANCE)
+    {
+        LockSets sets[num_automata];
+        bool releases_well_formed = true;
+        for (int aut = 0; aut < num_automata; aut++)
+        {
+            sets[aut] = la_compute_locksets(automata[aut]);
+            if (!la_releases_only_held_locks(automata[aut], sets[aut]))
+                releases_well_formed = false;
+        }
+        search.to_stuck = (int **)malloc(num_automata * sizeof(int *));
+        for (int aut = 0; aut < num_automata; aut++)
+        {
+            search.to_stuck[aut] = (int *)malloc(la_get_num_nodes(automata[aut]) * sizeof(int));
+            la_distances_to_stuck_nodes(automata[aut], sets[aut], releases_well_formed, search.to_stuck[aut]);
+            la_delete_locksets(sets[aut]);
+        }
+    }
+    int size = lp_state_size(search.product);
+    search.states.visited = lp_set_create(size);
+    search.states.capacity = 1024;
+    search.states.parent = (long *)malloc(search.states.capacity * sizeof(long));
+    search.states.discovery = (step *)malloc(search.states.capacity * sizeof(step));
+    search.depth = (int *)malloc(search.states.capacity * sizeof(int));
+    search.closed = (bool *)malloc(search.states.capacity * sizeof(bool));
+    search.heap_capacity = 1024;
+    search.heap = (heuristic_entry *)malloc(search.heap_capacity * sizeof(heuristic_entry));
+    search.heap_size = 0;
+    step moves[lp_max_moves(search.product) + 1];
+    unsigned state[size];
+
+    lp_initial_state(search.product, state);
+    lp_set_insert(search.states.visited, state);
+    heuristic_queue(&search, state, 0, 0);
+    explicit_record(&search.states, 0, -1, la_step_empty());
+    *path = NULL;
+    *size_path = 0;
+    bool found = false;
+    while (search.heap_size > 0 && !found)
+    {
+        heuristic_entry entry = heuristic_pop(&search);
+        // Entries of states reached again by a shorter path are outdated.
+        if (search.closed[entry.index] || entry.depth != search.depth[entry.index])
+            continue;
+        search.closed[entry.index] = true;
+        memcpy(state, lp_set_get(search.states.visited, entry.index), size * sizeof(unsigned));
+        int num_moves = lp_enabled_moves(search.product, state, moves);
+        if (num_moves == 0)
+        {
+            *path = explicit_build_path(search.states.parent, search.states.discovery, entry.index, size_path);
+            found = true;
+            break;
+        }
+        for (int i = 0; i < num_moves; i++)
+        {
+            lp_apply(search.product, state, moves[i]);
+            long index = lp_set_find(search.states.visited, state);
+            if (index == -1)
+            {
+                lp_set_insert(search.states.visited, state);
+                index = lp_set_size(search.states.visited) - 1;
+                heuristic_queue(&search, state, index, entry.depth + 1);
+                explicit_record(&search.states, index, entry.index, moves[i]);
+            }
+            else if (!search.closed[index] && entry.depth + 1 < search.depth[index])
+            {
+                search.states.parent[index] = entry.index;
+                search.states.discovery[index] = moves[i];
+                heuristic_queue(&search, state, index, entry.depth + 1);
+            }
+            lp_undo(search.product, state, moves[i]);
+        }
+    }
+    if (num_states != NULL)
+        *num_states = lp_set_size(search.states.visited);
+    if (search.to_stuck != NULL)
+    {
+        for (int aut = 0; aut < num_automata; aut++)
+            free(search.to_stuck[aut]);
+        free(search.to_stuck);
+    }
+    free(search.heap);
+    free(search.depth);
+    free(search.closed);
+    free(search.states.parent);
+    free(search.states.discovery);
+    lp_set_delete(search.states.visited);
+    lp_delete(search.product);
+    return found;
+}
+
+/**
+ * @brief A queue of state numbers (a growable array read from its head).
+ */
+typedef struct
+{
+    long *indices; ///< The state numbers.
+    long head;     ///< The position of the next number to read.
+    long size;     ///< The number of numbers written.
+    long capacity; ///< The capacity of indices.
+} context_queue;
+
+/**
+ * @brief Appends @p index to @p queue.
+ *
+ * @param queue
+ * @param index
+ */
+void context_push(context_queue *queue, long index)
+{
+    if (queue->size == queue->capacity)
+    {
+        queue->capacity = 2 * queue->capacity + 1024;
+        queue->indices = (long *)realloc(queue->indices, queue->capacity * sizeof(long));
+    }
+    queue->indices[queue->size++] = index;
+}
+
+Z3_lbool deadlock_context_bounded_search(LockAutomaton *automata, int num_automata, switch_bound bound, int max_switches, step **path, int *size_path, int *switches, long *num_states)
+{
+    LockProduct product = lp_initialize(automata, num_automata);
+    int size = lp_state_size(product);
+    // An extended state is a state of the product followed by the last automaton to move (num_automata at first).
+    explicit_bfs bfs;
+    bfs.visited = lp_set_create(size + 1);
+    bfs.capacity = 1024;
+    bfs.parent = (long *)malloc(bfs.capacity * sizeof(long));
+    bfs.discovery = (step *)malloc(bfs.capacity * sizeof(step));
+    int *cost = (int *)malloc(bfs.capacity * sizeof(int));
+    bool *expanded = (bool *)malloc(bfs.capacity * sizeof(bool));
+    context_queue current = {NULL, 0, 0, 0};
+    context_queue deferred = {NULL, 0, 0, 0};
+    step moves[lp_max_moves(product) + 1];
+    unsigned state[size + 1];
+
+    lp_initial_state(product, state);
+    state[size] = num_automata;
+    lp_set_insert(bfs.visited, state);
+    explicit_record(&bfs, 0, -1, la_step_empty());
+    cost[0] = 0;
+    expanded[0] = false;
+    context_push(&current, 0);
+    *path = NULL;
+    *size_path = 0;
+    *switches = 0;
+    Z3_lbool result = Z3_L_UNDEF;
+    for (int level = 0; level <= max_switches && result == Z3_L_UNDEF; level++)
+    {
+        while (current.head < current.size && result == Z3_L_UNDEF)
+        {
+            long index = current.indices[current.head++];
+            if (expanded[index] || cost[index] != level)
+                continue;
+            expanded[index] = true;
+            memcpy(state, lp_set_get(bfs.visited, index), (size + 1) * sizeof(unsigned));
+            int num_moves = lp_enabled_moves(product, state, moves);
+            if (num_moves == 0)
+            {
+                *path = explicit_build_path(bfs.parent, bfs.discovery, index, size_path);
+                *switches = level;
+                result = Z3_L_TRUE;
+                break;
+            }
+            int last = state[size];
+            bool last_enabled = false;
+            for (int i = 0; i < num_moves; i++)
+                if (moves[i].automaton == last)
+                    last_enabled = true;
+            for (int i = 0; i < num_moves; i++)
+            {
+                bool switching = last != num_automata && moves[i].automaton != last;
+                int successor_cost = level + (switching && (bound == BOUND_CONTEXT_SWITCHES || last_enabled) ? 1 : 0);
+                lp_apply(product, state, moves[i]);
+                state[size] = moves[i].automaton;
+                long successor = lp_set_find(bfs.visited, state);
+                if (successor == -1)
+                {
+                    lp_set_insert(bfs.visited, state);
+                    successor = lp_set_size(bfs.visited) - 1;
+                    if (successor == bfs.capacity)
+                    {
+                        cost = (int *)realloc(cost, 2 * bfs.capacity * sizeof(int));
+                        expanded = (bool *)realloc(expanded, 2 * bfs.capacity * sizeof(bool));
+                    }
+                    explicit_record(&bfs, successor, index, moves[i]);
+                    cost[successor] = successor_cost;
+                    expanded[successor] = false;
+                    context_push(successor_cost == level ? &current : &deferred, successor);
+                }
+                else if (!expanded[successor] && successor_cost < cost[successor])
+                {
+                    bfs.parent[successor] = index;
+                    bfs.discovery[successor] = moves[i];
+                    cost[successor] = successor_cost;
+                    context_push(&current, successor);
+                }
+                state[size] = last;
+                lp_undo(product, state, moves[i]);
+            }
+        }
+        if (result == Z3_L_UNDEF && deferred.size == 0)
+            result = Z3_L_FALSE;
+        // The states set aside need one more switch: they start the next iteration.
+        context_queue swap = current;
+        current = deferred;
+        deferred = swap;
+        deferred.head = 0;
+        deferred.size = 0;
+    }
+    if (num_states != NULL)
+        *num_states = lp_set_size(bfs.visited);
+    free(current.indices);
+    free(deferred.indices);
+    free(cost);
+    free(expanded);
+    free(bfs.parent);
+    free(bfs.discovery);
+    lp_set_delete(bfs.visited);
+    lp_delete(product);
+    return result;
+}
+
+/**
+ * @brief A bit array in which states are stored by setting some of their hash bits.
+ */
+typedef struct
+{
+    uint64_t *words;    ///< The bits.
+    uint64_t mask;      ///< The number of bits minus one (it is a power of 2).
+    int num_hashes;     ///< The number of bits set per state.
+    long bits_set;      ///< The number of bits set.
+} bitstate_array;
+
+/**
+ * @brief Stores @p state in @p array: sets its bits, obtained by double hashing.
+ *
+ * @param array The bit array.
+ * @param state The state.
+ * @param size The number of words of @p state.
+ * @return true if one of the bits of @p state was not set, i.e. if it was surely not stored yet.
+ * @return false otherwise.
+ */
+bool bitstate_insert(bitstate_array *array, const unsigned *state, int size)
+{
+    uint64_t first = lp_hash(state, size, 0);
+    uint64_t second = lp_hash(state, size, 1) | 1;
+    bool new_state = false;
+    for (int i = 0; i < array->num_hashes; i++)
+    {
+        uint64_t bit = (first + i * second) & array->mask;
+        uint64_t flag = (uint64_t)1 << (bit % 64);
+        if (!(array->words[bit / 64] & flag))
+        {
+            array->words[bit / 64] |= flag;
+            array->bits_set++;
+            new_state = true;
+        }
+    }
+    return new_state;
+}
+
+bool deadlock_bitstate_search(LockAutomaton *automata, int num_automata, int log_size, int num_hashes, step **path, int *size_path, bitstate_statistics *statistics)
+{
+    LockProduct product = lp_initialize(automata, num_automata);
+    int size = lp_state_size(product);
+    int max_moves = lp_max_moves(product);
+    bitstate_array array;
+    array.mask = ((uint64_t)1 << log_size) - 1;
+    array.words = (uint64_t *)calloc(((uint64_t)1 << log_size) / 64, sizeof(uint64_t));
+    array.num_hashes = num_hashes;
+    array.bits_set = 0;
+
+    // The stack of the search: the moves enabled at each depth, the next one to try, and the moves taken.
+    long capacity = 1024;
+    step *enabled = (step *)malloc(capacity * (max_moves + 1) * sizeof(step));
+    int *num_enabled = (int *)malloc(capacity * sizeof(int));
+    int *next = (int *)malloc(capacity * sizeof(int));
+    step *taken = (step *)malloc(capacity * sizeof(step));
+    unsigned state[size];
+
+    lp_initial_state(product, state);
+    bitstate_insert(&array, state, size);
+    long num_states = 1;
+    double expected_omissions = 0;
+    long depth = 0;
+    num_enabled[0] = lp_enabled_moves(product, state, enabled);
+    next[0] = 0;
+    bool found = num_enabled[0] == 0;
+    while (!found && depth >= 0)
+    {
+        if (next[depth] == num_enabled[depth])
+        {
+            depth--;
+            if (depth >= 0)
+                lp_undo(product, state, taken[depth]);
+            continue;
+        }
+        step move = enabled[depth * (max_moves + 1) + next[depth]++];
+        lp_apply(product, state, move);
+        double fill_ratio = (double)array.bits_set / ((double)array.mask + 1);
+        double collision = 1;
+        for (int i = 0; i < num_hashes; i++)
+            collision *= fill_ratio;
+        if (!bitstate_insert(&array, state, size))
+        {
+            lp_undo(product, state, move);
+            continue;
+        }
+        num_states++;
+        expected_omissions += collision;
+        taken[depth++] = move;
+        if (depth == capacity)
+        {
+            capacity *= 2;
+            enabled = (step *)realloc(enabled, capacity * (max_moves + 1) * sizeof(step));
+            num_enabled = (int *)realloc(num_enabled, capacity * sizeof(int));
+            next = (int *)realloc(next, capacity * sizeof(int));
+            taken = (step *)realloc(taken, capacity * sizeof(step));
+        }
+        num_enabled[depth] = lp_enabled_moves(product, state, enabled + depth * (max_moves + 1));
+        next[depth] = 0;
+        found = num_enabled[depth] == 0;
+    }
+
+    *path = NULL;
+    *size_path = 0;
+    if (found)
+    {
+        *path = (step *)malloc((depth + 1) * sizeof(step));
+        memcpy(*path, taken, depth * sizeof(step));
+        *size_path = depth;
+    }
+    if (statistics != NULL)
+    {
+        statistics->num_states = num_states;
+        statistics->fill_ratio = (double)array.bits_set / ((double)array.mask + 1);
+        statistics->expected_omissions = expected_omissions;
+        statistics->coverage = num_states / (num_states + expected_omissions);
+    }
+    free(enabled);
+    free(num_enabled);
+    free(next);
+    free(taken);
+    free(array.words);
+    lp_delete(product);
+    return found;
+}
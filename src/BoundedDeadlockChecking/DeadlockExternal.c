@@ -0,0 +1,523 @@
+#include "DeadlockExternal.h"
+#include "LockProduct.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief The maximal number of files merged at once (runs are merged in several passes if there are more).
+ */
+#define EXTERNAL_FAN_IN 16
+
+/**
+ * @brief The size of the stdio buffer of every file of the search.
+ */
+#define EXTERNAL_IO_BUFFER (1 << 20)
+
+/**
+ * @brief The data of an external-memory search.
+ */
+typedef struct
+{
+    LockProduct product; ///< The product of the automata.
+    int size;            ///< The number of words of a state.
+    char *directory;     ///< The directory of the files of the search.
+    long buffer_states;  ///< The number of states of the buffer.
+    unsigned *buffer;    ///< The successors waiting to be sorted and written as a run.
+    unsigned *temp;      ///< Room for sorting the buffer.
+    long buffered;       ///< The number of states in the buffer.
+    int num_runs;        ///< The number of runs written since the last merge.
+    int next_file;       ///< The number of the next temporary file.
+    bool failed;         ///< Whether an input/output error happened.
+} external_search;
+
+/**
+ * @brief Writes in @p name the path of the file called @p kind followed by @p number in the directory of @p search.
+ *
+ * @param search The search data.
+ * @param kind The kind of file ("layer", "run"...).
+ * @param number Its number.
+ * @param name Receives the path.
+ * @param length The size of @p name.
+ */
+void external_file_name(external_search *search, const char *kind, int number, char *name, int length)
+{
+    snprintf(name, length, "%s/%s%d", search->directory, kind, number);
+}
+
+/**
+ * @brief Opens @p name with a big buffer, and records the failure in @p search if it cannot be opened.
+ *
+ * @param search The search data.
+ * @param name The path of the file.
+ * @param mode The mode, as for fopen.
+ * @return FILE* The file, or NULL.
+ */
+FILE *external_open(external_search *search, const char *name, const char *mode)
+{
+    FILE *file = fopen(name, mode);
+    if (file == NULL)
+    {
+        search->failed = true;
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, EXTERNAL_IO_BUFFER);
+    return file;
+}
+
+/**
+ * @brief Closes @p file, and records in @p search the errors that happened on it.
+ *
+ * @param search The search data.
+ * @param file The file (possibly NULL).
+ */
+void external_close(external_search *search, FILE *file)
+{
+    if (file == NULL)
+        return;
+    if (ferror(file))
+        search->failed = true;
+    if (fclose(file) != 0)
+        search->failed = true;
+}
+
+/**
+ * @brief Reads the next state of @p file in @p state.
+ *
+ * @param search The search data.
+ * @param file The file (possibly NULL, considered empty).
+ * @param state Receives the state.
+ * @return true if a state was read.
+ * @return false at the end of the file.
+ */
+bool external_read(external_search *search, FILE *file, unsigned *state)
+{
+    return file != NULL && fread(state, sizeof(unsigned), search->size, file) == (size_t)search->size;
+}
+
+/**
+ * @brief Writes @p state at the end of @p file.
+ *
+ * @param search The search data.
+ * @param file The file (possibly NULL, the state is then dropped).
+ * @param state The state.
+ */
+void external_write(external_search *search, FILE *file, const unsigned *state)
+{
+    if (file != NULL && fwrite(state, sizeof(unsigned), search->size, file) != (size_t)search->size)
+        search->failed = true;
+}
+
+/**
+ * @brief Sorts the @p count states of @p states (bottom-up merge sort, by the order of memcmp).
+ *
+ * @param search The search data.
+ * @param states The states.
+ * @param count Their number.
+ * @param temp Room for @p count states.
+ */
+void external_sort(external_search *search, unsigned *states, long count, unsigned *temp)
+{
+    int size = search->size;
+    unsigned *from = states;
+    unsigned *to = temp;
+    for (long width = 1; width < count; width *= 2)
+    {
+        for (long low = 0; low < count; low += 2 * width)
+        {
+            long middle = low + width < count ? low + width : count;
+            long high = low + 2 * width < count ? low + 2 * width : count;
+            long left = low, right = middle, position = low;
+            while (left < middle || right < high)
+            {
+                bool take_left = right >= high || (left < middle && memcmp(from + left * size, from + right * size, size * sizeof(unsigned)) <= 0);
+                long taken = take_left ? left++ : right++;
+                memcpy(to + position++ * size, from + taken * size, size * sizeof(unsigned));
+            }
+        }
+        unsigned *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != states)
+        memcpy(states, from, count * size * sizeof(unsigned));
+}
+
+/**
+ * @brief Sorts the buffer of @p search and writes it without duplicates as a new run.
+ *
+ * @param search The search data.
+ */
+void external_flush_run(external_search *search)
+{
+    if (search->buffered == 0)
+        return;
+    int size = search->size;
+    external_sort(search, search->buffer, search->buffered, search->temp);
+    int length = strlen(search->directory) + 32;
+    char name[length];
+    external_file_name(search, "run", search->num_runs++, name, length);
+    FILE *file = external_open(search, name, "wb");
+    for (long i = 0; i < search->buffered; i++)
+        if (i == 0 || memcmp(search->buffer + (i - 1) * size, search->buffer + i * size, size * sizeof(unsigned)) != 0)
+            external_write(search, file, search->buffer + i * size);
+    external_close(search, file);
+    search->buffered = 0;
+}
+
+/**
+ * @brief Adds @p state to the successors of the current layer.
+ *
+ * @param search The search data.
+ * @param state The state.
+ */
+void external_add(external_search *search, const unsigned *state)
+{
+    memcpy(search->buffer + search->buffered * search->size, state, search->size * sizeof(unsigned));
+    if (++search->buffered == search->buffer_states)
+        external_flush_run(search);
+}
+
+/**
+ * @brief Merges the sorted files @p inputs into the sorted file @p output, without duplicates, and removes the inputs.
+ *
+ * @param search The search data.
+ * @param inputs The paths of the files merged.
+ * @param num_inputs Their number (at most EXTERNAL_FAN_IN).
+ * @param output The path of the result.
+ */
+void external_merge(external_search *search, char **inputs, int num_inputs, const char *output)
+{
+    int size = search->size;
+    FILE *files[num_inputs];
+    unsigned heads[num_inputs][size];
+    bool present[num_inputs];
+    for (int i = 0; i < num_inputs; i++)
+    {
+        files[i] = external_open(search, inputs[i], "rb");
+        present[i] = external_read(search, files[i], heads[i]);
+    }
+    FILE *file = external_open(search, output, "wb");
+    unsigned last[size];
+    bool written = false;
+    while (true)
+    {
+        int smallest = -1;
+        for (int i = 0; i < num_inputs; i++)
+            if (present[i] && (smallest == -1 || memcmp(heads[i], heads[smallest], size * sizeof(unsigned)) < 0))
+                smallest = i;
+        if (smallest == -1)
+            break;
+        if (!written || memcmp(last, heads[smallest], size * sizeof(unsigned)) != 0)
+        {
+            external_write(search, file, heads[smallest]);
+            memcpy(last, heads[smallest], size * sizeof(unsigned));
+            written = true;
+        }
+        present[smallest] = external_read(search, files[smallest], heads[smallest]);
+    }
+    external_close(search, file);
+    for (int i = 0; i < num_inputs; i++)
+    {
+        external_close(search, files[i]);
+        unlink(inputs[i]);
+    }
+}
+
+/**
+ * @brief Merges the runs written since the last call into the sorted file @p output, in passes of at most EXTERNAL_FAN_IN files.
+ * After an input/output error, the runs and intermediate merges are removed and @p output is not written.
+ *
+ * @param search The search data.
+ * @param output The path of the result.
+ */
+void external_merge_runs(external_search *search, const char *output)
+{
+    external_flush_run(search);
+    int length = strlen(search->directory) + 32;
+    int num_files = search->num_runs;
+    char *files[num_files + 1];
+    for (int i = 0; i < num_files; i++)
+    {
+        files[i] = (char *)malloc(length);
+        external_file_name(search, "run", i, files[i], length);
+    }
+    while (num_files > EXTERNAL_FAN_IN && !search->failed)
+    {
+        int num_merged = 0;
+        for (int first = 0; first < num_files; first += EXTERNAL_FAN_IN)
+        {
+            int count = num_files - first < EXTERNAL_FAN_IN ? num_files - first : EXTERNAL_FAN_IN;
+            char *merged = (char *)malloc(length);
+            external_file_name(search, "merge", search->next_file++, merged, length);
+            external_merge(search, files + first, count, merged);
+            for (int i = first; i < first + count; i++)
+                free(files[i]);
+            files[num_merged++] = merged;
+        }
+        num_files = num_merged;
+    }
+    // After an input/output error the result is dropped: the files left are only removed.
+    if (search->failed)
+        for (int i = 0; i < num_files; i++)
+            unlink(files[i]);
+    else
+        external_merge(search, files, num_files, output);
+    for (int i = 0; i < num_files; i++)
+        free(files[i]);
+    search->num_runs = 0;
+}
+
+/**
+ * @brief Delayed duplicate detection: writes in @p layer the states of @p candidates which are not in @p visited, and in @p union_file the union of both files (all of them being sorted). Removes @p candidates.
+ *
+ * @param search The search data.
+ * @param candidates The path of the successors of the last layer.
+ * @param visited The path of the states visited so far.
+ * @param layer The path of the new layer.
+ * @param union_file The path of the new set of visited states.
+ * @return long The number of states of the new layer.
+ */
+long external_subtract(external_search *search, const char *candidates, const char *visited, const char *layer, const char *union_file)
+{
+    int size = search->size;
+    FILE *new_file = external_open(search, candidates, "rb");
+    FILE *old_file = external_open(search, visited, "rb");
+    FILE *layer_file = external_open(search, layer, "wb");
+    FILE *union_output = external_open(search, union_file, "wb");
+    unsigned new_state[size], old_state[size];
+    bool new_present = external_read(search, new_file, new_state);
+    bool old_present = external_read(search, old_file, old_state);
+    long count = 0;
+    while (new_present || old_present)
+    {
+        int comparison = !new_present ? 1 : !old_present ? -1 : memcmp(new_state, old_state, size * sizeof(unsigned));
+        if (comparison < 0)
+        {
+            external_write(search, layer_file, new_state);
+            external_write(search, union_output, new_state);
+            count++;
+            new_present = external_read(search, new_file, new_state);
+        }
+        else
+        {
+            external_write(search, union_output, old_state);
+            if (comparison == 0)
+                new_present = external_read(search, new_file, new_state);
+            old_present = external_read(search, old_file, old_state);
+        }
+    }
+    external_close(search, new_file);
+    external_close(search, old_file);
+    external_close(search, layer_file);
+    external_close(search, union_output);
+    unlink(candidates);
+    return count;
+}
+
+/**
+ * @brief Rebuilds the path leading to @p target, a state of layer @p depth, by scanning the previous layers for a predecessor of each state of the path.
+ *
+ * @param search The search data.
+ * @param target The last state of the path (modified).
+ * @param depth Its layer.
+ * @return step* The path, newly allocated, of size @p depth.
+ */
+step *external_build_path(external_search *search, unsigned *target, int depth)
+{
+    int size = search->size;
+    step *path = (step *)malloc((depth + 1) * sizeof(step));
+    step moves[lp_max_moves(search->product) + 1];
+    unsigned state[size];
+    int length = strlen(search->directory) + 32;
+    char name[length];
+    for (int layer = depth - 1; layer >= 0 && !search->failed; layer--)
+    {
+        external_file_name(search, "layer", layer, name, length);
+        FILE *file = external_open(search, name, "rb");
+        bool found = false;
+        while (!found && external_read(search, file, state))
+        {
+            int num_moves = lp_enabled_moves(search->product, state, moves);
+            for (int i = 0; i < num_moves && !found; i++)
+            {
+                lp_apply(search->product, state, moves[i]);
+                if (memcmp(state, target, size * sizeof(unsigned)) == 0)
+                {
+                    path[layer] = moves[i];
+                    found = true;
+                }
+                lp_undo(search->product, state, moves[i]);
+            }
+        }
+        external_close(search, file);
+        if (!found)
+            search->failed = true;
+        memcpy(target, state, size * sizeof(unsigned));
+    }
+    return path;
+}
+
+/**
+ * @brief Runs the search in the directory of @p search (see deadlock_external_search).
+ *
+ * @param search The search data.
+ * @param bound The bound (negative for none).
+ * @param path Receives the path found, or NULL.
+ * @param size_path Receives its size.
+ * @param num_states Receives the number of states visited.
+ * @param num_layers Receives the number of layer files written.
+ * @return true if a deadlock was found.
+ * @return false otherwise.
+ */
+bool external_explore(external_search *search, int bound, step **path, int *size_path, long *num_states, int *num_layers)
+{
+    int size = search->size;
+    int length = strlen(search->directory) + 32;
+    char layer_name[length], candidates[length], visited[length], union_file[length];
+    snprintf(candidates, length, "%s/candidates", search->directory);
+    snprintf(visited, length, "%s/visited", search->directory);
+    snprintf(union_file, length, "%s/union", search->directory);
+    unsigned state[size];
+    step moves[lp_max_moves(search->product) + 1];
+
+    lp_initial_state(search->product, state);
+    external_file_name(search, "layer", 0, layer_name, length);
+    FILE *file = external_open(search, layer_name, "wb");
+    external_write(search, file, state);
+    external_close(search, file);
+    if (bound < 0)
+    {
+        file = external_open(search, visited, "wb");
+        external_write(search, file, state);
+        external_close(search, file);
+    }
+    *num_states = 1;
+    *num_layers = 1;
+
+    for (int depth = 0; !search->failed; depth++)
+    {
+        bool check = bound < 0 || depth == bound;
+        external_file_name(search, "layer", depth, layer_name, length);
+        file = external_open(search, layer_name, "rb");
+        while (external_read(search, file, state))
+        {
+            int num_moves = lp_enabled_moves(search->product, state, moves);
+            if (check && num_moves == 0)
+            {
+                external_close(search, file);
+                *path = external_build_path(search, state, depth);
+                *size_path = depth;
+                return true;
+            }
+            if (depth == bound)
+                continue;
+            for (int i = 0; i < num_moves; i++)
+            {
+                lp_apply(search->product, state, moves[i]);
+                external_add(search, state);
+                lp_undo(search->product, state, moves[i]);
+            }
+        }
+        external_close(search, file);
+        if (depth == bound)
+            return false;
+
+        external_file_name(search, "layer", depth + 1, layer_name, length);
+        long count;
+        if (bound < 0)
+        {
+            external_merge_runs(search, candidates);
+            count = external_subtract(search, candidates, visited, layer_name, union_file);
+            rename(union_file, visited);
+        }
+        else
+        {
+            external_merge_runs(search, layer_name);
+            file = external_open(search, layer_name, "rb");
+            if (file != NULL)
+            {
+                fseek(file, 0, SEEK_END);
+                count = ftell(file) / (size * sizeof(unsigned));
+            }
+            else
+                count = 0;
+            external_close(search, file);
+        }
+        (*num_layers)++;
+        *num_states += count;
+        if (count == 0)
+            return false;
+    }
+    return false;
+}
+
+Z3_lbool deadlock_external_search(LockAutomaton *automata, int num_automata, int bound, const char *directory, long buffer_states, step **path, int *size_path, long *num_states)
+{
+    *path = NULL;
+    *size_path = 0;
+    if (num_states != NULL)
+        *num_states = 0;
+
+    int length = strlen(directory) + 32;
+    char temporary[length];
+    snprintf(temporary, length, "%s/cocaXXXXXX", directory);
+    if (mkdtemp(temporary) == NULL)
+        return Z3_L_UNDEF;
+
+    external_search search;
+    search.product = lp_initialize(automata, num_automata);
+    search.size = lp_state_size(search.product);
+    search.directory = temporary;
+    search.buffer_states = buffer_states > 0 ? buffer_states : 1;
+    search.buffer = (unsigned *)malloc(search.buffer_states * search.size * sizeof(unsigned));
+    search.temp = (unsigned *)malloc(search.buffer_states * search.size * sizeof(unsigned));
+    search.buffered = 0;
+    search.num_runs = 0;
+    search.next_file = 0;
+    search.failed = false;
+
+    long states;
+    int num_layers;
+    bool found = external_explore(&search, bound, path, size_path, &states, &num_layers);
+    if (num_states != NULL)
+        *num_states = states;
+
+    char name[length + 32];
+    for (int layer = 0; layer <= num_layers; layer++)
+    {
+        external_file_name(&search, "layer", layer, name, length + 32);
+        unlink(name);
+    }
+    for (int run = 0; run < search.num_runs; run++)
+    {
+        external_file_name(&search, "run", run, name, length + 32);
+        unlink(name);
+    }
+    // The merges are removed as they are consumed, this catches those left by an error.
+    for (int merge = 0; merge < search.next_file; merge++)
+    {
+        external_file_name(&search, "merge", merge, name, length + 32);
+        unlink(name);
+    }
+    const char *others[] = {"visited", "candidates", "union"};
+    for (int i = 0; i < 3; i++)
+    {
+        snprintf(name, length + 32, "%s/%s", temporary, others[i]);
+        unlink(name);
+    }
+    rmdir(temporary);
+
+    free(search.buffer);
+    free(search.temp);
+    lp_delete(search.product);
+    if (search.failed)
+    {
+        free(*path);
+        *path = NULL;
+        *size_path = 0;
+        return Z3_L_UNDEF;
+    }
+    return found ? Z3_L_TRUE : Z3_L_FALSE;
+}
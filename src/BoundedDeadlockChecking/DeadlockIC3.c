@@ -0,0 +1,1044 @@
+#include "DeadlockIC3.h"
+#include "Z3Tools.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief A conjunction of literals over the state variables of the engine. A literal is the index of a variable plus one, negated if the variable must be false.
+ */
+typedef struct
+{
+    int *lits; ///< The literals of the cube.
+    int size;  ///< The number of literals of the cube.
+} ic3_cube;
+
+/**
+ * @brief A lemma (the clause negating @p cube) and the highest frame it belongs to.
+ */
+typedef struct
+{
+    ic3_cube cube; ///< The cube blocked by the lemma.
+    int level;     ///< The lemma belongs to frames 1 to level.
+} ic3_lemma;
+
+/**
+ * @brief A proof obligation: a state that must be shown unreachable in @p level steps, or extended into a counterexample.
+ */
+typedef struct
+{
+    ic3_cube cube;   ///< A full state (one node per automaton and the value of every lock).
+    int level;       ///< The frame at which the state must be blocked.
+    int parent;      ///< The index of the obligation reached from this state in one step (-1 for a deadlock state).
+    step to_parent;  ///< The step leading from this state to the state of parent.
+    bool pending;    ///< False once the obligation is discharged.
+} ic3_obligation;
+
+/**
+ * @brief The state of an IC3 run: the encoding of the product, the frames (one incremental solver each), the lemmas and the proof obligations.
+ */
+typedef struct
+{
+    Z3_context ctx;          ///< The solver context.
+    LockAutomaton *automata; ///< The automata considered.
+    int num_automata;        ///< The number of automata.
+    int max_lock;            ///< The biggest lock used by some automaton.
+    int num_vars;            ///< The number of state variables.
+    int *node_offset;        ///< Index of the variable of node 0 of each automaton (the locks start at node_offset[num_automata]).
+    Z3_ast *cur;             ///< The state variables.
+    Z3_ast *next;            ///< The primed copies of the state variables.
+    int *init_values;        ///< The truth value of each state variable in the initial state.
+    int num_moves;           ///< The number of edges of all automata.
+    step *moves;             ///< The edges of all automata, as steps.
+    Z3_ast *move_vars;       ///< The variable telling which edge is taken by the transition.
+    Z3_ast states;           ///< The constraint stating that the current state has exactly one node per automaton.
+    Z3_ast transition;       ///< The one-step transition relation.
+    Z3_ast use_transition;   ///< The activation literal of the transition relation in the frames (deadlock states have no successor).
+    Z3_ast deadlock;         ///< The deadlock predicate over the current state.
+    Z3_solver *frames;       ///< One solver per frame (frame 0 is the initial state).
+    int num_frames;          ///< The number of frames.
+    ic3_lemma *lemmas;       ///< All the lemmas learnt.
+    int num_lemmas;          ///< The number of lemmas.
+    int cap_lemmas;          ///< The capacity of lemmas.
+    ic3_obligation *obligations; ///< All the proof obligations created.
+    int num_obligations;     ///< The number of obligations.
+    int cap_obligations;     ///< The capacity of obligations.
+} ic3_engine;
+
+/**
+ * @brief Creates the variable telling that automaton @p automaton is in node @p node (in the next state if @p primed).
+ *
+ * @param ctx The solver context.
+ * @param automaton An automaton number.
+ * @param node A node number.
+ * @param primed Whether the variable is the primed copy.
+ * @return Z3_ast
+ */
+Z3_ast ic3_variable_node(Z3_context ctx, int automaton, int node, bool primed)
+{
+    char name[60];
+    snprintf(name, 60, "ic3%s (aut: %d, node: %d)", primed ? "'" : "", automaton, node);
+    return keep_formula(ctx, mk_bool_var(ctx, name));
+}
+
+/**
+ * @brief Creates the variable telling that lock @p lock is taken (in the next state if @p primed).
+ *
+ * @param ctx The solver context.
+ * @param lock A lock number.
+ * @param primed Whether the variable is the primed copy.
+ * @return Z3_ast
+ */
+Z3_ast ic3_variable_lock(Z3_context ctx, int lock, bool primed)
+{
+    char name[40];
+    snprintf(name, 40, "ic3%s lock %d", primed ? "'" : "", lock);
+    return keep_formula(ctx, mk_bool_var(ctx, name));
+}
+
+/**
+ * @brief Creates the variable telling that the transition takes move number @p move.
+ *
+ * @param ctx The solver context.
+ * @param move A move number.
+ * @return Z3_ast
+ */
+Z3_ast ic3_variable_move(Z3_context ctx, int move)
+{
+    char name[40];
+    snprintf(name, 40, "ic3 move %d", move);
+    return keep_formula(ctx, mk_bool_var(ctx, name));
+}
+
+/**
+ * @brief Z3_mk_and accepting an empty array (returns true). The formulae are released, and the conjunction is kept.
+ *
+ * @param ctx The solver context.
+ * @param size The number of formulae.
+ * @param formulae The formulae (kept).
+ * @return Z3_ast
+ */
+Z3_ast ic3_mk_and(Z3_context ctx, int size, Z3_ast *formulae)
+{
+    Z3_ast conjunction = keep_formula(ctx, size == 0 ? Z3_mk_true(ctx) : Z3_mk_and(ctx, size, formulae));
+    release_formulae(ctx, formulae, size);
+    return conjunction;
+}
+
+/**
+ * @brief Z3_mk_or accepting an empty array (returns false). The formulae are released, and the disjunction is kept.
+ *
+ * @param ctx The solver context.
+ * @param size The number of formulae.
+ * @param formulae The formulae (kept).
+ * @return Z3_ast
+ */
+Z3_ast ic3_mk_or(Z3_context ctx, int size, Z3_ast *formulae)
+{
+    Z3_ast disjunction = keep_formula(ctx, size == 0 ? Z3_mk_false(ctx) : Z3_mk_or(ctx, size, formulae));
+    release_formulae(ctx, formulae, size);
+    return disjunction;
+}
+
+/**
+ * @brief Returns the formula of literal @p lit, over the primed variables if @p primed. The formula is kept.
+ *
+ * @param engine The engine.
+ * @param lit A literal.
+ * @param primed Whether to use the primed variables.
+ * @return Z3_ast
+ */
+Z3_ast ic3_literal(ic3_engine *engine, int lit, bool primed)
+{
+    Z3_ast *vars = primed ? engine->next : engine->cur;
+    if (lit > 0)
+        return keep_formula(engine->ctx, vars[lit - 1]);
+    return keep_formula(engine->ctx, Z3_mk_not(engine->ctx, vars[-lit - 1]));
+}
+
+/**
+ * @brief Returns the index of the state variable of lock @p lock.
+ *
+ * @param engine The engine.
+ * @param lock A lock (between 1 and max_lock).
+ * @return int
+ */
+int ic3_lock_index(ic3_engine *engine, int lock)
+{
+    return engine->node_offset[engine->num_automata] + lock - 1;
+}
+
+/**
+ * @brief Creates the formula stating that move @p move is taken: its source is the current node, its target the next one, and its action is possible and performed. The formula is kept.
+ *
+ * @param engine The engine.
+ * @param move A move number.
+ * @return Z3_ast
+ */
+Z3_ast ic3_move_formula(ic3_engine *engine, int move)
+{
+    Z3_context ctx = engine->ctx;
+    step m = engine->moves[move];
+    Z3_ast effect[4];
+    int size = 0;
+    effect[size++] = ic3_literal(engine, engine->node_offset[m.automaton] + m.source + 1, false);
+    effect[size++] = ic3_literal(engine, engine->node_offset[m.automaton] + m.target + 1, true);
+    if (m.action != 0)
+    {
+        int held = ic3_lock_index(engine, abs(m.action)) + 1;
+        effect[size++] = ic3_literal(engine, m.action > 0 ? -held : held, false);
+        effect[size++] = ic3_literal(engine, m.action > 0 ? held : -held, true);
+    }
+    Z3_ast effects = ic3_mk_and(ctx, size, effect);
+    Z3_ast formula = keep_formula(ctx, Z3_mk_implies(ctx, engine->move_vars[move], effects));
+    release_formula(ctx, effects);
+    return formula;
+}
+
+/**
+ * @brief Creates the formula stating that automaton @p aut moves if and only if one of its moves is taken, and that it stays in its node otherwise. The formula is kept.
+ *
+ * @param engine The engine.
+ * @param aut An automaton number.
+ * @param moving The variable telling that @p aut moves.
+ * @return Z3_ast
+ */
+Z3_ast ic3_automaton_frame_formula(ic3_engine *engine, int aut, Z3_ast moving)
+{
+    Z3_context ctx = engine->ctx;
+    int num_nodes = la_get_num_nodes(engine->automata[aut]);
+    Z3_ast own_moves[engine->num_moves + 1];
+    int num_own = 0;
+    for (int move = 0; move < engine->num_moves; move++)
+        if (engine->moves[move].automaton == aut)
+            own_moves[num_own++] = keep_formula(ctx, engine->move_vars[move]);
+    Z3_ast stays[num_nodes];
+    for (int node = 0; node < num_nodes; node++)
+        stays[node] = keep_formula(ctx, Z3_mk_eq(ctx, engine->cur[engine->node_offset[aut] + node], engine->next[engine->node_offset[aut] + node]));
+    Z3_ast some_move = ic3_mk_or(ctx, num_own, own_moves);
+    Z3_ast stay = ic3_mk_and(ctx, num_nodes, stays);
+    Z3_ast parts[2];
+    parts[0] = keep_formula(ctx, Z3_mk_eq(ctx, moving, some_move));
+    parts[1] = keep_formula(ctx, Z3_mk_or(ctx, 2, (Z3_ast[]){moving, stay}));
+    release_formula(ctx, some_move);
+    release_formula(ctx, stay);
+    return ic3_mk_and(ctx, 2, parts);
+}
+
+/**
+ * @brief Creates the formula stating that lock @p lock keeps its value unless a move acting on it is taken. The formula is kept.
+ *
+ * @param engine The engine.
+ * @param lock A lock (between 1 and max_lock).
+ * @return Z3_ast
+ */
+Z3_ast ic3_lock_frame_formula(ic3_engine *engine, int lock)
+{
+    Z3_context ctx = engine->ctx;
+    Z3_ast reasons[engine->num_moves + 1];
+    int size = 0;
+    int index = ic3_lock_index(engine, lock);
+    reasons[size++] = keep_formula(ctx, Z3_mk_eq(ctx, engine->cur[index], engine->next[index]));
+    for (int move = 0; move < engine->num_moves; move++)
+        if (abs(engine->moves[move].action) == lock)
+            reasons[size++] = keep_formula(ctx, engine->move_vars[move]);
+    return ic3_mk_or(ctx, size, reasons);
+}
+
+/**
+ * @brief Creates the one-step transition relation of the product: exactly one automaton takes one of its edges whose action is possible, every other automaton and lock is unchanged.
+ * The next state is also constrained to have exactly one node per automaton. The formula is kept.
+ *
+ * @param engine The engine.
+ * @return Z3_ast
+ */
+Z3_ast ic3_transition_formula(ic3_engine *engine)
+{
+    Z3_context ctx = engine->ctx;
+    int num_automata = engine->num_automata;
+    int size = 0;
+    Z3_ast parts[2 * num_automata + engine->num_moves + engine->max_lock + 1];
+    Z3_ast moving[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(engine->automata[aut]);
+        char name[40];
+        snprintf(name, 40, "ic3 moving %d", aut);
+        moving[aut] = keep_formula(ctx, mk_bool_var(ctx, name));
+        parts[size++] = keep_formula(ctx, uniqueFormula(ctx, engine->next + engine->node_offset[aut], num_nodes));
+        parts[size++] = ic3_automaton_frame_formula(engine, aut, moving[aut]);
+    }
+    parts[size++] = keep_formula(ctx, uniqueFormula(ctx, moving, num_automata));
+    release_formulae(ctx, moving, num_automata);
+    for (int move = 0; move < engine->num_moves; move++)
+        parts[size++] = ic3_move_formula(engine, move);
+    for (int lock = 1; lock <= engine->max_lock; lock++)
+        parts[size++] = ic3_lock_frame_formula(engine, lock);
+    return ic3_mk_and(ctx, size, parts);
+}
+
+/**
+ * @brief Creates the formula stating that the current state is a deadlock: every edge leaving the current node of every automaton is blocked. The formula is kept.
+ *
+ * @param engine The engine.
+ * @return Z3_ast
+ */
+Z3_ast ic3_deadlock_formula(ic3_engine *engine)
+{
+    Z3_context ctx = engine->ctx;
+    Z3_ast blocked[engine->num_moves + 1];
+    for (int move = 0; move < engine->num_moves; move++)
+    {
+        step m = engine->moves[move];
+        int at_source = engine->node_offset[m.automaton] + m.source + 1;
+        if (m.action == 0)
+        {
+            blocked[move] = ic3_literal(engine, -at_source, false);
+            continue;
+        }
+        int held = ic3_lock_index(engine, abs(m.action)) + 1;
+        Z3_ast impossible = ic3_literal(engine, m.action > 0 ? held : -held, false);
+        blocked[move] = keep_formula(ctx, Z3_mk_implies(ctx, engine->cur[at_source - 1], impossible));
+        release_formula(ctx, impossible);
+    }
+    return ic3_mk_and(ctx, engine->num_moves, blocked);
+}
+
+/**
+ * @brief Creates the formula of the initial state (every automaton in its initial node, every lock free). The formula is kept.
+ *
+ * @param engine The engine.
+ * @return Z3_ast
+ */
+Z3_ast ic3_initial_formula(ic3_engine *engine)
+{
+    Z3_ast lits[engine->num_vars];
+    for (int var = 0; var < engine->num_vars; var++)
+        lits[var] = ic3_literal(engine, engine->init_values[var] ? var + 1 : -(var + 1), false);
+    return ic3_mk_and(engine->ctx, engine->num_vars, lits);
+}
+
+/**
+ * @brief Fills the variables, moves and formulae of @p engine. The variables and formulae are kept until ic3_engine_delete, so that the engine also works in contexts with reference counting (see make_context_rc).
+ *
+ * @param engine The engine.
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ */
+void ic3_engine_init(ic3_engine *engine, Z3_context ctx, LockAutomaton *automata, int num_automata)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->ctx = ctx;
+    engine->automata = automata;
+    engine->num_automata = num_automata;
+    engine->node_offset = (int *)malloc((num_automata + 1) * sizeof(int));
+    int num_vars = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        engine->node_offset[aut] = num_vars;
+        num_vars += la_get_num_nodes(automata[aut]);
+        engine->num_moves += la_get_num_edges(automata[aut]);
+        if (engine->max_lock < la_get_max_lock(automata[aut]))
+            engine->max_lock = la_get_max_lock(automata[aut]);
+    }
+    engine->node_offset[num_automata] = num_vars;
+    num_vars += engine->max_lock;
+    engine->num_vars = num_vars;
+
+    engine->cur = (Z3_ast *)malloc(num_vars * sizeof(Z3_ast));
+    engine->next = (Z3_ast *)malloc(num_vars * sizeof(Z3_ast));
+    engine->init_values = (int *)calloc(num_vars, sizeof(int));
+    for (int aut = 0; aut < num_automata; aut++)
+        for (int node = 0; node < la_get_num_nodes(automata[aut]); node++)
+        {
+            engine->cur[engine->node_offset[aut] + node] = ic3_variable_node(ctx, aut, node, false);
+            engine->next[engine->node_offset[aut] + node] = ic3_variable_node(ctx, aut, node, true);
+            engine->init_values[engine->node_offset[aut] + node] = la_is_initial(automata[aut], node);
+        }
+    for (int lock = 1; lock <= engine->max_lock; lock++)
+    {
+        engine->cur[ic3_lock_index(engine, lock)] = ic3_variable_lock(ctx, lock, false);
+        engine->next[ic3_lock_index(engine, lock)] = ic3_variable_lock(ctx, lock, true);
+    }
+
+    engine->moves = (step *)malloc((engine->num_moves + 1) * sizeof(step));
+    engine->move_vars = (Z3_ast *)malloc((engine->num_moves + 1) * sizeof(Z3_ast));
+    int move = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        for (int source = 0; source < num_nodes; source++)
+            for (int target = 0; target < num_nodes; target++)
+            {
+                if (!la_is_edge(automata[aut], source, target))
+                    continue;
+                engine->moves[move] = la_step_create(aut, source, target, la_get_edge_action(automata[aut], source, target));
+                engine->move_vars[move] = ic3_variable_move(ctx, move);
+                move++;
+            }
+    }
+    Z3_ast one_node[num_automata + 1];
+    for (int aut = 0; aut < num_automata; aut++)
+        one_node[aut] = keep_formula(ctx, uniqueFormula(ctx, engine->cur + engine->node_offset[aut], la_get_num_nodes(automata[aut])));
+    engine->states = ic3_mk_and(ctx, num_automata, one_node);
+    engine->transition = ic3_transition_formula(engine);
+    engine->use_transition = keep_formula(ctx, mk_bool_var(ctx, "ic3 transition"));
+    engine->deadlock = ic3_deadlock_formula(engine);
+}
+
+/**
+ * @brief Appends a new frame to @p engine. Frame 0 contains the initial state, the other ones the lemmas proved inductive so far.
+ * The transition relation is only active under the assumption use_transition, so that deadlock states can be found in frames.
+ *
+ * @param engine The engine.
+ */
+void ic3_add_frame(ic3_engine *engine)
+{
+    Z3_context ctx = engine->ctx;
+    int level = engine->num_frames;
+    engine->frames = (Z3_solver *)realloc(engine->frames, (level + 1) * sizeof(Z3_solver));
+    Z3_solver solver = Z3_mk_simple_solver(ctx);
+    Z3_solver_inc_ref(ctx, solver);
+    Z3_solver_assert(ctx, solver, engine->states);
+    Z3_ast guarded = keep_formula(ctx, Z3_mk_implies(ctx, engine->use_transition, engine->transition));
+    Z3_solver_assert(ctx, solver, guarded);
+    release_formula(ctx, guarded);
+    if (level == 0)
+    {
+        Z3_ast initial = ic3_initial_formula(engine);
+        Z3_solver_assert(ctx, solver, initial);
+        release_formula(ctx, initial);
+    }
+    engine->frames[level] = solver;
+    engine->num_frames++;
+}
+
+/**
+ * @brief Returns the clause negating @p cube (over the current variables). The clause is kept.
+ *
+ * @param engine The engine.
+ * @param cube A cube.
+ * @return Z3_ast
+ */
+Z3_ast ic3_clause(ic3_engine *engine, ic3_cube cube)
+{
+    Z3_ast lits[cube.size + 1];
+    for (int i = 0; i < cube.size; i++)
+        lits[i] = ic3_literal(engine, -cube.lits[i], false);
+    return ic3_mk_or(engine->ctx, cube.size, lits);
+}
+
+/**
+ * @brief Creates a cube from an array of literals (the array is copied).
+ *
+ * @param lits The literals.
+ * @param size The number of literals.
+ * @return ic3_cube
+ */
+ic3_cube ic3_cube_create(int *lits, int size)
+{
+    ic3_cube cube;
+    cube.size = size;
+    cube.lits = (int *)malloc((size + 1) * sizeof(int));
+    memcpy(cube.lits, lits, size * sizeof(int));
+    return cube;
+}
+
+/**
+ * @brief Extracts from @p model the full state assigned to the current variables (or the primed ones if @p primed). Only the current node of each automaton is kept as a positive literal: the other nodes are implied.
+ *
+ * @param engine The engine.
+ * @param model A model of a query.
+ * @param primed Whether to read the primed variables.
+ * @return ic3_cube
+ */
+ic3_cube ic3_cube_from_model(ic3_engine *engine, Z3_model model, bool primed)
+{
+    Z3_ast *vars = primed ? engine->next : engine->cur;
+    int lits[engine->num_automata + engine->max_lock + 1];
+    int size = 0;
+    for (int aut = 0; aut < engine->num_automata; aut++)
+        for (int node = 0; node < la_get_num_nodes(engine->automata[aut]); node++)
+            if (value_of_var_in_model(engine->ctx, model, vars[engine->node_offset[aut] + node]))
+            {
+                lits[size++] = engine->node_offset[aut] + node + 1;
+                break;
+            }
+    for (int lock = 1; lock <= engine->max_lock; lock++)
+    {
+        int index = ic3_lock_index(engine, lock);
+        lits[size++] = value_of_var_in_model(engine->ctx, model, vars[index]) ? index + 1 : -(index + 1);
+    }
+    return ic3_cube_create(lits, size);
+}
+
+/**
+ * @brief Returns the move taken in the transition described by @p model.
+ *
+ * @param engine The engine.
+ * @param model A model of a query containing the transition relation.
+ * @return step
+ */
+step ic3_step_from_model(ic3_engine *engine, Z3_model model)
+{
+    for (int move = 0; move < engine->num_moves; move++)
+        if (value_of_var_in_model(engine->ctx, model, engine->move_vars[move]))
+            return engine->moves[move];
+    return la_step_empty();
+}
+
+/**
+ * @brief Tells if @p cube contains the initial state.
+ *
+ * @param engine The engine.
+ * @param cube A cube.
+ * @return true if every literal of @p cube holds in the initial state.
+ * @return false otherwise.
+ */
+bool ic3_intersects_initial(ic3_engine *engine, ic3_cube cube)
+{
+    for (int i = 0; i < cube.size; i++)
+    {
+        int lit = cube.lits[i];
+        int value = engine->init_values[abs(lit) - 1];
+        if ((lit > 0) != (value != 0))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Tells if @p cube1 and @p cube2 have the same literals in the same order.
+ *
+ * @param cube1 A cube.
+ * @param cube2 A cube.
+ * @return true if they are equal.
+ * @return false otherwise.
+ */
+bool ic3_same_cube(ic3_cube cube1, ic3_cube cube2)
+{
+    return cube1.size == cube2.size && memcmp(cube1.lits, cube2.lits, cube1.size * sizeof(int)) == 0;
+}
+
+/**
+ * @brief Records a new lemma blocking @p cube in frames 1 to @p level. The cube is owned by the engine afterwards. If the same lemma is already known, only its level is raised.
+ *
+ * @param engine The engine.
+ * @param cube The cube blocked.
+ * @param level The highest frame containing the lemma.
+ */
+void ic3_add_lemma(ic3_engine *engine, ic3_cube cube, int level)
+{
+    Z3_ast clause = ic3_clause(engine, cube);
+    for (int i = 0; i < engine->num_lemmas; i++)
+    {
+        ic3_lemma *lemma = &engine->lemmas[i];
+        if (!ic3_same_cube(lemma->cube, cube))
+            continue;
+        for (int frame = lemma->level + 1; frame <= level && frame < engine->num_frames; frame++)
+            Z3_solver_assert(engine->ctx, engine->frames[frame], clause);
+        if (lemma->level < level)
+            lemma->level = level;
+        free(cube.lits);
+        release_formula(engine->ctx, clause);
+        return;
+    }
+    if (engine->num_lemmas == engine->cap_lemmas)
+    {
+        engine->cap_lemmas = 2 * engine->cap_lemmas + 16;
+        engine->lemmas = (ic3_lemma *)realloc(engine->lemmas, engine->cap_lemmas * sizeof(ic3_lemma));
+    }
+    engine->lemmas[engine->num_lemmas].cube = cube;
+    engine->lemmas[engine->num_lemmas].level = level;
+    engine->num_lemmas++;
+    for (int frame = 1; frame <= level && frame < engine->num_frames; frame++)
+        Z3_solver_assert(engine->ctx, engine->frames[frame], clause);
+    release_formula(engine->ctx, clause);
+}
+
+/**
+ * @brief Records a new proof obligation. The cube is owned by the engine afterwards.
+ *
+ * @param engine The engine.
+ * @param cube A full state.
+ * @param level The frame at which it must be blocked.
+ * @param parent The obligation reached in one step from @p cube (-1 if none).
+ * @param to_parent The step from @p cube to the state of @p parent.
+ * @return int The index of the obligation.
+ */
+int ic3_add_obligation(ic3_engine *engine, ic3_cube cube, int level, int parent, step to_parent)
+{
+    if (engine->num_obligations == engine->cap_obligations)
+    {
+        engine->cap_obligations = 2 * engine->cap_obligations + 16;
+        engine->obligations = (ic3_obligation *)realloc(engine->obligations, engine->cap_obligations * sizeof(ic3_obligation));
+    }
+    ic3_obligation *ob = &engine->obligations[engine->num_obligations];
+    ob->cube = cube;
+    ob->level = level;
+    ob->parent = parent;
+    ob->to_parent = to_parent;
+    ob->pending = true;
+    return engine->num_obligations++;
+}
+
+/**
+ * @brief Checks if @p cube is inductive relative to frame @p level - 1, i.e. if F_{level-1} ∧ ¬cube ∧ T ∧ cube' is unsatisfiable.
+ * If it is, @p core receives the sub-cube of @p cube appearing in the unsat core. Otherwise, @p pred and @p move receive a predecessor state and the step from it to @p cube.
+ *
+ * @param engine The engine.
+ * @param cube A cube.
+ * @param level A frame number (at least 1).
+ * @param core If not NULL, filled with the literals of the core when unsatisfiable.
+ * @param pred If not NULL, filled with the predecessor found when satisfiable.
+ * @param move If not NULL, filled with the move taken from the predecessor when satisfiable.
+ * @return Z3_lbool Z3_L_FALSE if @p cube is relatively inductive, Z3_L_TRUE if not, Z3_L_UNDEF if the solver did not decide.
+ */
+Z3_lbool ic3_relative_induction(ic3_engine *engine, ic3_cube cube, int level, ic3_cube *core, ic3_cube *pred, step *move)
+{
+    Z3_context ctx = engine->ctx;
+    Z3_solver solver = engine->frames[level - 1];
+    Z3_ast assumptions[cube.size + 1];
+    for (int i = 0; i < cube.size; i++)
+        assumptions[i] = ic3_literal(engine, cube.lits[i], true);
+    assumptions[cube.size] = engine->use_transition;
+
+    Z3_ast clause = ic3_clause(engine, cube);
+    Z3_solver_push(ctx, solver);
+    Z3_solver_assert(ctx, solver, clause);
+    release_formula(ctx, clause);
+    Z3_lbool result = Z3_solver_check_assumptions(ctx, solver, cube.size + 1, assumptions);
+    if (result == Z3_L_TRUE && (pred != NULL || move != NULL))
+    {
+        Z3_model model = Z3_solver_get_model(ctx, solver);
+        Z3_model_inc_ref(ctx, model);
+        if (pred != NULL)
+            *pred = ic3_cube_from_model(engine, model, false);
+        if (move != NULL)
+            *move = ic3_step_from_model(engine, model);
+        Z3_model_dec_ref(ctx, model);
+    }
+    if (result == Z3_L_FALSE && core != NULL)
+    {
+        Z3_ast_vector unsat_core = Z3_solver_get_unsat_core(ctx, solver);
+        Z3_ast_vector_inc_ref(ctx, unsat_core);
+        int lits[cube.size + 1];
+        int size = 0;
+        for (int i = 0; i < cube.size; i++)
+            for (unsigned j = 0; j < Z3_ast_vector_size(ctx, unsat_core); j++)
+                if (Z3_is_eq_ast(ctx, assumptions[i], Z3_ast_vector_get(ctx, unsat_core, j)))
+                {
+                    lits[size++] = cube.lits[i];
+                    break;
+                }
+        Z3_ast_vector_dec_ref(ctx, unsat_core);
+        *core = ic3_cube_create(lits, size);
+    }
+    Z3_solver_pop(ctx, solver, 1);
+    release_formulae(ctx, assumptions, cube.size);
+    return result;
+}
+
+/**
+ * @brief Makes sure @p generalized (a sub-cube of @p cube) does not contain the initial state, by putting back a literal of @p cube false initially.
+ *
+ * @param engine The engine.
+ * @param generalized A sub-cube of @p cube (modified).
+ * @param cube A cube not containing the initial state.
+ */
+void ic3_exclude_initial(ic3_engine *engine, ic3_cube *generalized, ic3_cube cube)
+{
+    if (!ic3_intersects_initial(engine, *generalized))
+        return;
+    for (int i = 0; i < cube.size; i++)
+    {
+        ic3_cube single = {cube.lits + i, 1};
+        if (!ic3_intersects_initial(engine, single))
+        {
+            generalized->lits[generalized->size++] = cube.lits[i];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Generalizes @p cube, known to be inductive relative to frame @p level - 1 with unsat core @p core: tries to drop each literal while keeping relative induction and excluding the initial state.
+ *
+ * @param engine The engine.
+ * @param cube The cube to block (not containing the initial state).
+ * @param core The sub-cube given by the unsat core (freed by this function).
+ * @param level The frame at which the cube is blocked.
+ * @return ic3_cube The generalized cube.
+ */
+ic3_cube ic3_generalize(ic3_engine *engine, ic3_cube cube, ic3_cube core, int level)
+{
+    ic3_cube result = ic3_cube_create(core.lits, core.size);
+    free(core.lits);
+    result.lits = (int *)realloc(result.lits, (cube.size + 1) * sizeof(int));
+    ic3_exclude_initial(engine, &result, cube);
+
+    for (int i = 0; i < result.size && result.size > 1;)
+    {
+        int candidate[result.size];
+        int size = 0;
+        for (int j = 0; j < result.size; j++)
+            if (j != i)
+                candidate[size++] = result.lits[j];
+        ic3_cube attempt = {candidate, size};
+        ic3_cube attempt_core;
+        if (ic3_intersects_initial(engine, attempt) || ic3_relative_induction(engine, attempt, level, &attempt_core, NULL, NULL) != Z3_L_FALSE)
+        {
+            i++;
+            continue;
+        }
+        ic3_exclude_initial(engine, &attempt_core, attempt);
+        memcpy(result.lits, attempt_core.lits, attempt_core.size * sizeof(int));
+        result.size = attempt_core.size;
+        free(attempt_core.lits);
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the pending obligation of lowest level (-1 if none).
+ *
+ * @param engine The engine.
+ * @return int
+ */
+int ic3_next_obligation(ic3_engine *engine)
+{
+    int best = -1;
+    for (int i = 0; i < engine->num_obligations; i++)
+        if (engine->obligations[i].pending && (best == -1 || engine->obligations[i].level < engine->obligations[best].level))
+            best = i;
+    return best;
+}
+
+/**
+ * @brief Blocks the deadlock state of obligation @p bad (at level @p k), recursively blocking its predecessors.
+ *
+ * @param engine The engine.
+ * @param k The current top frame.
+ * @param initial Receives the index of the obligation whose predecessor is initial if a counterexample is found.
+ * @param first_step Receives the step from the initial state to the state of *@p initial.
+ * @return Z3_lbool Z3_L_TRUE if a counterexample was found, Z3_L_FALSE if every obligation was discharged, Z3_L_UNDEF if the solver did not decide.
+ */
+Z3_lbool ic3_block(ic3_engine *engine, int k, int *initial, step *first_step)
+{
+    int current;
+    while ((current = ic3_next_obligation(engine)) != -1)
+    {
+        ic3_cube cube = engine->obligations[current].cube;
+        int level = engine->obligations[current].level;
+        ic3_cube core;
+        ic3_cube pred;
+        step move;
+        Z3_lbool res = ic3_relative_induction(engine, cube, level, &core, &pred, &move);
+        if (res == Z3_L_UNDEF)
+            return Z3_L_UNDEF;
+        if (res == Z3_L_TRUE)
+        {
+            if (level == 1)
+            {
+                free(pred.lits);
+                *initial = current;
+                *first_step = move;
+                return Z3_L_TRUE;
+            }
+            ic3_add_obligation(engine, pred, level - 1, current, move);
+            continue;
+        }
+        ic3_cube lemma = ic3_generalize(engine, cube, core, level);
+        int lemma_level = level;
+        while (lemma_level < k && ic3_relative_induction(engine, lemma, lemma_level + 1, NULL, NULL, NULL) == Z3_L_FALSE)
+            lemma_level++;
+        ic3_add_lemma(engine, lemma, lemma_level);
+        if (lemma_level < k)
+            engine->obligations[current].level = lemma_level + 1;
+        else
+            engine->obligations[current].pending = false;
+    }
+    return Z3_L_FALSE;
+}
+
+/**
+ * @brief Looks for a deadlock state in frame @p k. If one is found, it is added as a proof obligation at level @p k.
+ *
+ * @param engine The engine.
+ * @param k A frame number.
+ * @return Z3_lbool Z3_L_TRUE if a deadlock state was found, Z3_L_FALSE if none exists in the frame, Z3_L_UNDEF if the solver did not decide.
+ */
+Z3_lbool ic3_find_bad_state(ic3_engine *engine, int k)
+{
+    Z3_context ctx = engine->ctx;
+    Z3_solver solver = engine->frames[k];
+    Z3_solver_push(ctx, solver);
+    Z3_solver_assert(ctx, solver, engine->deadlock);
+    Z3_lbool result = Z3_solver_check(ctx, solver);
+    if (result == Z3_L_TRUE)
+    {
+        Z3_model model = Z3_solver_get_model(ctx, solver);
+        Z3_model_inc_ref(ctx, model);
+        ic3_add_obligation(engine, ic3_cube_from_model(engine, model, false), k, -1, la_step_empty());
+        Z3_model_dec_ref(ctx, model);
+    }
+    Z3_solver_pop(ctx, solver, 1);
+    return result;
+}
+
+/**
+ * @brief Pushes lemmas of frames 1 to @p k to the next frame whenever they are inductive relative to their frame.
+ *
+ * @param engine The engine.
+ * @param k The current top frame.
+ * @return int A level i such that frames i and i + 1 are equal (then F_i is an inductive invariant), or -1 if there is none.
+ */
+int ic3_propagate(ic3_engine *engine, int k)
+{
+    for (int level = 1; level <= k; level++)
+    {
+        bool remaining = false;
+        for (int i = 0; i < engine->num_lemmas; i++)
+        {
+            ic3_lemma *lemma = &engine->lemmas[i];
+            if (lemma->level != level)
+                continue;
+            Z3_ast assumptions[lemma->cube.size + 1];
+            for (int j = 0; j < lemma->cube.size; j++)
+                assumptions[j] = ic3_literal(engine, lemma->cube.lits[j], true);
+            assumptions[lemma->cube.size] = engine->use_transition;
+            if (Z3_solver_check_assumptions(engine->ctx, engine->frames[level], lemma->cube.size + 1, assumptions) == Z3_L_FALSE)
+            {
+                lemma->level = level + 1;
+                Z3_ast clause = ic3_clause(engine, lemma->cube);
+                Z3_solver_assert(engine->ctx, engine->frames[level + 1], clause);
+                release_formula(engine->ctx, clause);
+            }
+            else
+                remaining = true;
+            release_formulae(engine->ctx, assumptions, lemma->cube.size);
+        }
+        if (!remaining)
+            return level;
+    }
+    return -1;
+}
+
+/**
+ * @brief Prints the inductive invariant made of the lemmas of level at least @p level.
+ *
+ * @param engine The engine.
+ * @param level The level of the fixpoint.
+ */
+void ic3_print_invariant(ic3_engine *engine, int level)
+{
+    int count = 0;
+    for (int i = 0; i < engine->num_lemmas; i++)
+        if (engine->lemmas[i].level > level)
+            count++;
+    printf("Inductive invariant (conjunction of %d clauses, plus exactly one node per automaton):\n", count);
+    for (int i = 0; i < engine->num_lemmas; i++)
+    {
+        ic3_lemma lemma = engine->lemmas[i];
+        if (lemma.level <= level)
+            continue;
+        printf(" not (");
+        for (int j = 0; j < lemma.cube.size; j++)
+        {
+            int var = abs(lemma.cube.lits[j]) - 1;
+            bool positive = lemma.cube.lits[j] > 0;
+            if (j > 0)
+                printf(" and ");
+            if (var >= engine->node_offset[engine->num_automata])
+            {
+                printf("lock %d %s", var - engine->node_offset[engine->num_automata] + 1, positive ? "taken" : "free");
+                continue;
+            }
+            int aut = 0;
+            while (engine->node_offset[aut + 1] <= var)
+                aut++;
+            printf("%s(%d) %s %s", la_get_name(engine->automata[aut]), aut, positive ? "in" : "not in", la_get_node_name(engine->automata[aut], var - engine->node_offset[aut]));
+        }
+        printf(")\n");
+    }
+}
+
+/**
+ * @brief Builds the path leading from the initial state to the deadlock state through the obligation @p initial.
+ *
+ * @param engine The engine.
+ * @param initial The obligation reached from the initial state.
+ * @param first_step The step from the initial state to the state of @p initial.
+ * @param path Receives the allocated path.
+ * @param size_path Receives its length.
+ */
+void ic3_build_path(ic3_engine *engine, int initial, step first_step, step **path, int *size_path)
+{
+    int size = 1;
+    for (int ob = initial; engine->obligations[ob].parent != -1; ob = engine->obligations[ob].parent)
+        size++;
+    *path = (step *)malloc(size * sizeof(step));
+    (*path)[0] = first_step;
+    int pos = 1;
+    for (int ob = initial; engine->obligations[ob].parent != -1; ob = engine->obligations[ob].parent)
+        (*path)[pos++] = engine->obligations[ob].to_parent;
+    *size_path = size;
+}
+
+/**
+ * @brief Frees the memory used by @p engine.
+ *
+ * @param engine The engine.
+ */
+void ic3_engine_delete(ic3_engine *engine)
+{
+    for (int frame = 0; frame < engine->num_frames; frame++)
+        Z3_solver_dec_ref(engine->ctx, engine->frames[frame]);
+    release_formulae(engine->ctx, engine->cur, engine->num_vars);
+    release_formulae(engine->ctx, engine->next, engine->num_vars);
+    release_formulae(engine->ctx, engine->move_vars, engine->num_moves);
+    release_formulae(engine->ctx, (Z3_ast[]){engine->states, engine->transition, engine->use_transition, engine->deadlock}, 4);
+    for (int i = 0; i < engine->num_lemmas; i++)
+        free(engine->lemmas[i].cube.lits);
+    for (int i = 0; i < engine->num_obligations; i++)
+        free(engine->obligations[i].cube.lits);
+    free(engine->frames);
+    free(engine->lemmas);
+    free(engine->obligations);
+    free(engine->node_offset);
+    free(engine->cur);
+    free(engine->next);
+    free(engine->init_values);
+    free(engine->moves);
+    free(engine->move_vars);
+}
+
+/**
+ * @brief Writes a checkpoint of @p engine after the completion of frame @p k: the number of variables, @p k and the lemmas (level, size and literals of each one).
+ *
+ * @param engine The engine.
+ * @param k The last frame completed.
+ * @param options The checkpoint options.
+ * @param fingerprint The fingerprint of the automata.
+ */
+void ic3_checkpoint(ic3_engine *engine, int k, const checkpoint_options *options, uint64_t fingerprint)
+{
+    FILE *file = checkpoint_begin(options, CHECKPOINT_IC3, fingerprint);
+    if (file == NULL)
+        return;
+    int32_t counts[3] = {engine->num_vars, k, engine->num_lemmas};
+    fwrite(counts, sizeof(int32_t), 3, file);
+    for (int i = 0; i < engine->num_lemmas; i++)
+    {
+        int32_t lemma[2] = {engine->lemmas[i].level, engine->lemmas[i].cube.size};
+        fwrite(lemma, sizeof(int32_t), 2, file);
+        fwrite(engine->lemmas[i].cube.lits, sizeof(int32_t), lemma[1], file);
+    }
+    checkpoint_end(options, file);
+}
+
+/**
+ * @brief Restores the frames and lemmas of @p engine from the checkpoint of @p options, if there is a valid one. The engine must only have frames 0 and 1.
+ *
+ * @param engine The engine.
+ * @param options The checkpoint options.
+ * @param fingerprint The fingerprint of the automata.
+ * @return int The last frame completed, or 0 if no checkpoint was restored.
+ */
+int ic3_resume(ic3_engine *engine, const checkpoint_options *options, uint64_t fingerprint)
+{
+    checkpoint_mapping mapping;
+    if (!checkpoint_map(options, CHECKPOINT_IC3, fingerprint, &mapping))
+        return 0;
+    const int32_t *data = (const int32_t *)mapping.data;
+    size_t num_words = mapping.data_size / sizeof(int32_t);
+    if (num_words < 3 || data[0] != engine->num_vars || data[1] < 1)
+    {
+        checkpoint_unmap(&mapping);
+        return 0;
+    }
+    // Validates the whole file before touching the engine.
+    size_t position = 3;
+    for (int i = 0; i < data[2]; i++)
+    {
+        if (position + 2 > num_words || data[position + 1] < 0 || position + 2 + data[position + 1] > num_words)
+        {
+            checkpoint_unmap(&mapping);
+            return 0;
+        }
+        for (int j = 0; j < data[position + 1]; j++)
+            if (data[position + 2 + j] == 0 || abs(data[position + 2 + j]) > engine->num_vars)
+            {
+                checkpoint_unmap(&mapping);
+                return 0;
+            }
+        position += 2 + data[position + 1];
+    }
+    int k = data[1];
+    while (engine->num_frames < k + 2)
+        ic3_add_frame(engine);
+    position = 3;
+    for (int i = 0; i < data[2]; i++)
+    {
+        int level = data[position];
+        int size = data[position + 1];
+        ic3_add_lemma(engine, ic3_cube_create((int *)(data + position + 2), size), level);
+        position += 2 + size;
+    }
+    checkpoint_unmap(&mapping);
+    printf("Resuming from checkpoint %s (%d frames completed, %d lemmas).\n", options->file, k, engine->num_lemmas);
+    return k;
+}
+
+Z3_lbool deadlock_ic3(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path, bool print_invariant)
+{
+    return deadlock_ic3_checkpointed(ctx, automata, num_automata, path, size_path, print_invariant, NULL);
+}
+
+Z3_lbool deadlock_ic3_checkpointed(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path, bool print_invariant, const checkpoint_options *options)
+{
+    ic3_engine engine;
+    ic3_engine_init(&engine, ctx, automata, num_automata);
+    uint64_t fingerprint = options != NULL ? checkpoint_fingerprint(automata, num_automata) : 0;
+    *path = NULL;
+    *size_path = 0;
+
+    ic3_add_frame(&engine);
+    ic3_add_frame(&engine);
+    int completed = ic3_resume(&engine, options, fingerprint);
+    Z3_lbool result = completed > 0 ? Z3_L_FALSE : ic3_find_bad_state(&engine, 0);
+    if (result == Z3_L_TRUE)
+        *path = (step *)malloc(sizeof(step));
+    double last_checkpoint = checkpoint_now();
+    for (int k = completed + 1; result == Z3_L_FALSE; k++)
+    {
+        Z3_lbool bad;
+        while ((bad = ic3_find_bad_state(&engine, k)) == Z3_L_TRUE)
+        {
+            int initial;
+            step first_step;
+            result = ic3_block(&engine, k, &initial, &first_step);
+            if (result == Z3_L_TRUE)
+                ic3_build_path(&engine, initial, first_step, path, size_path);
+            if (result != Z3_L_FALSE)
+                break;
+        }
+        if (bad == Z3_L_UNDEF)
+            result = Z3_L_UNDEF;
+        if (result != Z3_L_FALSE)
+            break;
+        ic3_add_frame(&engine);
+        int fixpoint = ic3_propagate(&engine, k);
+        if (fixpoint != -1)
+        {
+            if (print_invariant)
+                ic3_print_invariant(&engine, fixpoint);
+            break;
+        }
+        if (checkpoint_due(options, &last_checkpoint))
+            ic3_checkpoint(&engine, k, options, fingerprint);
+    }
+    ic3_engine_delete(&engine);
+    return result;
+}
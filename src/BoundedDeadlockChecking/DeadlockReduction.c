@@ -1,5 +1,6 @@
 #include "DeadlockReduction.h"
 #include "Z3Tools.h"
+#include "Cardinality.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -7,40 +8,153 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdio.h>
+#include <time.h>
 
 
-Z3_ast variable_node_on_path(Z3_context ctx, int automaton, int node, int step)
+fb_node variable_node_on_path(FormulaBuilder builder, int automaton, int node, int step)
 {
     char name[60];
     snprintf(name, 60, "step %d: (aut: %d, node: %d)", step, automaton, node);
-    return mk_bool_var(ctx, name);
+    return fb_var(builder, name);
 }
 
 /**
  * @brief Creates a formula containing only the variable representing that at step @p step, lock @p lock it taken by some process.
  *
- * @param ctx The solver context.
+ * @param builder The formula builder.
  * @param lock
  * @param step
- * @return Z3_ast
+ * @return fb_node
  */
-Z3_ast variable_lock_at_step(Z3_context ctx, int lock, int step)
+fb_node variable_lock_at_step(FormulaBuilder builder, int lock, int step)
 {
     char name[40];
     snprintf(name, 40, "step %d : lock %d", step, lock);
-    return mk_bool_var(ctx, name);
+    return fb_var(builder, name);
 }
 
-/*
-Here, you should put formula producing the formula. Cut it in subfunctions, similarly to what is present in ColouringReduction.c.
-*/
+/**
+ * @brief Creates a formula containing only the variable representing that at step @p step, lock @p lock is held by its @p owner-th possible owner (one-hot encoding of the owners).
+ *
+ * @param builder The formula builder.
+ * @param lock
+ * @param owner
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_owner_at_step(FormulaBuilder builder, int lock, int owner, int step)
+{
+    char name[60];
+    snprintf(name, 60, "step %d : lock %d owner %d", step, lock, owner);
+    return fb_var(builder, name);
+}
 
-// Z3_ast deadlock_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound)
-// {
-//     return Z3_mk_false(ctx);
-// }
+/**
+ * @brief Creates a formula containing only the variable representing bit @p bit of the code of the owner of lock @p lock at step @p step (binary encoding of the owners).
+ *
+ * @param builder The formula builder.
+ * @param lock
+ * @param bit
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_owner_bit_at_step(FormulaBuilder builder, int lock, int bit, int step)
+{
+    char name[60];
+    snprintf(name, 60, "step %d : lock %d owner bit %d", step, lock, bit);
+    return fb_var(builder, name);
+}
 
-void la_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, step *path, int bound)
+/**
+ * @brief Creates a formula containing only the variable representing that between step @p step and @p step + 1, automaton @p automaton takes the edge (@p source, @p target).
+ *
+ * @param builder The formula builder.
+ * @param automaton
+ * @param source
+ * @param target
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_move_at_step(FormulaBuilder builder, int automaton, int source, int target, int step)
+{
+    char name[80];
+    snprintf(name, 80, "step %d: (aut: %d, move: %d -> %d)", step, automaton, source, target);
+    return fb_var(builder, name);
+}
+
+/**
+ * @brief Creates a formula containing only the variable representing that automaton @p automaton moves between step @p step and @p step + 1.
+ *
+ * @param builder The formula builder.
+ * @param automaton
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_automaton_moves(FormulaBuilder builder, int automaton, int step)
+{
+    char name[60];
+    snprintf(name, 60, "step %d: (aut: %d, moves)", step, automaton);
+    return fb_var(builder, name);
+}
+
+/**
+ * @brief The results of the static analyses of the automata used to prune the formula.
+ */
+typedef struct
+{
+    int num_automata;      ///< The number of automata.
+    int max_lock;          ///< The biggest lock used.
+    int **distances;       ///< The distances from the initial node of each automaton (see la_distances_from_initial).
+    LockSets *locksets;    ///< The lockset analysis of each automaton (see la_compute_locksets).
+    bool releases_well_formed; ///< Whether every automaton only releases locks it holds.
+    bool *constant_lock;   ///< Whether each lock is never acquired, and is thus free at every step.
+    lock_encoding encoding; ///< How the state of the locks is encoded.
+    int *num_owners;       ///< For each lock, the number of automata which may acquire it.
+    int **owners;          ///< For each lock, the automata which may acquire it.
+    int *owner_bits;       ///< For each lock, the number of bits of the code of its owner (binary encoding).
+    const bool *tracked_lock; ///< For each lock, whether it is tracked (see deadlock_abstract_reduction). NULL if all locks are.
+} reduction_info;
+
+/**
+ * @brief Tells if automaton @p aut can be in node @p node at step @p step, i.e. if @p node is at distance at most @p step from its initial node.
+ *
+ * @param info The static analyses of the automata.
+ * @param aut The number of the automaton.
+ * @param node
+ * @param step
+ * @return true if @p node can be reached in @p step moves.
+ * @return false otherwise.
+ */
+bool node_reachable_at_step(reduction_info *info, int aut, int node, int step)
+{
+    return info->distances[aut][node] != -1 && info->distances[aut][node] <= step;
+}
+
+/**
+ * @brief Returns the variable telling that automaton @p aut is in @p node at step @p step if that is possible, and false otherwise (such variables are never created).
+ *
+ * @param builder The formula builder.
+ * @param info The static analyses of the automata.
+ * @param aut The number of the automaton.
+ * @param node
+ * @param step
+ * @return fb_node
+ */
+fb_node node_on_path_formula(FormulaBuilder builder, reduction_info *info, int aut, int node, int step)
+{
+    if (!node_reachable_at_step(info, aut, node, step))
+        return FB_FALSE;
+    return variable_node_on_path(builder, aut, node, step);
+}
+
+/**
+ * @brief Returns the biggest lock used by one of the automata.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return int
+ */
+int get_max_lock(LockAutomaton *automata, int num_automata)
 {
     int max_lock = 0;
     for (int aut = 0; aut < num_automata; aut++)
@@ -49,76 +163,696 @@ void la_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata,
         if (max_lock < aux)
             max_lock = aux;
     }
-    for (int step = 0; step < bound; step++)
+    return max_lock;
+}
+
+/**
+ * @brief Runs the static analyses of @p automata used to prune the formula: distances from the initial nodes, locksets (see la_compute_locksets), and possible owners of each lock.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param encoding How the state of the locks is encoded.
+ * @return reduction_info* The results, to be freed with delete_reduction_info.
+ */
+reduction_info *compute_reduction_info(LockAutomaton *automata, int num_automata, lock_encoding encoding)
+{
+    reduction_info *info = (reduction_info *)malloc(sizeof(reduction_info));
+    info->num_automata = num_automata;
+    info->max_lock = get_max_lock(automata, num_automata);
+    info->distances = (int **)malloc(num_automata * sizeof(int *));
+    info->locksets = (LockSets *)malloc(num_automata * sizeof(LockSets));
+    info->releases_well_formed = true;
+    for (int aut = 0; aut < num_automata; aut++)
     {
-        int action_taken = 0;
-        for (int lock = 1; lock <= max_lock; lock++)
+        info->distances[aut] = (int *)malloc(la_get_num_nodes(automata[aut]) * sizeof(int));
+        la_distances_from_initial(automata[aut], info->distances[aut]);
+        info->locksets[aut] = la_compute_locksets(automata[aut]);
+        if (!la_releases_only_held_locks(automata[aut], info->locksets[aut]))
+            info->releases_well_formed = false;
+    }
+    info->encoding = encoding;
+    info->tracked_lock = NULL;
+    info->constant_lock = (bool *)malloc((info->max_lock + 1) * sizeof(bool));
+    info->num_owners = (int *)malloc((info->max_lock + 1) * sizeof(int));
+    info->owners = (int **)malloc((info->max_lock + 1) * sizeof(int *));
+    info->owner_bits = (int *)malloc((info->max_lock + 1) * sizeof(int));
+    for (int lock = 0; lock <= info->max_lock; lock++)
+    {
+        info->num_owners[lock] = 0;
+        info->owners[lock] = (int *)malloc(num_automata * sizeof(int));
+        for (int aut = 0; aut < num_automata; aut++)
+            if (la_acquires_lock(automata[aut], info->locksets[aut], lock))
+                info->owners[lock][info->num_owners[lock]++] = aut;
+        info->constant_lock[lock] = info->num_owners[lock] == 0;
+        // Code 0 is the free lock, code i the i-th owner.
+        info->owner_bits[lock] = 0;
+        while ((1 << info->owner_bits[lock]) <= info->num_owners[lock])
+            info->owner_bits[lock]++;
+    }
+    return info;
+}
+
+/**
+ * @brief Frees the analyses computed by compute_reduction_info.
+ *
+ * @param info
+ */
+void delete_reduction_info(reduction_info *info)
+{
+    for (int aut = 0; aut < info->num_automata; aut++)
+    {
+        free(info->distances[aut]);
+        la_delete_locksets(info->locksets[aut]);
+    }
+    for (int lock = 0; lock <= info->max_lock; lock++)
+        free(info->owners[lock]);
+    free(info->distances);
+    free(info->locksets);
+    free(info->constant_lock);
+    free(info->num_owners);
+    free(info->owners);
+    free(info->owner_bits);
+    free(info);
+}
+
+/**
+ * @brief Tells if the state of @p lock is constrained by the formula. The variables of the other locks are left free: such locks may be taken or not at any step, independently of the moves.
+ *
+ * @param info The static analyses of the automata.
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool lock_is_tracked(reduction_info *info, int lock)
+{
+    return info->tracked_lock == NULL || info->tracked_lock[lock];
+}
+
+/**
+ * @brief Returns the formula telling that the owner of @p lock at step @p step has code @p code (0 for a free lock, i for its i-th possible owner), in the encoding of the owners of @p info.
+ *
+ * @param builder The formula builder.
+ * @param info The static analyses of the automata.
+ * @param lock
+ * @param step
+ * @param code
+ * @return fb_node
+ *
+ * @pre The encoding of @p info is not LOCK_ENCODING_TAKEN, and 0 <= @p code < 2^info->owner_bits[@p lock].
+ */
+fb_node owner_code_formula(FormulaBuilder builder, reduction_info *info, int lock, int step, int code)
+{
+    if (info->constant_lock[lock])
+        return code == 0 ? FB_TRUE : FB_FALSE;
+    if (info->encoding == LOCK_ENCODING_ONE_HOT)
+    {
+        if (code > 0)
+            return variable_owner_at_step(builder, lock, code - 1, step);
+        fb_node owned[info->num_owners[lock]];
+        for (int owner = 0; owner < info->num_owners[lock]; owner++)
+            owned[owner] = fb_not(variable_owner_at_step(builder, lock, owner, step));
+        return fb_and(builder, info->num_owners[lock], owned);
+    }
+    fb_node bits[info->owner_bits[lock]];
+    for (int bit = 0; bit < info->owner_bits[lock]; bit++)
+    {
+        fb_node var = variable_owner_bit_at_step(builder, lock, bit, step);
+        bits[bit] = (code >> bit) & 1 ? var : fb_not(var);
+    }
+    return fb_and(builder, info->owner_bits[lock], bits);
+}
+
+/**
+ * @brief Returns the formula telling that @p lock is taken at step @p step: its variable, or false if @p lock is never acquired (such variables are never created). With an encoding of the owners, the lock is taken if it has an owner.
+ *
+ * @param builder The formula builder.
+ * @param info The static analyses of the automata.
+ * @param lock
+ * @param step
+ * @return fb_node
+ */
+fb_node lock_at_step_formula(FormulaBuilder builder, reduction_info *info, int lock, int step)
+{
+    if (info->constant_lock[lock])
+        return FB_FALSE;
+    if (info->encoding == LOCK_ENCODING_TAKEN)
+        return variable_lock_at_step(builder, lock, step);
+    int size = info->encoding == LOCK_ENCODING_ONE_HOT ? info->num_owners[lock] : info->owner_bits[lock];
+    fb_node owned[size];
+    for (int i = 0; i < size; i++)
+        owned[i] = info->encoding == LOCK_ENCODING_ONE_HOT ? variable_owner_at_step(builder, lock, i, step) : variable_owner_bit_at_step(builder, lock, i, step);
+    return fb_or(builder, size, owned);
+}
+
+/**
+ * @brief Returns the formula telling that @p lock is held by automaton @p aut at step @p step. Without an encoding of the owners (or if @p aut never acquires @p lock), this is only that @p lock is taken.
+ *
+ * @param builder The formula builder.
+ * @param info The static analyses of the automata.
+ * @param lock
+ * @param aut The number of the automaton.
+ * @param step
+ * @return fb_node
+ */
+fb_node held_by_formula(FormulaBuilder builder, reduction_info *info, int lock, int aut, int step)
+{
+    if (info->encoding != LOCK_ENCODING_TAKEN)
+        for (int owner = 0; owner < info->num_owners[lock]; owner++)
+            if (info->owners[lock][owner] == aut)
+                return owner_code_formula(builder, info, lock, step, owner + 1);
+    return lock_at_step_formula(builder, info, lock, step);
+}
+
+/**
+ * @brief Returns the formula telling that the state of @p lock (taken or not, or its owner) is the same at steps @p step and @p step + 1.
+ *
+ * @param builder The formula builder.
+ * @param info The static analyses of the automata.
+ * @param lock A lock which may be acquired.
+ * @param step
+ * @return fb_node
+ */
+fb_node lock_unchanged_formula(FormulaBuilder builder, reduction_info *info, int lock, int step)
+{
+    if (info->encoding == LOCK_ENCODING_TAKEN)
+        return fb_iff(builder, variable_lock_at_step(builder, lock, step), variable_lock_at_step(builder, lock, step + 1));
+    int size = info->encoding == LOCK_ENCODING_ONE_HOT ? info->num_owners[lock] : info->owner_bits[lock];
+    fb_node equal[size];
+    for (int i = 0; i < size; i++)
+    {
+        if (info->encoding == LOCK_ENCODING_ONE_HOT)
+            equal[i] = fb_iff(builder, variable_owner_at_step(builder, lock, i, step), variable_owner_at_step(builder, lock, i, step + 1));
+        else
+            equal[i] = fb_iff(builder, variable_owner_bit_at_step(builder, lock, i, step), variable_owner_bit_at_step(builder, lock, i, step + 1));
+    }
+    return fb_and(builder, size, equal);
+}
+
+/**
+ * @brief Creates the formula stating that at step 0, every automaton is in its initial node and every lock is free.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_initial_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, reduction_info *info)
+{
+    int max_lock = info->max_lock;
+    fb_node constraints[num_automata + max_lock];
+    for (int aut = 0; aut < num_automata; aut++)
+        constraints[aut] = variable_node_on_path(builder, aut, la_get_initial(automata[aut]), 0);
+    for (int lock = 1; lock <= max_lock; lock++)
+        constraints[num_automata + lock - 1] = lock_is_tracked(info, lock) ? fb_not(lock_at_step_formula(builder, info, lock, 0)) : FB_TRUE;
+    return fb_and(builder, num_automata + max_lock, constraints);
+}
+
+/**
+ * @brief Creates the formula stating that at every step between @p first and @p bound, every automaton is in exactly one node.
+ * Only nodes reachable at each step get a variable: early steps thus only involve a handful of variables.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param first The first step constrained.
+ * @param bound The number of steps.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_state_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int first, int bound, reduction_info *info)
+{
+    int num_steps = bound - first + 1;
+    fb_node constraints[num_automata * num_steps];
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        for (int step = first; step <= bound; step++)
         {
-            bool prev = value_of_var_in_model(ctx, model, variable_lock_at_step(ctx, lock, step));
-            bool next = value_of_var_in_model(ctx, model, variable_lock_at_step(ctx, lock, step + 1));
-            if (prev && !next)
+            fb_node node_vars[num_nodes];
+            int count = 0;
+            for (int node = 0; node < num_nodes; node++)
+                if (node_reachable_at_step(info, aut, node, step))
+                    node_vars[count++] = variable_node_on_path(builder, aut, node, step);
+            constraints[aut * num_steps + step - first] = card_exactly_one(builder, count, node_vars, CARD_AUTO);
+        }
+    }
+    return fb_and(builder, num_automata * num_steps, constraints);
+}
+
+/**
+ * @brief Creates the formula stating that, at every step, each lock has at most one owner (one-hot encoding) or a valid code (binary encoding), and that its owner is in a node where it may hold the lock (see la_may_hold).
+ * Nothing is generated without an encoding of the owners. The latter clauses are implied by the others, but let the solver prune as soon as an automaton is placed. Like the lockset constraints (see generate_lockset_constraints), they are only generated if every automaton only releases locks it holds, the only case where owners follow the semantics of the automata.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_owner_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int bound, reduction_info *info)
+{
+    if (info->encoding == LOCK_ENCODING_TAKEN)
+        return FB_TRUE;
+    fb_node *constraints = (fb_node *)malloc(((bound + 1) * info->max_lock * (3 * num_automata + 3) + 1) * sizeof(fb_node));
+    int count = 0;
+    for (int lock = 1; lock <= info->max_lock; lock++)
+    {
+        if (info->constant_lock[lock] || !lock_is_tracked(info, lock))
+            continue;
+        for (int step = 0; step <= bound; step++)
+        {
+            if (info->encoding == LOCK_ENCODING_ONE_HOT)
             {
-                action_taken = -lock;
-                break;
+                fb_node owned[info->num_owners[lock]];
+                for (int owner = 0; owner < info->num_owners[lock]; owner++)
+                    owned[owner] = variable_owner_at_step(builder, lock, owner, step);
+                constraints[count++] = card_at_most_one(builder, info->num_owners[lock], owned, CARD_AUTO);
             }
-            if (!prev && next)
+            else
+                for (int code = info->num_owners[lock] + 1; code < 1 << info->owner_bits[lock]; code++)
+                    constraints[count++] = fb_not(owner_code_formula(builder, info, lock, step, code));
+            for (int owner = 0; owner < info->num_owners[lock] && info->releases_well_formed; owner++)
             {
-                action_taken = lock;
-                break;
+                int aut = info->owners[lock][owner];
+                int num_nodes = la_get_num_nodes(automata[aut]);
+                fb_node holding[num_nodes];
+                int num_holding = 0;
+                for (int node = 0; node < num_nodes; node++)
+                    if (node_reachable_at_step(info, aut, node, step) && la_may_hold(info->locksets[aut], node, lock))
+                        holding[num_holding++] = variable_node_on_path(builder, aut, node, step);
+                constraints[count++] = fb_implies(builder, owner_code_formula(builder, info, lock, step, owner + 1), fb_or(builder, num_holding, holding));
             }
         }
-        for (int automaton = 0; automaton < num_automata; automaton++)
-        {
-            int num_nodes = la_get_num_nodes(automata[automaton]);
-            for (int source = 0; source < num_nodes; source++)
-
-                for (int target = 0; target < num_nodes; target++)
-                {
-
-                    if (source == target || !la_is_edge(automata[automaton], source, target))
-                        continue;
-                    if (la_get_edge_action(automata[automaton], source, target) != action_taken)
-                        continue;
-                    Z3_ast var_source = variable_node_on_path(ctx, automaton, source, step);
-                    Z3_ast var_target = variable_node_on_path(ctx, automaton, target, step + 1);
-                    if (value_of_var_in_model(ctx, model, var_source) && value_of_var_in_model(ctx, model, var_target))
-                    {
-                        path[step] = la_step_create(automaton, source, target, action_taken);
-                        goto Next_step;
-                    }
-                }
-        }
-        for (int automaton = 0; automaton < num_automata; automaton++)
-        {
-            int num_nodes = la_get_num_nodes(automata[automaton]);
-            for (int source = 0; source < num_nodes; source++)
+    }
+    fb_node result = fb_and(builder, count, constraints);
+    free(constraints);
+    return result;
+}
+
+/**
+ * @brief Creates the formula stating that, at every step between @p first and @p bound, the locks which must be held at the current node of an automaton (see la_must_hold) are taken.
+ * This is only true (and only generated) if every automaton only releases locks it holds: such locks cannot have been released by another automaton, and are thus held by that automaton (which is stated with an encoding of the owners). These clauses are implied by the others, but help the solver to propagate.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param first The first step constrained.
+ * @param bound The number of steps.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_lockset_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int first, int bound, reduction_info *info)
+{
+    if (!info->releases_well_formed)
+        return FB_TRUE;
+    int num_constraints = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        num_constraints += la_get_num_nodes(automata[aut]) * info->max_lock;
+    fb_node *constraints = (fb_node *)malloc(((bound - first + 1) * num_constraints + 1) * sizeof(fb_node));
+    int count = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        for (int node = 0; node < num_nodes; node++)
+            for (int lock = 1; lock <= info->max_lock; lock++)
             {
-                if (!la_is_edge(automata[automaton], source, source))
-                    continue;
-                if (la_get_edge_action(automata[automaton], source, source) != action_taken)
+                if (!la_must_hold(info->locksets[aut], node, lock) || !lock_is_tracked(info, lock))
                     continue;
-                Z3_ast var_source = variable_node_on_path(ctx, automaton, source, step);
-                Z3_ast var_target = variable_node_on_path(ctx, automaton, source, step + 1);
-                if (value_of_var_in_model(ctx, model, var_source) && value_of_var_in_model(ctx, model, var_target))
-                {
-                    path[step] = la_step_create(automaton, source, source, action_taken);
-                    goto Next_step;
-                }
+                for (int step = first; step <= bound; step++)
+                    if (node_reachable_at_step(info, aut, node, step))
+                        constraints[count++] = fb_implies(builder, variable_node_on_path(builder, aut, node, step), held_by_formula(builder, info, lock, aut, step));
             }
+    }
+    fb_node result = fb_and(builder, count, constraints);
+    free(constraints);
+    return result;
+}
+
+/**
+ * @brief Creates the formula stating that if the edge (@p source, @p target) of automaton @p aut is taken at step @p step, the automaton goes from @p source to @p target and its action is possible and performed on the locks.
+ * The condition on the lock is omitted when the edge can never be blocked (see la_is_edge_never_blocked). With an encoding of the owners, an acquisition makes the automaton the owner of the lock.
+ *
+ * @param builder The formula builder.
+ * @param automaton The LockAutomaton.
+ * @param aut The number of the automaton.
+ * @param source
+ * @param target
+ * @param step
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_move_constraint(FormulaBuilder builder, LockAutomaton automaton, int aut, int source, int target, int step, reduction_info *info)
+{
+    int action = la_get_edge_action(automaton, source, target);
+    fb_node effect[4];
+    int size = 0;
+    effect[size++] = variable_node_on_path(builder, aut, source, step);
+    effect[size++] = variable_node_on_path(builder, aut, target, step + 1);
+    if (action != 0 && lock_is_tracked(info, abs(action)))
+    {
+        fb_node held = lock_at_step_formula(builder, info, abs(action), step);
+        if (!la_is_edge_never_blocked(automaton, info->locksets[aut], source, target, info->releases_well_formed))
+            effect[size++] = action > 0 ? fb_not(held) : held;
+        effect[size++] = action > 0 ? held_by_formula(builder, info, action, aut, step + 1) : fb_not(lock_at_step_formula(builder, info, -action, step + 1));
+    }
+    return fb_implies(builder, variable_move_at_step(builder, aut, source, target, step), fb_and(builder, size, effect));
+}
+
+/**
+ * @brief Creates the formula stating how automaton @p aut behaves between step @p step and @p step + 1: it moves if and only if it takes one of its edges (which must be possible), and stays in its node otherwise.
+ * At most one edge is taken, since the automaton is in exactly one node at each step. Edges whose source cannot be reached at step @p step get no variable.
+ *
+ * @param builder The formula builder.
+ * @param automaton The LockAutomaton.
+ * @param aut The number of the automaton.
+ * @param step
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_automaton_transition(FormulaBuilder builder, LockAutomaton automaton, int aut, int step, reduction_info *info)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int num_edges = la_get_num_edges(automaton);
+    fb_node moves[num_edges + 1];
+    fb_node constraints[num_edges + 2];
+    int count = 0;
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target) || !node_reachable_at_step(info, aut, source, step))
+                continue;
+            moves[count] = variable_move_at_step(builder, aut, source, target, step);
+            constraints[count] = generate_move_constraint(builder, automaton, aut, source, target, step, info);
+            count++;
         }
-    Next_step:
+    fb_node moving = variable_automaton_moves(builder, aut, step);
+    fb_node stays[num_nodes];
+    int num_stays = 0;
+    for (int node = 0; node < num_nodes; node++)
+        if (node_reachable_at_step(info, aut, node, step + 1))
+            stays[num_stays++] = fb_iff(builder, node_on_path_formula(builder, info, aut, node, step), variable_node_on_path(builder, aut, node, step + 1));
+    constraints[count] = fb_iff(builder, moving, fb_or(builder, count, moves));
+    constraints[count + 1] = fb_or(builder, 2, (fb_node[]){moving, fb_and(builder, num_stays, stays)});
+    return fb_and(builder, count + 2, constraints);
+}
+
+/**
+ * @brief Collects the move variables of step @p step whose action acts on @p lock.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param lock A lock.
+ * @param step
+ * @param info The static analyses of the automata.
+ * @param moves An array receiving the variables (of size at least the total number of edges).
+ * @return int The number of variables collected.
+ */
+int collect_moves_on_lock(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int lock, int step, reduction_info *info, fb_node *moves)
+{
+    int count = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        for (int source = 0; source < num_nodes; source++)
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automata[aut], source, target) && abs(la_get_edge_action(automata[aut], source, target)) == lock && node_reachable_at_step(info, aut, source, step))
+                    moves[count++] = variable_move_at_step(builder, aut, source, target, step);
     }
+    return count;
 }
 
-void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, int bound)
+/**
+ * @brief Creates the formula stating that, between steps @p first and @p bound, a lock (or its owner) only changes between two steps when a move acting on it is taken. These frame axioms are only generated for the locks some transition acquires: the others are constant and get no variable.
+ * With @p parallel, also states that at most one move acts on each lock at each step, so that moves of a same step are independent.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param first The first step constrained.
+ * @param bound The number of steps.
+ * @param parallel Whether several automata may move at the same step.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_lock_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int first, int bound, bool parallel, reduction_info *info)
 {
-    int max_lock = 0;
+    int max_lock = info->max_lock;
+    int num_edges = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        num_edges += la_get_num_edges(automata[aut]);
+
+    fb_node constraints[2 * (bound - first) * max_lock + 1];
+    int count = 0;
+    for (int step = first; step < bound; step++)
+        for (int lock = 1; lock <= max_lock; lock++)
+        {
+            if (info->constant_lock[lock] || !lock_is_tracked(info, lock))
+                continue;
+            fb_node reasons[num_edges + 1];
+            int num_moves = collect_moves_on_lock(builder, automata, num_automata, lock, step, info, reasons + 1);
+            reasons[0] = lock_unchanged_formula(builder, info, lock, step);
+            constraints[count++] = fb_or(builder, num_moves + 1, reasons);
+            if (parallel)
+                constraints[count++] = card_at_most_one(builder, num_moves, reasons + 1, CARD_AUTO);
+        }
+    return fb_and(builder, count, constraints);
+}
+
+/**
+ * @brief Creates the formula stating which automata move at step @p step: exactly one in the interleaving semantics, at least one if @p parallel.
+ *
+ * @param builder The formula builder.
+ * @param num_automata The number of automata.
+ * @param step
+ * @param parallel Whether several automata may move at the same step.
+ * @return fb_node
+ */
+fb_node generate_scheduling_constraints(FormulaBuilder builder, int num_automata, int step, bool parallel)
+{
+    fb_node moving[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+        moving[aut] = variable_automaton_moves(builder, aut, step);
+    if (parallel)
+        return fb_or(builder, num_automata, moving);
+    return card_exactly_one(builder, num_automata, moving, CARD_AUTO);
+}
+
+/**
+ * @brief Creates the formula stating that the execution goes from step @p step to step @p step + 1.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param step
+ * @param parallel Whether several automata may move at the same step.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_transition_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int step, bool parallel, reduction_info *info)
+{
+    fb_node constraints[num_automata + 1];
+    for (int aut = 0; aut < num_automata; aut++)
+        constraints[aut] = generate_automaton_transition(builder, automata[aut], aut, step, info);
+    constraints[num_automata] = generate_scheduling_constraints(builder, num_automata, step, parallel);
+    return fb_and(builder, num_automata + 1, constraints);
+}
+
+/**
+ * @brief Creates the formula stating that the edge (@p source, @p target) of automaton @p aut is impossible at step @p step (false if it can never be blocked, see la_is_edge_never_blocked).
+ *
+ * @param builder The formula builder.
+ * @param automaton The LockAutomaton.
+ * @param aut The number of the automaton.
+ * @param source
+ * @param target
+ * @param step
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node edge_blocked_formula(FormulaBuilder builder, LockAutomaton automaton, int aut, int source, int target, int step, reduction_info *info)
+{
+    if (la_is_edge_never_blocked(automaton, info->locksets[aut], source, target, info->releases_well_formed))
+        return FB_FALSE;
+    int action = la_get_edge_action(automaton, source, target);
+    fb_node held = lock_at_step_formula(builder, info, abs(action), step);
+    return action > 0 ? held : fb_not(held);
+}
+
+/**
+ * @brief Creates the formula stating that at step @p bound, no automaton can move: every edge leaving the current node of every automaton has an impossible action.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param info The static analyses of the automata.
+ * @return fb_node
+ */
+fb_node generate_deadlock_constraints(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int bound, reduction_info *info)
+{
+    fb_node constraints[num_automata];
     for (int aut = 0; aut < num_automata; aut++)
     {
-        int aux = la_get_max_lock(automata[aut]);
-        if (max_lock < aux)
-            max_lock = aux;
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        fb_node node_blocked[num_nodes];
+        int num_blocked = 0;
+        for (int source = 0; source < num_nodes; source++)
+        {
+            if (!node_reachable_at_step(info, aut, source, bound))
+                continue;
+            if (la_is_node_never_deadlocked(automata[aut], info->locksets[aut], source, info->releases_well_formed))
+            {
+                node_blocked[num_blocked++] = fb_not(variable_node_on_path(builder, aut, source, bound));
+                continue;
+            }
+            fb_node edges_blocked[num_nodes];
+            int count = 0;
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automata[aut], source, target))
+                    edges_blocked[count++] = edge_blocked_formula(builder, automata[aut], aut, source, target, bound, info);
+            node_blocked[num_blocked++] = fb_implies(builder, variable_node_on_path(builder, aut, source, bound), fb_and(builder, count, edges_blocked));
+        }
+        constraints[aut] = fb_and(builder, num_blocked, node_blocked);
     }
+    return fb_and(builder, num_automata, constraints);
+}
+
+/**
+ * @brief Generates the formula of a deadlock after @p bound steps, in the interleaving semantics or in the ∃-step semantics if @p parallel.
+ *
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param parallel Whether several automata may move at the same step.
+ * @param encoding How the state of the locks is encoded.
+ * @param tracked_lock For each lock, whether it is tracked (see lock_is_tracked). NULL to track all locks.
+ * @return fb_node
+ */
+fb_node generate_deadlock_formula(FormulaBuilder builder, LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding, const bool *tracked_lock)
+{
+    reduction_info *info = compute_reduction_info(automata, num_automata, encoding);
+    info->tracked_lock = tracked_lock;
+    fb_node constraints[bound + 6];
+    constraints[0] = generate_initial_constraints(builder, automata, num_automata, info);
+    constraints[1] = generate_state_constraints(builder, automata, num_automata, 0, bound, info);
+    constraints[2] = generate_lock_constraints(builder, automata, num_automata, 0, bound, parallel, info);
+    constraints[3] = generate_deadlock_constraints(builder, automata, num_automata, bound, info);
+    constraints[4] = generate_lockset_constraints(builder, automata, num_automata, 0, bound, info);
+    constraints[5] = generate_owner_constraints(builder, automata, num_automata, bound, info);
+    for (int step = 0; step < bound; step++)
+        constraints[6 + step] = generate_transition_constraints(builder, automata, num_automata, step, parallel, info);
+    delete_reduction_info(info);
+    return fb_and(builder, bound + 6, constraints);
+}
+
+/**
+ * @brief Builds the formula of generate_deadlock_formula in a fresh builder and lowers it to Z3 once.
+ *
+ * @param ctx The solver context.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param bound The number of steps.
+ * @param parallel Whether several automata may move at the same step.
+ * @param encoding How the state of the locks is encoded.
+ * @param tracked_lock For each lock, whether it is tracked (see lock_is_tracked). NULL to track all locks.
+ * @return Z3_ast The formula, holding one reference if @p ctx counts them (see keep_formula).
+ */
+Z3_ast lower_deadlock_formula(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding, const bool *tracked_lock)
+{
+    FormulaBuilder builder = fb_create();
+    fb_node root = generate_deadlock_formula(builder, automata, num_automata, bound, parallel, encoding, tracked_lock);
+    Z3_ast formula = keep_formula(ctx, fb_to_z3(builder, ctx, root));
+    fb_delete(builder);
+    return formula;
+}
+
+Z3_ast deadlock_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound)
+{
+    return lower_deadlock_formula(ctx, automata, num_automata, bound, false, LOCK_ENCODING_TAKEN, NULL);
+}
+
+Z3_ast deadlock_parallel_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound)
+{
+    return lower_deadlock_formula(ctx, automata, num_automata, bound, true, LOCK_ENCODING_TAKEN, NULL);
+}
+
+Z3_ast deadlock_encoded_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding)
+{
+    return lower_deadlock_formula(ctx, automata, num_automata, bound, parallel, encoding, NULL);
+}
+
+Z3_ast deadlock_abstract_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound, const bool *tracked_lock)
+{
+    return lower_deadlock_formula(ctx, automata, num_automata, bound, false, LOCK_ENCODING_TAKEN, tracked_lock);
+}
+
+long deadlock_reduction_dimacs(LockAutomaton *automata, int num_automata, int bound, bool parallel, lock_encoding encoding, FILE *file)
+{
+    FormulaBuilder builder = fb_create();
+    fb_node root = generate_deadlock_formula(builder, automata, num_automata, bound, parallel, encoding, NULL);
+    long num_clauses = fb_write_dimacs(builder, root, file);
+    fb_delete(builder);
+    return num_clauses;
+}
+
+/**
+ * @brief Looks for the edge taken by automaton @p aut at step @p frame in @p model.
+ *
+ * @param ctx The solver context.
+ * @param model A variable assignment.
+ * @param builder The formula builder naming the variables.
+ * @param automaton The LockAutomaton.
+ * @param aut The number of the automaton.
+ * @param frame The step considered.
+ * @param info The static analyses of the automata.
+ * @param move Receives the edge taken, if any.
+ * @return true if @p aut moves at step @p frame.
+ * @return false otherwise.
+ */
+bool move_from_model(Z3_context ctx, Z3_model model, FormulaBuilder builder, LockAutomaton automaton, int aut, int frame, reduction_info *info, step *move)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target) || !node_reachable_at_step(info, aut, source, frame))
+                continue;
+            if (!value_of_var_in_model(ctx, model, fb_to_z3(builder, ctx, variable_move_at_step(builder, aut, source, target, frame))))
+                continue;
+            *move = la_step_create(aut, source, target, la_get_edge_action(automaton, source, target));
+            return true;
+        }
+    return false;
+}
+
+int la_parallel_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, step *path, int bound)
+{
+    reduction_info *info = compute_reduction_info(automata, num_automata, LOCK_ENCODING_TAKEN);
+    FormulaBuilder builder = fb_create();
+    int size_path = 0;
+    for (int frame = 0; frame < bound; frame++)
+        for (int aut = 0; aut < num_automata; aut++)
+            if (move_from_model(ctx, model, builder, automata[aut], aut, frame, info, &path[size_path]))
+                size_path++;
+    fb_delete(builder);
+    delete_reduction_info(info);
+    return size_path;
+}
+
+void la_path_from_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, step *path, int bound)
+{
+    la_parallel_path_from_model(ctx, model, automata, num_automata, path, bound);
+}
+
+void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int num_automata, int bound, lock_encoding encoding)
+{
+    reduction_info *info = compute_reduction_info(automata, num_automata, encoding);
+    FormulaBuilder builder = fb_create();
+    int max_lock = info->max_lock;
     printf("Information deduced from the model of the formula:\n\n");
     for (int step = 0; step <= bound; step++)
     {
@@ -126,8 +860,14 @@ void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int
         printf("Locks taken:\n");
         for (int lock = 1; lock <= max_lock; lock++)
         {
-            if (value_of_var_in_model(ctx, model, variable_lock_at_step(ctx, lock, step)))
-                printf("%d ", lock);
+            if (!value_of_var_in_model(ctx, model, fb_to_z3(builder, ctx, lock_at_step_formula(builder, info, lock, step))))
+                continue;
+            printf("%d", lock);
+            if (encoding != LOCK_ENCODING_TAKEN)
+                for (int owner = 0; owner < info->num_owners[lock]; owner++)
+                    if (value_of_var_in_model(ctx, model, fb_to_z3(builder, ctx, owner_code_formula(builder, info, lock, step, owner + 1))))
+                        printf("(%s)", la_get_name(automata[info->owners[lock][owner]]));
+            printf(" ");
         }
         printf("\n");
         for (int aut = 0; aut < num_automata; aut++)
@@ -136,119 +876,185 @@ void la_print_model(Z3_context ctx, Z3_model model, LockAutomaton *automata, int
             printf("Automaton %s(%d) is in state : ", la_get_name(automata[aut]), aut);
             for (int node = 0; node < num_nodes; node++)
             {
-                if (value_of_var_in_model(ctx, model, variable_node_on_path(ctx, aut, node, step)))
+                if (node_reachable_at_step(info, aut, node, step) && value_of_var_in_model(ctx, model, fb_to_z3(builder, ctx, variable_node_on_path(builder, aut, node, step))))
                     printf("%s ", la_get_node_name(automata[aut], node));
             }
             printf("\n");
         }
     }
+    fb_delete(builder);
+    delete_reduction_info(info);
 }
 
-Z3_ast generate_state_constraints(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound) {
-    Z3_ast constraints[num_automata][bound + 1];
-    for (int aut = 0; aut < num_automata; aut++) {
-        int num_nodes = la_get_num_nodes(automata[aut]);
-        for (int step = 0; step <= bound; step++) {
-            Z3_ast node_vars[num_nodes];
-            for (int node = 0; node < num_nodes; node++) {
-                node_vars[node] = variable_node_on_path(ctx, aut, node, step);
-            }
-            // Automaton must be in one of its nodes
-            constraints[aut][step] = Z3_mk_or(ctx, num_nodes, node_vars);
-
-            // No two nodes simultaneously
-            for (int i = 0; i < num_nodes; i++) {
-                for (int j = i + 1; j < num_nodes; j++) {
-                    Z3_ast not_both = Z3_mk_not(ctx, Z3_mk_and(ctx, 2, (Z3_ast[]){ node_vars[i], node_vars[j] }));
-                    constraints[aut][step] = Z3_mk_and(ctx, 2, (Z3_ast[]){ constraints[aut][step], not_both });
-                }
-            }
-        }
-    }
-
-    Z3_ast all_constraints[num_automata * (bound + 1)];
-    for (int aut = 0; aut < num_automata; aut++) {
-        for (int step = 0; step <= bound; step++) {
-            all_constraints[aut * (bound + 1) + step] = constraints[aut][step];
-        }
-    }
+/**
+ * @brief Creates a formula containing only the variable representing that the transitions of step @p step are enforced (incremental search of deadlock_minimal_length).
+ *
+ * @param builder The formula builder.
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_step_active(FormulaBuilder builder, int step)
+{
+    char name[40];
+    snprintf(name, 40, "step %d: active", step);
+    return fb_var(builder, name);
+}
 
-    return Z3_mk_and(ctx, num_automata * (bound + 1), all_constraints);
+/**
+ * @brief Creates a formula containing only the variable representing that the execution is deadlocked at step @p step (incremental search of deadlock_minimal_length).
+ *
+ * @param builder The formula builder.
+ * @param step
+ * @return fb_node
+ */
+fb_node variable_deadlock_at_step(FormulaBuilder builder, int step)
+{
+    char name[40];
+    snprintf(name, 40, "step %d: deadlock", step);
+    return fb_var(builder, name);
 }
 
-Z3_ast generate_lock_constraints(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound) {
-    // Determine the maximum number of locks across all automata
-    int max_locks = 0;
-    for (int i = 0; i < num_automata; i++) {
-        int locks = la_get_max_lock(automata[i]); // Assumes `la_get_max_lock` is defined
-        if (locks > max_locks) max_locks = locks;
+/**
+ * @brief Adds to @p solver the steps from @p first to @p last of the incremental search of deadlock_minimal_length.
+ * The transitions of each step are only enforced if its step variable (see variable_step_active) is true, and the deadlock at a step only if its deadlock variable (see variable_deadlock_at_step) is: a deadlock at a step enforces the transitions of all the previous steps, and leaves the next ones free.
+ * The constraints are built in @p builder, so that the parts shared with the steps already added are lowered only once.
+ *
+ * @param ctx The solver context.
+ * @param solver The incremental solver.
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param first The first step added.
+ * @param last The last step added.
+ * @param info The static analyses of the automata.
+ */
+void add_incremental_steps(Z3_context ctx, Z3_solver solver, FormulaBuilder builder, LockAutomaton *automata, int num_automata, int first, int last, reduction_info *info)
+{
+    int max_constraints = 3 + 4 * (last - first + 1);
+    fb_node constraints[max_constraints];
+    int count = 0;
+    constraints[count++] = generate_state_constraints(builder, automata, num_automata, first, last, info);
+    constraints[count++] = generate_lockset_constraints(builder, automata, num_automata, first, last, info);
+    if (first > 0)
+        constraints[count++] = generate_lock_constraints(builder, automata, num_automata, first - 1, last, false, info);
+    for (int step = first; step <= last; step++)
+    {
+        fb_node deadlock = variable_deadlock_at_step(builder, step);
+        constraints[count++] = fb_implies(builder, deadlock, generate_deadlock_constraints(builder, automata, num_automata, step, info));
+        if (step == 0)
+            continue;
+        fb_node active = variable_step_active(builder, step - 1);
+        constraints[count++] = fb_implies(builder, active, generate_transition_constraints(builder, automata, num_automata, step - 1, false, info));
+        constraints[count++] = fb_implies(builder, deadlock, active);
+        if (step > 1)
+            constraints[count++] = fb_implies(builder, active, variable_step_active(builder, step - 2));
     }
+    Z3_solver_assert(ctx, solver, fb_to_z3(builder, ctx, fb_and(builder, count, constraints)));
+}
 
-    Z3_ast constraints[bound];
-    for (int step = 0; step < bound; step++) {
-        Z3_ast lock_constraints[max_locks];
-        for (int lock = 1; lock <= max_locks; lock++) {
-            Z3_ast lock_var = variable_lock_at_step(ctx, lock, step);
-            Z3_ast lock_next_var = variable_lock_at_step(ctx, lock, step + 1);
-
-            // Lock acquisition/release consistency
-            lock_constraints[lock - 1] = Z3_mk_implies(ctx, lock_var, lock_next_var);
-        }
-        constraints[step] = Z3_mk_and(ctx, max_locks, lock_constraints);
+/**
+ * @brief Asks @p solver whether a deadlock is reachable in at most @p bound steps, adding the missing steps first. If so, @p path receives a shortest deadlock of the model.
+ *
+ * @param ctx The solver context.
+ * @param solver The incremental solver.
+ * @param builder The formula builder.
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param info The static analyses of the automata.
+ * @param built The last step added to @p solver. Updated.
+ * @param bound The bound probed.
+ * @param path An array of size at least @p bound.
+ * @param length Receives the length of the deadlock found, if any.
+ * @param probe Receives the bound, result and solving time of the probe.
+ * @return Z3_lbool The result of the solver.
+ */
+Z3_lbool probe_bound(Z3_context ctx, Z3_solver solver, FormulaBuilder builder, LockAutomaton *automata, int num_automata, reduction_info *info, int *built, int bound, step *path, int *length, bound_probe *probe)
+{
+    if (bound > *built)
+    {
+        add_incremental_steps(ctx, solver, builder, automata, num_automata, *built + 1, bound, info);
+        *built = bound;
     }
+    char name[40];
+    snprintf(name, 40, "deadlock within %d steps", bound);
+    fb_node within = fb_var(builder, name);
+    fb_node deadlocks[bound + 1];
+    for (int step = 0; step <= bound; step++)
+        deadlocks[step] = variable_deadlock_at_step(builder, step);
+    Z3_solver_assert(ctx, solver, fb_to_z3(builder, ctx, fb_implies(builder, within, fb_or(builder, bound + 1, deadlocks))));
 
-    return Z3_mk_and(ctx, bound, constraints);
-}
+    Z3_ast assumption = fb_to_z3(builder, ctx, within);
+    clock_t start = clock();
+    Z3_lbool result = Z3_solver_check_assumptions(ctx, solver, 1, &assumption);
+    probe->bound = bound;
+    probe->result = result;
+    probe->seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (result != Z3_L_TRUE)
+        return result;
 
-int la_get_trying_node(LockAutomaton automaton) {
-    int num_nodes = la_get_num_nodes(automaton); // Total number of nodes
-    for (int i = 0; i < num_nodes; i++) {
-        const char *node_name = la_get_node_name(automaton, i);
-        if (strstr(node_name, "Trying") != NULL) { // Check if "Trying" is part of the name
-            return i; // Return the index of the "Trying" node
-        }
-    }
-    return -1; // Return -1 if no "Trying" node is found
+    Z3_model model = Z3_solver_get_model(ctx, solver);
+    Z3_model_inc_ref(ctx, model);
+    *length = 0;
+    while (!value_of_var_in_model(ctx, model, fb_to_z3(builder, ctx, deadlocks[*length])))
+        (*length)++;
+    for (int frame = 0; frame < *length; frame++)
+        for (int aut = 0; aut < num_automata; aut++)
+            move_from_model(ctx, model, builder, automata[aut], aut, frame, info, &path[frame]);
+    Z3_model_dec_ref(ctx, model);
+    return result;
 }
 
+Z3_lbool deadlock_minimal_length(Z3_context ctx, LockAutomaton *automata, int num_automata, int max_bound, step *path, int *length, bound_probe **probes, int *num_probes)
+{
+    reduction_info *info = compute_reduction_info(automata, num_automata, LOCK_ENCODING_TAKEN);
+    FormulaBuilder builder = fb_create();
+    Z3_solver solver = pooled_solver(ctx);
+    Z3_solver_assert(ctx, solver, fb_to_z3(builder, ctx, generate_initial_constraints(builder, automata, num_automata, info)));
+    add_incremental_steps(ctx, solver, builder, automata, num_automata, 0, 0, info);
+    int built = 0;
 
+    // Galloping, then binary search: at most two probes per bit of max_bound, plus two.
+    int capacity = 2;
+    for (int rest = max_bound; rest > 0; rest >>= 1)
+        capacity += 2;
+    *probes = (bound_probe *)malloc(capacity * sizeof(bound_probe));
+    *num_probes = 0;
+    *length = -1;
 
-
-Z3_ast generate_deadlock_constraints(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound) {
-    Z3_ast deadlock_conditions[num_automata];
-    for (int aut = 0; aut < num_automata; aut++) {
-        int trying_node = la_get_trying_node(automata[aut]);
-        if (trying_node == -1) {
-            fprintf(stderr, "Error: No 'Trying' node found for automaton %d\n", aut);
-            exit(EXIT_FAILURE);
+    // No deadlock within lower steps, a deadlock of higher steps.
+    int lower = -1;
+    int higher = -1;
+    int bound = max_bound < 1 ? max_bound : 1;
+    Z3_lbool result = Z3_L_FALSE;
+    while (higher == -1)
+    {
+        result = probe_bound(ctx, solver, builder, automata, num_automata, info, &built, bound, path, &higher, &(*probes)[(*num_probes)++]);
+        if (result == Z3_L_UNDEF || (result == Z3_L_FALSE && bound == max_bound))
+            break;
+        if (result == Z3_L_FALSE)
+        {
+            lower = bound;
+            bound = 2 * bound > max_bound ? max_bound : 2 * bound;
         }
-        deadlock_conditions[aut] = variable_node_on_path(ctx, aut, trying_node, bound);
     }
-
-    Z3_ast all_deadlocked = Z3_mk_and(ctx, num_automata, deadlock_conditions);
-
-    // No transitions possible at the last step
-    int max_locks = 0;
-    for (int aut = 0; aut < num_automata; aut++) {
-        int locks = la_get_max_lock(automata[aut]);
-        if (locks > max_locks) max_locks = locks;
+    while (result != Z3_L_UNDEF && higher != -1 && higher - lower > 1)
+    {
+        int found;
+        bound = lower + (higher - lower) / 2;
+        result = probe_bound(ctx, solver, builder, automata, num_automata, info, &built, bound, path, &found, &(*probes)[(*num_probes)++]);
+        if (result == Z3_L_TRUE)
+            higher = found;
+        else if (result == Z3_L_FALSE)
+            lower = bound;
     }
-
-    Z3_ast no_transitions[max_locks];
-    for (int lock = 0; lock < max_locks; lock++) {
-        no_transitions[lock] = Z3_mk_not(ctx, variable_lock_at_step(ctx, lock + 1, bound));
+    if (result != Z3_L_UNDEF && higher != -1)
+    {
+        result = Z3_L_TRUE;
+        *length = higher;
     }
-    Z3_ast no_transition_possible = Z3_mk_and(ctx, max_locks, no_transitions);
-
-    return Z3_mk_and(ctx, 2, (Z3_ast[]){ all_deadlocked, no_transition_possible });
-}
-
-
-Z3_ast deadlock_reduction(Z3_context ctx, LockAutomaton *automata, int num_automata, int bound) {
-    Z3_ast state_constraints = generate_state_constraints(ctx, automata, num_automata, bound);
-    Z3_ast lock_constraints = generate_lock_constraints(ctx, automata, num_automata, bound);
-    Z3_ast deadlock_constraints = generate_deadlock_constraints(ctx, automata, num_automata, bound);
 
-    Z3_ast all_constraints[] = { state_constraints, lock_constraints, deadlock_constraints };
-    return Z3_mk_and(ctx, 3, all_constraints);
+    Z3_solver_dec_ref(ctx, solver);
+    fb_delete(builder);
+    delete_reduction_info(info);
+    return result;
 }
@@ -1,15 +1,127 @@
 #include "DeadlockResolution.h"
+#include "LockProduct.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-/*
-You'll need subfunction here.
-It is advised to make at least one recursive subfunction whose role is to explore all possible paths (valid), and one that is charged to verify that a given path of size bound cannot be extended.
-You could call the last one 'verifier', but that is a slight abuse: as thus we should consider every possible step array, even those which are not real execution.
-To optimize, you should ensure that the 'verifier' only gets real executions (said otherwise, it doesn't verify everything) -- you'll thus get a way more efficient algorithm.
-*/
+/**
+ * @brief The data shared by the recursive calls of the brute force algorithm.
+ */
+typedef struct
+{
+    LockProduct product;   ///< The product of the automata.
+    int bound;             ///< The size of the deadlock searched for.
+    int **to_stuck;        ///< For each automaton, the minimal number of moves from each node to a node where it may get stuck (-1 if there is none).
+    StateSet failed;       ///< The pairs (state, depth) already explored without finding a deadlock.
+    step *moves;           ///< Room for the moves enabled at each depth (bound * lp_max_moves).
+} brute_force_search;
+
+/**
+ * @brief Computes the distances to nodes where each automaton may get stuck (see la_distances_to_stuck_nodes), using the lockset analysis of every automaton.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @return int** An array of @p num_automata arrays of distances.
+ */
+int **compute_distances_to_stuck(LockAutomaton *automata, int num_automata)
+{
+    LockSets sets[num_automata];
+    bool releases_well_formed = true;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        sets[aut] = la_compute_locksets(automata[aut]);
+        if (!la_releases_only_held_locks(automata[aut], sets[aut]))
+            releases_well_formed = false;
+    }
+    int **distances = (int **)malloc(num_automata * sizeof(int *));
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        distances[aut] = (int *)malloc(la_get_num_nodes(automata[aut]) * sizeof(int));
+        la_distances_to_stuck_nodes(automata[aut], sets[aut], releases_well_formed, distances[aut]);
+        la_delete_locksets(sets[aut]);
+    }
+    return distances;
+}
+
+/**
+ * @brief Tells if a deadlock may still be reached in exactly @p remaining moves from @p state: every automaton must reach a node where it may get stuck, and moves being interleaved, this takes at least the sum of their distances to such nodes.
+ *
+ * @param search The search data.
+ * @param state The current state.
+ * @param remaining The number of moves left.
+ * @return true if a deadlock is not excluded.
+ * @return false otherwise.
+ */
+bool deadlock_still_possible(brute_force_search *search, const unsigned *state, int remaining)
+{
+    int needed = 0;
+    for (int aut = 0; aut < lp_get_num_automata(search->product); aut++)
+    {
+        int distance = search->to_stuck[aut][lp_get_node(search->product, state, aut)];
+        if (distance == -1)
+            return false;
+        needed += distance;
+    }
+    return needed <= remaining;
+}
+
+/**
+ * @brief Explores every execution of size @p bound extending the one leading to @p state, and stops at the first one ending in a deadlock.
+ *
+ * @param search The search data.
+ * @param state The current state (modified during the exploration, restored afterwards).
+ * @param depth The number of moves leading to @p state.
+ * @param path The moves leading to @p state, extended to a path leading to a deadlock if one is found.
+ * @return true if a deadlock is reached after exactly @p bound moves.
+ * @return false otherwise.
+ */
+bool explore_executions(brute_force_search *search, unsigned *state, int depth, step *path)
+{
+    if (depth == search->bound)
+        return lp_is_deadlock(search->product, state);
+    if (!deadlock_still_possible(search, state, search->bound - depth))
+        return false;
+
+    int size = lp_state_size(search->product);
+    unsigned key[size + 1];
+    memcpy(key, state, size * sizeof(unsigned));
+    key[size] = depth;
+    if (lp_set_contains(search->failed, key))
+        return false;
+
+    step *moves = search->moves + depth * lp_max_moves(search->product);
+    int num_moves = lp_enabled_moves(search->product, state, moves);
+    for (int i = 0; i < num_moves; i++)
+    {
+        lp_apply(search->product, state, moves[i]);
+        path[depth] = moves[i];
+        bool found = explore_executions(search, state, depth + 1, path);
+        lp_undo(search->product, state, moves[i]);
+        if (found)
+            return true;
+    }
+    lp_set_insert(search->failed, key);
+    return false;
+}
 
 bool deadlock_brute_force(LockAutomaton *automata, int num_automata, int bound, step *path)
 {
-  return false;
-}
\ No newline at end of file
+    brute_force_search search;
+    search.product = lp_initialize(automata, num_automata);
+    search.bound = bound;
+    search.to_stuck = compute_distances_to_stuck(automata, num_automata);
+    search.failed = lp_set_create(lp_state_size(search.product) + 1);
+    search.moves = (step *)malloc((bound * lp_max_moves(search.product) + 1) * sizeof(step));
+
+    unsigned state[lp_state_size(search.product)];
+    lp_initial_state(search.product, state);
+    bool res = explore_executions(&search, state, 0, path);
+
+    free(search.moves);
+    lp_set_delete(search.failed);
+    for (int aut = 0; aut < num_automata; aut++)
+        free(search.to_stuck[aut]);
+    free(search.to_stuck);
+    lp_delete(search.product);
+    return res;
+}
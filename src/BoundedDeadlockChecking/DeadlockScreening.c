@@ -0,0 +1,243 @@
+#include "DeadlockScreening.h"
+#include "DeadlockExplicit.h"
+#include "DeadlockIC3.h"
+#include "Z3Tools.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief The work shared by the threads checking the subsets of a given size.
+ */
+typedef struct
+{
+    LockAutomaton *automata;  ///< The LockAutomata considered.
+    screening_engine engine;  ///< The engine used for each check.
+    int size;                 ///< The size of the subsets.
+    int *subsets;             ///< The subsets to check (num_subsets * size automaton numbers, in increasing order).
+    long num_subsets;         ///< The number of subsets.
+    long next;                ///< The next subset to check.
+    long best;                ///< The first deadlocking subset found (num_subsets if none).
+    step *best_path;          ///< The path leading to its deadlock.
+    int best_size;            ///< The size of that path.
+    pthread_mutex_t mutex;    ///< Protects the fields above.
+} screening_pool;
+
+/**
+ * @brief Checks whether a deadlock is reachable in the product of @p automata with @p engine. IC3 runs in the pooled context of the calling thread (see pooled_context), reset afterwards.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param engine The engine used.
+ * @param path Receives the path found (see deadlock_explicit_search).
+ * @param size_path Receives its size.
+ * @return Z3_lbool
+ */
+Z3_lbool screening_check(LockAutomaton *automata, int num_automata, screening_engine engine, step **path, int *size_path)
+{
+    if (engine == SCREENING_EXPLICIT)
+        return deadlock_explicit_search(automata, num_automata, path, size_path, NULL) ? Z3_L_TRUE : Z3_L_FALSE;
+    Z3_lbool res = deadlock_ic3(pooled_context(), automata, num_automata, path, size_path, false);
+    reset_pool();
+    return res;
+}
+
+/**
+ * @brief Body of the threads: checks subsets until there is none left, or until every subset left comes after a deadlocking one.
+ *
+ * @param data The screening_pool.
+ * @return void* NULL.
+ */
+void *screening_worker(void *data)
+{
+    screening_pool *pool = (screening_pool *)data;
+    while (true)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        long index = pool->next++;
+        bool stop = index >= pool->num_subsets || index > pool->best;
+        pthread_mutex_unlock(&pool->mutex);
+        if (stop)
+            break;
+
+        int *members = pool->subsets + index * pool->size;
+        LockAutomaton chosen[pool->size];
+        for (int i = 0; i < pool->size; i++)
+            chosen[i] = pool->automata[members[i]];
+        step *path;
+        int size_path;
+        Z3_lbool res = screening_check(chosen, pool->size, pool->engine, &path, &size_path);
+        for (int i = 0; i < size_path; i++)
+            path[i].automaton = members[path[i].automaton];
+
+        pthread_mutex_lock(&pool->mutex);
+        if (res == Z3_L_TRUE && index < pool->best)
+        {
+            free(pool->best_path);
+            pool->best = index;
+            pool->best_path = path;
+            pool->best_size = size_path;
+            path = NULL;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+        free(path);
+    }
+    free_pool();
+    return NULL;
+}
+
+/**
+ * @brief Tells if the automata of @p members are connected by shared locks.
+ *
+ * @param shares shares[a * num_automata + b] tells if automata a and b act on a common lock.
+ * @param num_automata The number of automata.
+ * @param members The subset (automaton numbers).
+ * @param size The size of the subset.
+ * @return true
+ * @return false
+ */
+bool screening_is_connected(const bool *shares, int num_automata, const int *members, int size)
+{
+    bool reached[size];
+    int stack[size];
+    int height = 0;
+    for (int i = 0; i < size; i++)
+        reached[i] = false;
+    reached[0] = true;
+    stack[height++] = 0;
+    int count = 1;
+    while (height > 0)
+    {
+        int current = stack[--height];
+        for (int i = 0; i < size; i++)
+            if (!reached[i] && shares[members[current] * num_automata + members[i]])
+            {
+                reached[i] = true;
+                stack[height++] = i;
+                count++;
+            }
+    }
+    return count == size;
+}
+
+/**
+ * @brief Computes which automata share a lock.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param shares Receives the matrix: shares[a * num_automata + b] tells if automata a and b act on a common lock.
+ */
+void screening_compute_sharing(LockAutomaton *automata, int num_automata, bool *shares)
+{
+    int max_lock = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        if (max_lock < la_get_max_lock(automata[aut]))
+            max_lock = la_get_max_lock(automata[aut]);
+    bool *uses = (bool *)calloc(num_automata * (max_lock + 1), sizeof(bool));
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        for (int source = 0; source < num_nodes; source++)
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automata[aut], source, target))
+                    uses[aut * (max_lock + 1) + abs(la_get_edge_action(automata[aut], source, target))] = true;
+    }
+    for (int first = 0; first < num_automata; first++)
+        for (int second = 0; second < num_automata; second++)
+        {
+            shares[first * num_automata + second] = false;
+            for (int lock = 1; lock <= max_lock; lock++)
+                if (uses[first * (max_lock + 1) + lock] && uses[second * (max_lock + 1) + lock])
+                    shares[first * num_automata + second] = true;
+        }
+    free(uses);
+}
+
+/**
+ * @brief Enumerates, in lexicographic order, the subsets of @p size automata connected by shared locks.
+ *
+ * @param shares See screening_compute_sharing.
+ * @param num_automata The number of automata.
+ * @param size The size of the subsets.
+ * @param num_subsets Receives the number of subsets.
+ * @return int* The subsets (*num_subsets * size automaton numbers), newly allocated.
+ */
+int *screening_enumerate_subsets(const bool *shares, int num_automata, int size, long *num_subsets)
+{
+    long capacity = 64;
+    int *subsets = (int *)malloc(capacity * size * sizeof(int));
+    long count = 0;
+    int members[size];
+    for (int i = 0; i < size; i++)
+        members[i] = i;
+    while (true)
+    {
+        if (screening_is_connected(shares, num_automata, members, size))
+        {
+            if (count == capacity)
+            {
+                capacity *= 2;
+                subsets = (int *)realloc(subsets, capacity * size * sizeof(int));
+            }
+            memcpy(subsets + count * size, members, size * sizeof(int));
+            count++;
+        }
+        int i = size - 1;
+        while (i >= 0 && members[i] == num_automata - size + i)
+            i--;
+        if (i < 0)
+            break;
+        members[i]++;
+        for (int j = i + 1; j < size; j++)
+            members[j] = members[j - 1] + 1;
+    }
+    *num_subsets = count;
+    return subsets;
+}
+
+Z3_lbool deadlock_screening(LockAutomaton *automata, int num_automata, int max_subset_size, screening_engine engine, int num_threads, bool *subset, step **path, int *size_path)
+{
+    bool shares[num_automata * num_automata];
+    screening_compute_sharing(automata, num_automata, shares);
+    if (num_threads < 1)
+        num_threads = 1;
+
+    for (int size = 2; size <= max_subset_size && size < num_automata; size++)
+    {
+        screening_pool pool;
+        pool.automata = automata;
+        pool.engine = engine;
+        pool.size = size;
+        pool.subsets = screening_enumerate_subsets(shares, num_automata, size, &pool.num_subsets);
+        pool.next = 0;
+        pool.best = pool.num_subsets;
+        pool.best_path = NULL;
+        pool.best_size = 0;
+        pthread_mutex_init(&pool.mutex, NULL);
+
+        pthread_t threads[num_threads];
+        for (int t = 0; t < num_threads; t++)
+            pthread_create(&threads[t], NULL, screening_worker, &pool);
+        for (int t = 0; t < num_threads; t++)
+            pthread_join(threads[t], NULL);
+        pthread_mutex_destroy(&pool.mutex);
+
+        if (pool.best < pool.num_subsets)
+        {
+            for (int aut = 0; aut < num_automata; aut++)
+                subset[aut] = false;
+            for (int i = 0; i < size; i++)
+                subset[pool.subsets[pool.best * size + i]] = true;
+            *path = pool.best_path;
+            *size_path = pool.best_size;
+            free(pool.subsets);
+            return Z3_L_TRUE;
+        }
+        free(pool.subsets);
+    }
+
+    for (int aut = 0; aut < num_automata; aut++)
+        subset[aut] = true;
+    return screening_check(automata, num_automata, engine, path, size_path);
+}
@@ -0,0 +1,239 @@
+#include "DeadlockSimulation.h"
+#include "LockProduct.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief The base 2 logarithm of the number of bits of the array counting distinct states.
+ */
+#define SIMULATION_LOG_BITS 26
+
+/**
+ * @brief The number of executions a thread runs between two checks of the time limit.
+ */
+#define SIMULATION_BATCH 256
+
+/**
+ * @brief The data shared by the threads of a simulation.
+ */
+typedef struct
+{
+    LockProduct product;   ///< The product of the automata (only read by the threads).
+    int max_depth;         ///< The maximal length of an execution.
+    double deadline;       ///< The time at which the simulation stops.
+    uint64_t seed;         ///< The seed of the simulation.
+    uint64_t *seen;        ///< The bit array of the hashes of the states hit (updated atomically).
+    bool found;            ///< Whether a deadlock was found (the threads then stop).
+    step *path;            ///< The path leading to it.
+    int size_path;         ///< The size of that path.
+    long num_walks;        ///< The number of executions run.
+    long num_steps;        ///< The total number of steps.
+    long distinct_states;  ///< The number of bits set in seen.
+    pthread_mutex_t mutex; ///< Protects the fields from found on.
+} simulation_pool;
+
+/**
+ * @brief The arguments of a thread.
+ */
+typedef struct
+{
+    simulation_pool *pool; ///< The shared data.
+    int thread;            ///< The number of the thread.
+} simulation_thread;
+
+/**
+ * @brief Returns the current time in seconds (monotonic clock).
+ *
+ * @return double
+ */
+double simulation_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Draws the next number of the xorshift64* generator of state @p random.
+ *
+ * @param random The state of the generator (never 0).
+ * @return uint64_t
+ */
+uint64_t simulation_random(uint64_t *random)
+{
+    *random ^= *random >> 12;
+    *random ^= *random << 25;
+    *random ^= *random >> 27;
+    return *random * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Marks @p state as hit in the bit array of @p pool.
+ *
+ * @param pool The shared data.
+ * @param state The state.
+ * @return true if its bit was not set yet.
+ * @return false otherwise.
+ */
+bool simulation_mark(simulation_pool *pool, const unsigned *state)
+{
+    uint64_t bit = lp_hash(state, lp_state_size(pool->product), 0) & (((uint64_t)1 << SIMULATION_LOG_BITS) - 1);
+    uint64_t flag = (uint64_t)1 << (bit % 64);
+    return !(__atomic_fetch_or(&pool->seen[bit / 64], flag, __ATOMIC_RELAXED) & flag);
+}
+
+/**
+ * @brief Runs one execution with a scheduling bias of its own.
+ *
+ * @param pool The shared data.
+ * @param random The generator of the thread.
+ * @param path Room for max_depth steps, receiving the execution.
+ * @param steps Receives the number of steps done.
+ * @param new_states Incremented by the number of states hit for the first time.
+ * @return true if the execution ended in a deadlock.
+ * @return false otherwise.
+ */
+bool simulation_walk(simulation_pool *pool, uint64_t *random, step *path, int *steps, long *new_states)
+{
+    LockProduct product = pool->product;
+    int num_automata = lp_get_num_automata(product);
+    int max_moves = lp_max_moves(product);
+
+    // The swarm configuration of this execution.
+    int weight[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+        weight[aut] = simulation_random(random) % 4 == 0 ? 0 : 1 + simulation_random(random) % 16;
+    int bias = simulation_random(random) % 3; // 0: none, 1: acquisitions preferred, 2: releases preferred.
+    int depth = pool->max_depth - (int)(simulation_random(random) % (pool->max_depth * 3 / 4 + 1));
+
+    unsigned state[lp_state_size(product)];
+    step moves[max_moves + 1];
+    long move_weight[max_moves + 1];
+    lp_initial_state(product, state);
+    for (int length = 0;; length++)
+    {
+        if (simulation_mark(pool, state))
+            (*new_states)++;
+        int num_moves = lp_enabled_moves(product, state, moves);
+        if (num_moves == 0)
+        {
+            *steps = length;
+            return true;
+        }
+        if (length == depth)
+        {
+            *steps = length;
+            return false;
+        }
+        long total = 0;
+        for (int i = 0; i < num_moves; i++)
+        {
+            move_weight[i] = weight[moves[i].automaton];
+            if ((bias == 1 && moves[i].action > 0) || (bias == 2 && moves[i].action < 0))
+                move_weight[i] *= 4;
+            total += move_weight[i];
+        }
+        // Automata of weight 0 only move when no other automaton can.
+        if (total == 0)
+            for (int i = 0; i < num_moves; i++)
+                total += move_weight[i] = 1;
+        long draw = simulation_random(random) % total;
+        int chosen = 0;
+        while (draw >= move_weight[chosen])
+            draw -= move_weight[chosen++];
+        path[length] = moves[chosen];
+        lp_apply(product, state, moves[chosen]);
+    }
+}
+
+/**
+ * @brief Body of the threads: runs executions until a deadlock is found or the time is over.
+ *
+ * @param data The simulation_thread.
+ * @return void* NULL.
+ */
+void *simulation_worker(void *data)
+{
+    simulation_thread *thread = (simulation_thread *)data;
+    simulation_pool *pool = thread->pool;
+    uint64_t random = pool->seed ^ (0x9E3779B97F4A7C15ULL * (thread->thread + 1));
+    if (random == 0)
+        random = 1;
+    step *path = (step *)malloc((pool->max_depth + 1) * sizeof(step));
+    bool stop = false;
+    while (!stop)
+    {
+        long walks = 0, steps = 0, new_states = 0;
+        bool found = false;
+        int size_path = 0;
+        while (walks < SIMULATION_BATCH && !found)
+        {
+            found = simulation_walk(pool, &random, path, &size_path, &new_states);
+            steps += size_path;
+            walks++;
+        }
+        pthread_mutex_lock(&pool->mutex);
+        pool->num_walks += walks;
+        pool->num_steps += steps;
+        pool->distinct_states += new_states;
+        if (found && !pool->found)
+        {
+            pool->found = true;
+            pool->path = path;
+            pool->size_path = size_path;
+            path = NULL;
+        }
+        stop = pool->found || simulation_now() >= pool->deadline;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    free(path);
+    return NULL;
+}
+
+bool deadlock_simulation(LockAutomaton *automata, int num_automata, int max_depth, double time_limit, int num_threads, uint64_t seed, step **path, int *size_path, simulation_statistics *statistics)
+{
+    double start = simulation_now();
+    simulation_pool pool;
+    pool.product = lp_initialize(automata, num_automata);
+    pool.max_depth = max_depth > 0 ? max_depth : 1;
+    pool.deadline = start + time_limit;
+    pool.seed = seed;
+    pool.seen = (uint64_t *)calloc(((uint64_t)1 << SIMULATION_LOG_BITS) / 64, sizeof(uint64_t));
+    pool.found = false;
+    pool.path = NULL;
+    pool.size_path = 0;
+    pool.num_walks = 0;
+    pool.num_steps = 0;
+    pool.distinct_states = 0;
+    pthread_mutex_init(&pool.mutex, NULL);
+
+    if (num_threads < 1)
+        num_threads = 1;
+    pthread_t threads[num_threads];
+    simulation_thread arguments[num_threads];
+    for (int i = 0; i < num_threads; i++)
+    {
+        arguments[i].pool = &pool;
+        arguments[i].thread = i;
+        pthread_create(&threads[i], NULL, simulation_worker, &arguments[i]);
+    }
+    for (int i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    *path = pool.path;
+    *size_path = pool.size_path;
+    if (statistics != NULL)
+    {
+        statistics->seconds = simulation_now() - start;
+        statistics->num_walks = pool.num_walks;
+        statistics->num_steps = pool.num_steps;
+        statistics->distinct_states = pool.distinct_states;
+    }
+    pthread_mutex_destroy(&pool.mutex);
+    free(pool.seen);
+    lp_delete(pool.product);
+    return pool.found;
+}
@@ -0,0 +1,791 @@
+#include "DeadlockSymbolic.h"
+#include "Bdd.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The encoding of the states of the product in BDD variables.
+ * Bit i of the encoding is variable 2i in the current state and 2i + 1 in the next state.
+ */
+typedef struct
+{
+    int num_automata; ///< The number of automata.
+    int max_lock;     ///< The biggest lock used.
+    int num_bits;     ///< The number of bits of a state.
+    int *node_size;   ///< The number of bits of the node of each automaton.
+    int **node_bit;   ///< The bits of the node of each automaton, most significant first.
+    int *lock_bit;    ///< The bit of each lock (-1 if no automaton uses it).
+    bool **uses;      ///< For each automaton, whether it acts on each lock.
+} symbolic_encoding;
+
+/**
+ * @brief Computes the encoding of the states of the product of @p automata. Each lock is placed just before the first automaton using it, so that the variables of an automaton and of its locks are close in the initial order.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param encoding Receives the encoding (to be freed with symbolic_delete_encoding).
+ */
+void symbolic_compute_encoding(LockAutomaton *automata, int num_automata, symbolic_encoding *encoding)
+{
+    encoding->num_automata = num_automata;
+    encoding->max_lock = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        if (la_get_max_lock(automata[aut]) > encoding->max_lock)
+            encoding->max_lock = la_get_max_lock(automata[aut]);
+    encoding->node_size = (int *)malloc(num_automata * sizeof(int));
+    encoding->node_bit = (int **)malloc(num_automata * sizeof(int *));
+    encoding->uses = (bool **)malloc(num_automata * sizeof(bool *));
+    encoding->lock_bit = (int *)malloc((encoding->max_lock + 1) * sizeof(int));
+    for (int lock = 0; lock <= encoding->max_lock; lock++)
+        encoding->lock_bit[lock] = -1;
+    int bit = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        int num_nodes = la_get_num_nodes(automata[aut]);
+        encoding->uses[aut] = (bool *)calloc(encoding->max_lock + 1, sizeof(bool));
+        for (int source = 0; source < num_nodes; source++)
+            for (int target = 0; target < num_nodes; target++)
+                if (la_is_edge(automata[aut], source, target))
+                    encoding->uses[aut][abs(la_get_edge_action(automata[aut], source, target))] = true;
+        for (int lock = 1; lock <= encoding->max_lock; lock++)
+            if (encoding->uses[aut][lock] && encoding->lock_bit[lock] == -1)
+                encoding->lock_bit[lock] = bit++;
+        int size = 0;
+        while ((1 << size) < num_nodes)
+            size++;
+        encoding->node_size[aut] = size;
+        encoding->node_bit[aut] = (int *)malloc((size + 1) * sizeof(int));
+        for (int i = 0; i < size; i++)
+            encoding->node_bit[aut][i] = bit++;
+    }
+    encoding->num_bits = bit;
+}
+
+/**
+ * @brief Deallocates memory used by @p encoding.
+ *
+ * @param encoding
+ */
+void symbolic_delete_encoding(symbolic_encoding *encoding)
+{
+    for (int aut = 0; aut < encoding->num_automata; aut++)
+    {
+        free(encoding->node_bit[aut]);
+        free(encoding->uses[aut]);
+    }
+    free(encoding->node_size);
+    free(encoding->node_bit);
+    free(encoding->uses);
+    free(encoding->lock_bit);
+}
+
+/**
+ * @brief Returns the variable of @p bit in the current state, or in the next state if @p next.
+ *
+ * @param bit
+ * @param next
+ * @return int
+ */
+int symbolic_var(int bit, bool next)
+{
+    return 2 * bit + (next ? 1 : 0);
+}
+
+/**
+ * @brief Replaces *@p f (referenced) by its conjunction with @p g, referenced.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ */
+void symbolic_and_with(BddManager manager, bdd *f, bdd g)
+{
+    bdd result = bdd_ref(manager, bdd_and(manager, *f, g));
+    bdd_deref(manager, *f);
+    *f = result;
+}
+
+/**
+ * @brief Replaces *@p f (referenced) by its disjunction with @p g, referenced.
+ *
+ * @param manager
+ * @param f
+ * @param g
+ */
+void symbolic_or_with(BddManager manager, bdd *f, bdd g)
+{
+    bdd result = bdd_ref(manager, bdd_or(manager, *f, g));
+    bdd_deref(manager, *f);
+    *f = result;
+}
+
+/**
+ * @brief Returns the referenced BDD of variable @p var if @p value, of its negation otherwise.
+ *
+ * @param manager
+ * @param var
+ * @param value
+ * @return bdd
+ */
+bdd symbolic_literal(BddManager manager, int var, bool value)
+{
+    bdd literal = bdd_var(manager, var);
+    if (!value)
+        literal = bdd_not(manager, literal);
+    return bdd_ref(manager, literal);
+}
+
+/**
+ * @brief Replaces *@p f (referenced) by its conjunction with the literal of @p var of value @p value.
+ *
+ * @param manager
+ * @param f
+ * @param var
+ * @param value
+ */
+void symbolic_and_literal(BddManager manager, bdd *f, int var, bool value)
+{
+    bdd literal = symbolic_literal(manager, var, value);
+    symbolic_and_with(manager, f, literal);
+    bdd_deref(manager, literal);
+}
+
+/**
+ * @brief Returns the referenced BDD telling that automaton @p aut is in node @p node (in the next state if @p next).
+ *
+ * @param manager
+ * @param encoding
+ * @param aut
+ * @param node
+ * @param next
+ * @return bdd
+ */
+bdd symbolic_node_is(BddManager manager, const symbolic_encoding *encoding, int aut, int node, bool next)
+{
+    int size = encoding->node_size[aut];
+    bdd result = bdd_ref(manager, BDD_TRUE);
+    for (int i = 0; i < size; i++)
+        symbolic_and_literal(manager, &result, symbolic_var(encoding->node_bit[aut][i], next), (node >> (size - 1 - i)) & 1);
+    return result;
+}
+
+/**
+ * @brief Returns the referenced BDD telling that @p lock is unchanged by a step.
+ *
+ * @param manager
+ * @param encoding
+ * @param lock
+ * @return bdd
+ */
+bdd symbolic_lock_unchanged(BddManager manager, const symbolic_encoding *encoding, int lock)
+{
+    int bit = encoding->lock_bit[lock];
+    bdd current = symbolic_literal(manager, symbolic_var(bit, false), true);
+    bdd next = symbolic_literal(manager, symbolic_var(bit, true), true);
+    bdd not_next = symbolic_literal(manager, symbolic_var(bit, true), false);
+    bdd result = bdd_ref(manager, bdd_ite(manager, current, next, not_next));
+    bdd_deref(manager, current);
+    bdd_deref(manager, next);
+    bdd_deref(manager, not_next);
+    return result;
+}
+
+/**
+ * @brief Returns the referenced BDD of the transitions of automaton @p aut: its node and the locks it uses change according to one of its edges, the other variables are not constrained (they are not quantified by the image).
+ *
+ * @param manager
+ * @param encoding
+ * @param automaton
+ * @param aut
+ * @return bdd
+ */
+bdd symbolic_transitions(BddManager manager, const symbolic_encoding *encoding, LockAutomaton automaton, int aut)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    bdd result = bdd_ref(manager, BDD_FALSE);
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target))
+                continue;
+            int action = la_get_edge_action(automaton, source, target);
+            bdd edge = symbolic_node_is(manager, encoding, aut, source, false);
+            bdd destination = symbolic_node_is(manager, encoding, aut, target, true);
+            symbolic_and_with(manager, &edge, destination);
+            bdd_deref(manager, destination);
+            for (int lock = 1; lock <= encoding->max_lock; lock++)
+            {
+                if (!encoding->uses[aut][lock])
+                    continue;
+                if (lock == abs(action))
+                {
+                    symbolic_and_literal(manager, &edge, symbolic_var(encoding->lock_bit[lock], false), action < 0);
+                    symbolic_and_literal(manager, &edge, symbolic_var(encoding->lock_bit[lock], true), action > 0);
+                }
+                else
+                {
+                    bdd unchanged = symbolic_lock_unchanged(manager, encoding, lock);
+                    symbolic_and_with(manager, &edge, unchanged);
+                    bdd_deref(manager, unchanged);
+                }
+            }
+            symbolic_or_with(manager, &result, edge);
+            bdd_deref(manager, edge);
+        }
+    return result;
+}
+
+/**
+ * @brief Returns the referenced BDD of the states in which automaton @p aut can move.
+ *
+ * @param manager
+ * @param encoding
+ * @param automaton
+ * @param aut
+ * @return bdd
+ */
+bdd symbolic_enabled(BddManager manager, const symbolic_encoding *encoding, LockAutomaton automaton, int aut)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    bdd result = bdd_ref(manager, BDD_FALSE);
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target))
+                continue;
+            int action = la_get_edge_action(automaton, source, target);
+            bdd edge = symbolic_node_is(manager, encoding, aut, source, false);
+            if (action != 0)
+                symbolic_and_literal(manager, &edge, symbolic_var(encoding->lock_bit[abs(action)], false), action < 0);
+            symbolic_or_with(manager, &result, edge);
+            bdd_deref(manager, edge);
+        }
+    return result;
+}
+
+/**
+ * @brief Writes in @p assignment the current state variables of the state where the automata are in @p nodes and the locks taken are given by @p locks (the next state variables are false).
+ *
+ * @param encoding
+ * @param nodes The node of each automaton.
+ * @param locks Whether each lock is taken.
+ * @param assignment An array of 2 * encoding->num_bits values.
+ */
+void symbolic_encode(const symbolic_encoding *encoding, const int *nodes, const bool *locks, bool *assignment)
+{
+    memset(assignment, 0, 2 * encoding->num_bits * sizeof(bool));
+    for (int aut = 0; aut < encoding->num_automata; aut++)
+    {
+        int size = encoding->node_size[aut];
+        for (int i = 0; i < size; i++)
+            assignment[symbolic_var(encoding->node_bit[aut][i], false)] = (nodes[aut] >> (size - 1 - i)) & 1;
+    }
+    for (int lock = 1; lock <= encoding->max_lock; lock++)
+        if (encoding->lock_bit[lock] != -1)
+            assignment[symbolic_var(encoding->lock_bit[lock], false)] = locks[lock];
+}
+
+/**
+ * @brief Reads in @p nodes and @p locks the state given by the current state variables of @p assignment.
+ *
+ * @param encoding
+ * @param assignment
+ * @param nodes Receives the node of each automaton.
+ * @param locks Receives whether each lock is taken.
+ */
+void symbolic_decode(const symbolic_encoding *encoding, const bool *assignment, int *nodes, bool *locks)
+{
+    for (int aut = 0; aut < encoding->num_automata; aut++)
+    {
+        nodes[aut] = 0;
+        for (int i = 0; i < encoding->node_size[aut]; i++)
+            nodes[aut] = 2 * nodes[aut] + assignment[symbolic_var(encoding->node_bit[aut][i], false)];
+    }
+    for (int lock = 0; lock <= encoding->max_lock; lock++)
+        locks[lock] = encoding->lock_bit[lock] != -1 && assignment[symbolic_var(encoding->lock_bit[lock], false)];
+}
+
+/**
+ * @brief Rebuilds a path from the initial state to a state of @p deadlocks, which is in frontier @p depth: going backwards, a predecessor in each previous frontier is found by undoing the edges leading to the current node of some automaton.
+ *
+ * @param manager
+ * @param encoding
+ * @param automata
+ * @param frontiers The frontiers of the search.
+ * @param depth The number of the frontier containing the deadlocks.
+ * @param deadlocks The deadlocked states of that frontier.
+ * @return step* The path, of size @p depth.
+ */
+step *symbolic_build_path(BddManager manager, const symbolic_encoding *encoding, LockAutomaton *automata, const bdd *frontiers, int depth, bdd deadlocks)
+{
+    bool assignment[2 * encoding->num_bits + 1];
+    int nodes[encoding->num_automata];
+    bool locks[encoding->max_lock + 1];
+    bdd_pick_assignment(manager, deadlocks, assignment);
+    symbolic_decode(encoding, assignment, nodes, locks);
+    step *path = (step *)malloc((depth + 1) * sizeof(step));
+    for (int layer = depth - 1; layer >= 0; layer--)
+    {
+        bool found = false;
+        for (int aut = 0; aut < encoding->num_automata && !found; aut++)
+        {
+            int target = nodes[aut];
+            for (int source = 0; source < la_get_num_nodes(automata[aut]) && !found; source++)
+            {
+                if (!la_is_edge(automata[aut], source, target))
+                    continue;
+                int action = la_get_edge_action(automata[aut], source, target);
+                int lock = abs(action);
+                // The step must have left the lock in its current state: taken after an acquisition, free after a release.
+                if (action != 0 && locks[lock] != (action > 0))
+                    continue;
+                nodes[aut] = source;
+                locks[lock] = action != 0 ? !locks[lock] : locks[lock];
+                symbolic_encode(encoding, nodes, locks, assignment);
+                if (bdd_evaluate(manager, frontiers[layer], assignment))
+                {
+                    path[layer] = la_step_create(aut, source, target, action);
+                    found = true;
+                }
+                else
+                {
+                    nodes[aut] = target;
+                    locks[lock] = action != 0 ? !locks[lock] : locks[lock];
+                }
+            }
+        }
+    }
+    return path;
+}
+
+/**
+ * @brief The symbolic model of the product: its encoding, the transitions of each automaton, the deadlocked states and the initial state.
+ */
+typedef struct
+{
+    BddManager manager;          ///< The manager of the BDDs below (all referenced).
+    symbolic_encoding encoding;  ///< The encoding of the states.
+    int num_vars;                ///< The number of BDD variables.
+    bdd *transitions;            ///< The transitions of each automaton.
+    bdd *cubes;                  ///< For each automaton, the cube of the current variables its transitions change.
+    bdd *next_cubes;             ///< For each automaton, the cube of the next variables its transitions change.
+    int **renamings;             ///< For each automaton, the permutation swapping the current and next variables its transitions change.
+    bdd deadlocked;              ///< The states where no automaton can move.
+    bdd initial;                 ///< The initial state.
+} symbolic_model;
+
+/**
+ * @brief Builds the symbolic model of the product of @p automata.
+ *
+ * @param automata The LockAutomata considered.
+ * @param num_automata The number of automata.
+ * @param reorder Whether the variables may be reordered dynamically.
+ * @param model Receives the model (to be freed with symbolic_delete_model).
+ */
+void symbolic_build_model(LockAutomaton *automata, int num_automata, bool reorder, symbolic_model *model)
+{
+    symbolic_compute_encoding(automata, num_automata, &model->encoding);
+    symbolic_encoding *encoding = &model->encoding;
+    model->num_vars = 2 * encoding->num_bits;
+    model->manager = bdd_manager_create(model->num_vars);
+    BddManager manager = model->manager;
+    bdd_set_auto_reorder(manager, reorder);
+
+    model->transitions = (bdd *)malloc(num_automata * sizeof(bdd));
+    model->cubes = (bdd *)malloc(num_automata * sizeof(bdd));
+    model->next_cubes = (bdd *)malloc(num_automata * sizeof(bdd));
+    model->renamings = (int **)malloc(num_automata * sizeof(int *));
+    model->deadlocked = bdd_ref(manager, BDD_TRUE);
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        model->transitions[aut] = symbolic_transitions(manager, encoding, automata[aut], aut);
+        bdd enabled = symbolic_enabled(manager, encoding, automata[aut], aut);
+        bdd disabled = bdd_ref(manager, bdd_not(manager, enabled));
+        symbolic_and_with(manager, &model->deadlocked, disabled);
+        bdd_deref(manager, enabled);
+        bdd_deref(manager, disabled);
+
+        int changed[encoding->num_bits + 1];
+        int num_changed = 0;
+        for (int i = 0; i < encoding->node_size[aut]; i++)
+            changed[num_changed++] = encoding->node_bit[aut][i];
+        for (int lock = 1; lock <= encoding->max_lock; lock++)
+            if (encoding->uses[aut][lock])
+                changed[num_changed++] = encoding->lock_bit[lock];
+        int vars[num_changed + 1];
+        int next_vars[num_changed + 1];
+        model->renamings[aut] = (int *)malloc(model->num_vars * sizeof(int));
+        for (int var = 0; var < model->num_vars; var++)
+            model->renamings[aut][var] = var;
+        for (int i = 0; i < num_changed; i++)
+        {
+            vars[i] = symbolic_var(changed[i], false);
+            next_vars[i] = symbolic_var(changed[i], true);
+            model->renamings[aut][next_vars[i]] = vars[i];
+            model->renamings[aut][vars[i]] = next_vars[i];
+        }
+        model->cubes[aut] = bdd_ref(manager, bdd_cube(manager, vars, num_changed));
+        model->next_cubes[aut] = bdd_ref(manager, bdd_cube(manager, next_vars, num_changed));
+    }
+
+    model->initial = bdd_ref(manager, BDD_TRUE);
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        bdd node = symbolic_node_is(manager, encoding, aut, la_get_initial(automata[aut]), false);
+        symbolic_and_with(manager, &model->initial, node);
+        bdd_deref(manager, node);
+    }
+    for (int lock = 1; lock <= encoding->max_lock; lock++)
+        if (encoding->lock_bit[lock] != -1)
+            symbolic_and_literal(manager, &model->initial, symbolic_var(encoding->lock_bit[lock], false), false);
+}
+
+/**
+ * @brief Deallocates memory used by @p model (and its BDDs).
+ *
+ * @param model
+ */
+void symbolic_delete_model(symbolic_model *model)
+{
+    for (int aut = 0; aut < model->encoding.num_automata; aut++)
+        free(model->renamings[aut]);
+    free(model->renamings);
+    free(model->transitions);
+    free(model->cubes);
+    free(model->next_cubes);
+    bdd_manager_delete(model->manager);
+    symbolic_delete_encoding(&model->encoding);
+}
+
+/**
+ * @brief Returns the referenced BDD of the successors of the states of @p states (image by the transitions of every automaton).
+ *
+ * @param model
+ * @param states
+ * @return bdd
+ */
+bdd symbolic_image(symbolic_model *model, bdd states)
+{
+    BddManager manager = model->manager;
+    bdd image = bdd_ref(manager, BDD_FALSE);
+    for (int aut = 0; aut < model->encoding.num_automata; aut++)
+    {
+        bdd successors = bdd_ref(manager, bdd_and_exists(manager, states, model->transitions[aut], model->cubes[aut]));
+        bdd renamed = bdd_ref(manager, bdd_permute(manager, successors, model->renamings[aut]));
+        symbolic_or_with(manager, &image, renamed);
+        bdd_deref(manager, successors);
+        bdd_deref(manager, renamed);
+    }
+    return image;
+}
+
+/**
+ * @brief Returns the referenced BDD of the predecessors of the states of @p states (pre-image by the transitions of every automaton).
+ *
+ * @param model
+ * @param states
+ * @return bdd
+ */
+bdd symbolic_preimage(symbolic_model *model, bdd states)
+{
+    BddManager manager = model->manager;
+    bdd preimage = bdd_ref(manager, BDD_FALSE);
+    for (int aut = 0; aut < model->encoding.num_automata; aut++)
+    {
+        bdd renamed = bdd_ref(manager, bdd_permute(manager, states, model->renamings[aut]));
+        bdd predecessors = bdd_ref(manager, bdd_and_exists(manager, model->transitions[aut], renamed, model->next_cubes[aut]));
+        symbolic_or_with(manager, &preimage, predecessors);
+        bdd_deref(manager, renamed);
+        bdd_deref(manager, predecessors);
+    }
+    return preimage;
+}
+
+/**
+ * @brief Returns the number of states of @p states (in which the next state variables are free).
+ *
+ * @param model
+ * @param states
+ * @return double
+ */
+double symbolic_count_states(symbolic_model *model, bdd states)
+{
+    double count = bdd_sat_count(model->manager, states);
+    for (int bit = 0; bit < model->encoding.num_bits; bit++)
+        count /= 2;
+    return count;
+}
+
+bool deadlock_symbolic_search(LockAutomaton *automata, int num_automata, bool reorder, step **path, int *size_path, symbolic_statistics *statistics)
+{
+    symbolic_model model;
+    symbolic_build_model(automata, num_automata, reorder, &model);
+    BddManager manager = model.manager;
+    bdd reached = bdd_ref(manager, model.initial);
+    int capacity = 64;
+    bdd *frontiers = (bdd *)malloc(capacity * sizeof(bdd));
+    frontiers[0] = bdd_ref(manager, reached);
+    int depth = 0;
+    bool found = false;
+    *path = NULL;
+    *size_path = 0;
+    while (true)
+    {
+        bdd deadlocks = bdd_ref(manager, bdd_and(manager, frontiers[depth], model.deadlocked));
+        if (deadlocks != BDD_FALSE)
+        {
+            *path = symbolic_build_path(manager, &model.encoding, automata, frontiers, depth, deadlocks);
+            *size_path = depth;
+            found = true;
+            bdd_deref(manager, deadlocks);
+            break;
+        }
+        bdd_deref(manager, deadlocks);
+        bdd image = symbolic_image(&model, frontiers[depth]);
+        bdd unreached = bdd_ref(manager, bdd_not(manager, reached));
+        symbolic_and_with(manager, &image, unreached);
+        bdd_deref(manager, unreached);
+        if (image == BDD_FALSE)
+        {
+            bdd_deref(manager, image);
+            break;
+        }
+        symbolic_or_with(manager, &reached, image);
+        if (++depth == capacity)
+        {
+            capacity *= 2;
+            frontiers = (bdd *)realloc(frontiers, capacity * sizeof(bdd));
+        }
+        frontiers[depth] = image;
+    }
+
+    if (statistics != NULL)
+    {
+        statistics->num_vars = model.num_vars;
+        statistics->depth = depth;
+        statistics->num_states = symbolic_count_states(&model, reached);
+        statistics->reachable_nodes = bdd_node_count(manager, reached);
+        statistics->peak_nodes = bdd_peak_nodes(manager);
+        statistics->num_reorderings = bdd_num_reorderings(manager);
+    }
+    free(frontiers);
+    symbolic_delete_model(&model);
+    return found;
+}
+
+/**
+ * @brief Rebuilds a path from the initial state through the layers of a backward search: going forwards, a move leading to the next layer is found by trying the moves enabled in the current state.
+ *
+ * @param manager
+ * @param encoding
+ * @param automata
+ * @param layers The layers of the backward search (layer i contains the states at distance i of the target).
+ * @param depth The number of the layer containing the initial state.
+ * @return step* The path, of size @p depth.
+ */
+step *symbolic_forward_path(BddManager manager, const symbolic_encoding *encoding, LockAutomaton *automata, const bdd *layers, int depth)
+{
+    bool assignment[2 * encoding->num_bits + 1];
+    int nodes[encoding->num_automata];
+    bool locks[encoding->max_lock + 1];
+    for (int aut = 0; aut < encoding->num_automata; aut++)
+        nodes[aut] = la_get_initial(automata[aut]);
+    for (int lock = 0; lock <= encoding->max_lock; lock++)
+        locks[lock] = false;
+    step *path = (step *)malloc((depth + 1) * sizeof(step));
+    for (int layer = depth; layer > 0; layer--)
+    {
+        bool found = false;
+        for (int aut = 0; aut < encoding->num_automata && !found; aut++)
+        {
+            int source = nodes[aut];
+            for (int target = 0; target < la_get_num_nodes(automata[aut]) && !found; target++)
+            {
+                if (!la_is_edge(automata[aut], source, target))
+                    continue;
+                int action = la_get_edge_action(automata[aut], source, target);
+                int lock = abs(action);
+                if (action != 0 && locks[lock] != (action < 0))
+                    continue;
+                nodes[aut] = target;
+                locks[lock] = action != 0 ? !locks[lock] : locks[lock];
+                symbolic_encode(encoding, nodes, locks, assignment);
+                if (bdd_evaluate(manager, layers[layer - 1], assignment))
+                {
+                    path[depth - layer] = la_step_create(aut, source, target, action);
+                    found = true;
+                }
+                else
+                {
+                    nodes[aut] = source;
+                    locks[lock] = action != 0 ? !locks[lock] : locks[lock];
+                }
+            }
+        }
+    }
+    return path;
+}
+
+/**
+ * @brief Returns the referenced BDD of an invariant of the reachable states of @p model, from the lockset analysis of each automaton: every automaton is in a node it can reach alone, and every lock taken may be held by the node of some automaton (the last automaton to acquire it has not released it since).
+ *
+ * @param model
+ * @param automata
+ * @return bdd
+ */
+bdd symbolic_invariant(symbolic_model *model, LockAutomaton *automata)
+{
+    BddManager manager = model->manager;
+    symbolic_encoding *encoding = &model->encoding;
+    int num_automata = encoding->num_automata;
+    bdd invariant = bdd_ref(manager, BDD_TRUE);
+    // held[lock] gathers the configurations where some automaton may hold the lock.
+    bdd held[encoding->max_lock + 1];
+    for (int lock = 0; lock <= encoding->max_lock; lock++)
+        held[lock] = bdd_ref(manager, BDD_FALSE);
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        LockSets sets = la_compute_locksets(automata[aut]);
+        bdd reachable = bdd_ref(manager, BDD_FALSE);
+        for (int node = 0; node < la_get_num_nodes(automata[aut]); node++)
+        {
+            if (!la_is_reachable(sets, node))
+                continue;
+            bdd here = symbolic_node_is(manager, encoding, aut, node, false);
+            symbolic_or_with(manager, &reachable, here);
+            for (int lock = 1; lock <= encoding->max_lock; lock++)
+                if (la_may_hold(sets, node, lock))
+                    symbolic_or_with(manager, &held[lock], here);
+            bdd_deref(manager, here);
+        }
+        symbolic_and_with(manager, &invariant, reachable);
+        bdd_deref(manager, reachable);
+        la_delete_locksets(sets);
+    }
+    for (int lock = 1; lock <= encoding->max_lock; lock++)
+        if (encoding->lock_bit[lock] != -1)
+        {
+            bdd free_lock = symbolic_literal(manager, symbolic_var(encoding->lock_bit[lock], false), false);
+            symbolic_or_with(manager, &held[lock], free_lock);
+            symbolic_and_with(manager, &invariant, held[lock]);
+            bdd_deref(manager, free_lock);
+        }
+    for (int lock = 0; lock <= encoding->max_lock; lock++)
+        bdd_deref(manager, held[lock]);
+    return invariant;
+}
+
+/**
+ * @brief Returns the referenced BDD of the candidate deadlocks of @p model, projected on the nodes: the tuples of nodes of the automata in which, for some value of the locks satisfying @p invariant, no automaton can move.
+ *
+ * @param model
+ * @param invariant An invariant of the reachable states (see symbolic_invariant).
+ * @return bdd
+ */
+bdd symbolic_candidates(symbolic_model *model, bdd invariant)
+{
+    BddManager manager = model->manager;
+    symbolic_encoding *encoding = &model->encoding;
+    int lock_vars[encoding->max_lock + 1];
+    int num_lock_vars = 0;
+    for (int lock = 1; lock <= encoding->max_lock; lock++)
+        if (encoding->lock_bit[lock] != -1)
+            lock_vars[num_lock_vars++] = symbolic_var(encoding->lock_bit[lock], false);
+    bdd locks = bdd_ref(manager, bdd_cube(manager, lock_vars, num_lock_vars));
+    bdd candidates = bdd_ref(manager, bdd_and_exists(manager, model->deadlocked, invariant, locks));
+    bdd_deref(manager, locks);
+    return candidates;
+}
+
+bool deadlock_backward_search(LockAutomaton *automata, int num_automata, bool reorder, step **path, int *size_path, backward_statistics *statistics)
+{
+    symbolic_model model;
+    symbolic_build_model(automata, num_automata, reorder, &model);
+    BddManager manager = model.manager;
+    symbolic_encoding *encoding = &model.encoding;
+    bdd invariant = symbolic_invariant(&model, automata);
+    bdd candidates = symbolic_candidates(&model, invariant);
+    // The union of the backward closures of the candidates refuted: none of these states is reachable.
+    bdd unreachable = bdd_ref(manager, BDD_FALSE);
+    bool assignment[model.num_vars + 1];
+    int nodes[num_automata];
+    bool locks[encoding->max_lock + 1];
+    int capacity = 64;
+    bdd *layers = (bdd *)malloc(capacity * sizeof(bdd));
+    int num_candidates = 0, num_refuted = 0;
+    long num_preimages = 0;
+    bool found = false;
+    *path = NULL;
+    *size_path = 0;
+    while (!found && candidates != BDD_FALSE)
+    {
+        bdd_pick_assignment(manager, candidates, assignment);
+        symbolic_decode(encoding, assignment, nodes, locks);
+        bdd tuple = bdd_ref(manager, BDD_TRUE);
+        for (int aut = 0; aut < num_automata; aut++)
+        {
+            bdd node = symbolic_node_is(manager, encoding, aut, nodes[aut], false);
+            symbolic_and_with(manager, &tuple, node);
+            bdd_deref(manager, node);
+        }
+        bdd other = bdd_ref(manager, bdd_not(manager, tuple));
+        symbolic_and_with(manager, &candidates, other);
+        bdd_deref(manager, other);
+        num_candidates++;
+
+        symbolic_and_with(manager, &tuple, invariant);
+        layers[0] = bdd_ref(manager, bdd_and(manager, model.deadlocked, tuple));
+        bdd_deref(manager, tuple);
+        bdd visited = bdd_ref(manager, layers[0]);
+        int depth = 0;
+        while (true)
+        {
+            bdd initial = bdd_ref(manager, bdd_and(manager, layers[depth], model.initial));
+            bdd_deref(manager, initial);
+            if (initial != BDD_FALSE)
+            {
+                *path = symbolic_forward_path(manager, encoding, automata, layers, depth);
+                *size_path = depth;
+                found = true;
+                break;
+            }
+            bdd preimage = symbolic_preimage(&model, layers[depth]);
+            num_preimages++;
+            bdd known = bdd_ref(manager, bdd_or(manager, visited, unreachable));
+            bdd unknown = bdd_ref(manager, bdd_not(manager, known));
+            symbolic_and_with(manager, &preimage, unknown);
+            symbolic_and_with(manager, &preimage, invariant);
+            bdd_deref(manager, known);
+            bdd_deref(manager, unknown);
+            if (preimage == BDD_FALSE)
+            {
+                bdd_deref(manager, preimage);
+                symbolic_or_with(manager, &unreachable, visited);
+                num_refuted++;
+                break;
+            }
+            symbolic_or_with(manager, &visited, preimage);
+            if (++depth == capacity)
+            {
+                capacity *= 2;
+                layers = (bdd *)realloc(layers, capacity * sizeof(bdd));
+            }
+            layers[depth] = preimage;
+        }
+        for (int layer = 0; layer <= depth; layer++)
+            bdd_deref(manager, layers[layer]);
+        bdd_deref(manager, visited);
+    }
+
+    if (statistics != NULL)
+    {
+        statistics->num_candidates = num_candidates;
+        statistics->num_refuted = num_refuted;
+        statistics->num_preimages = num_preimages;
+        statistics->unreachable_states = symbolic_count_states(&model, unreachable);
+        statistics->peak_nodes = bdd_peak_nodes(manager);
+    }
+    free(layers);
+    symbolic_delete_model(&model);
+    return found;
+}
@@ -0,0 +1,400 @@
+#include "DeadlockWitness.h"
+#include "DeadlockReduction.h"
+#include "LockProduct.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tells if @p action can be done with the locks in @p locks (bitset, one bit per lock number).
+ *
+ * @param locks
+ * @param action An action code.
+ * @return true
+ * @return false
+ */
+bool witness_is_action_possible(const uint64_t *locks, int action)
+{
+    if (action == 0)
+        return true;
+    bool taken = (locks[abs(action) / 64] >> (abs(action) % 64)) & 1;
+    return action > 0 ? !taken : taken;
+}
+
+witness_verdict witness_validate(LockAutomaton *automata, int num_automata, const step *path, int size_path, int *position)
+{
+    int max_lock = 0;
+    int nodes[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        nodes[aut] = la_get_initial(automata[aut]);
+        if (max_lock < la_get_max_lock(automata[aut]))
+            max_lock = la_get_max_lock(automata[aut]);
+    }
+    uint64_t locks[max_lock / 64 + 1];
+    memset(locks, 0, sizeof(locks));
+    if (position != NULL)
+        *position = -1;
+
+    for (int i = 0; i < size_path; i++)
+    {
+        step move = path[i];
+        witness_verdict verdict = WITNESS_VALID;
+        if (move.automaton < 0 || move.automaton >= num_automata || move.target < 0 || move.target >= la_get_num_nodes(automata[move.automaton]))
+            verdict = WITNESS_UNKNOWN_STEP;
+        else if (move.source != nodes[move.automaton])
+            verdict = WITNESS_WRONG_SOURCE;
+        else if (!la_is_edge(automata[move.automaton], move.source, move.target))
+            verdict = WITNESS_MISSING_EDGE;
+        else if (move.action != la_get_edge_action(automata[move.automaton], move.source, move.target))
+            verdict = WITNESS_WRONG_ACTION;
+        else if (!witness_is_action_possible(locks, move.action))
+            verdict = move.action > 0 ? WITNESS_LOCK_TAKEN : WITNESS_LOCK_FREE;
+        if (verdict != WITNESS_VALID)
+        {
+            if (position != NULL)
+                *position = i;
+            return verdict;
+        }
+        nodes[move.automaton] = move.target;
+        if (move.action != 0)
+            locks[abs(move.action) / 64] ^= (uint64_t)1 << (abs(move.action) % 64);
+    }
+
+    for (int aut = 0; aut < num_automata; aut++)
+        for (int target = 0; target < la_get_num_nodes(automata[aut]); target++)
+            if (la_is_edge(automata[aut], nodes[aut], target) && witness_is_action_possible(locks, la_get_edge_action(automata[aut], nodes[aut], target)))
+            {
+                if (position != NULL)
+                    *position = aut;
+                return WITNESS_NOT_DEADLOCKED;
+            }
+    return WITNESS_VALID;
+}
+
+const char *witness_verdict_description(witness_verdict verdict)
+{
+    switch (verdict)
+    {
+    case WITNESS_VALID:
+        return "valid";
+    case WITNESS_UNKNOWN_STEP:
+        return "step of an unknown automaton or node";
+    case WITNESS_WRONG_SOURCE:
+        return "step from a node the automaton is not in";
+    case WITNESS_MISSING_EDGE:
+        return "step along a missing edge";
+    case WITNESS_WRONG_ACTION:
+        return "step with another action than its edge";
+    case WITNESS_LOCK_TAKEN:
+        return "acquisition of a lock already taken";
+    case WITNESS_LOCK_FREE:
+        return "release of a free lock";
+    case WITNESS_NOT_DEADLOCKED:
+        return "an automaton can still move at the end";
+    }
+    return "unknown verdict";
+}
+
+/**
+ * @brief Tells if @p path is executable from the initial state of @p product and ends in a deadlock.
+ *
+ * @param product
+ * @param path
+ * @param size_path
+ * @return true
+ * @return false
+ */
+bool witness_leads_to_deadlock(LockProduct product, const step *path, int size_path)
+{
+    unsigned state[lp_state_size(product)];
+    lp_initial_state(product, state);
+    for (int i = 0; i < size_path; i++)
+    {
+        if (!lp_is_enabled(product, state, path[i]))
+            return false;
+        lp_apply(product, state, path[i]);
+    }
+    return lp_is_deadlock(product, state);
+}
+
+/**
+ * @brief Removes from @p path the steps between two visits of the same state: from each state, the path goes on from the last visit of that state.
+ *
+ * @param product
+ * @param path The path, shrunk in place.
+ * @param size_path The size of @p path.
+ * @return int The new size of @p path.
+ */
+int witness_cut_cycles(LockProduct product, step *path, int size_path)
+{
+    int size = lp_state_size(product);
+    StateSet states = lp_set_create(size);
+    long *last = (long *)malloc((size_path + 1) * sizeof(long));
+    long *index_of = (long *)malloc((size_path + 1) * sizeof(long));
+    unsigned state[size];
+    lp_initial_state(product, state);
+    for (int position = 0; position <= size_path; position++)
+    {
+        if (position > 0)
+            lp_apply(product, state, path[position - 1]);
+        long index = lp_set_find(states, state);
+        if (index == -1)
+        {
+            lp_set_insert(states, state);
+            index = lp_set_size(states) - 1;
+        }
+        last[index] = position;
+        index_of[position] = index;
+    }
+    int size_cut = 0;
+    for (long position = last[index_of[0]]; position < size_path; position = last[index_of[position + 1]])
+        path[size_cut++] = path[position];
+    free(last);
+    free(index_of);
+    lp_set_delete(states);
+    return size_cut;
+}
+
+/**
+ * @brief Checks the detour of automaton path[@p first].automaton from step @p first to step @p last locally: the steps of the other automata in between are replayed against the locks as they would be without the detour, from the locks @p locks taken before step @p first.
+ * Only the locks matter, since the detour ends on the node it started from. When the detour also leaves the locks as it found them, the rest of the path runs from the same state as before, and the answer is final.
+ *
+ * @param path
+ * @param removed Marks the steps of @p path already removed.
+ * @param first
+ * @param last
+ * @param locks The locks taken before step @p first (bitset, one bit per lock number).
+ * @param words The number of words of @p locks.
+ * @param removable Receives whether the path without the detour is still executable and ends in a deadlock, if decided.
+ * @return true if the answer is decided.
+ * @return false if the detour changes the locks: the path without it must be replayed.
+ */
+bool witness_check_detour(const step *path, const bool *removed, int first, int last, const uint64_t *locks, int words, bool *removable)
+{
+    int aut = path[first].automaton;
+    uint64_t with_detour[words];
+    uint64_t without_detour[words];
+    memcpy(with_detour, locks, words * sizeof(uint64_t));
+    memcpy(without_detour, locks, words * sizeof(uint64_t));
+    *removable = true;
+    for (int i = first; i <= last; i++)
+    {
+        if (removed[i] || path[i].action == 0)
+            continue;
+        int word = abs(path[i].action) / 64;
+        uint64_t bit = (uint64_t)1 << (abs(path[i].action) % 64);
+        with_detour[word] ^= bit;
+        if (path[i].automaton == aut)
+            continue;
+        if (!witness_is_action_possible(without_detour, path[i].action))
+        {
+            *removable = false;
+            return true;
+        }
+        without_detour[word] ^= bit;
+    }
+    return memcmp(with_detour, without_detour, words * sizeof(uint64_t)) == 0;
+}
+
+/**
+ * @brief Removes from @p path the detours of single automata: the steps of an automaton from a node back to the same node, when the path without them is still executable and ends in a deadlock.
+ * Each pass goes along the path with the locks taken so far, and checks each detour locally (see witness_check_detour): the whole path is only replayed for the detours which change the locks.
+ *
+ * @param product
+ * @param path The path, shrunk in place.
+ * @param size_path The size of @p path.
+ * @return int The new size of @p path.
+ */
+int witness_remove_detours(LockProduct product, step *path, int size_path)
+{
+    int words = lp_get_max_lock(product) / 64 + 1;
+    uint64_t locks[words];
+    bool *removed = (bool *)malloc((size_path + 1) * sizeof(bool));
+    step *candidate = (step *)malloc((size_path + 1) * sizeof(step));
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        memset(removed, 0, size_path * sizeof(bool));
+        memset(locks, 0, words * sizeof(uint64_t));
+        for (int first = 0; first < size_path; first++)
+        {
+            if (removed[first])
+                continue;
+            int aut = path[first].automaton;
+            int last = first;
+            while (last < size_path && (removed[last] || path[last].automaton != aut || path[last].target != path[first].source))
+                last++;
+            if (last < size_path)
+            {
+                bool removable;
+                if (!witness_check_detour(path, removed, first, last, locks, words, &removable))
+                {
+                    int size = 0;
+                    for (int i = 0; i < size_path; i++)
+                        if (!removed[i] && (i < first || i > last || path[i].automaton != aut))
+                            candidate[size++] = path[i];
+                    removable = witness_leads_to_deadlock(product, candidate, size);
+                }
+                if (removable)
+                {
+                    for (int i = first; i <= last; i++)
+                        if (path[i].automaton == aut)
+                            removed[i] = true;
+                    changed = true;
+                    // The next step left has not been tried yet, and the locks are those before the detour.
+                    continue;
+                }
+            }
+            if (path[first].action != 0)
+                locks[abs(path[first].action) / 64] ^= (uint64_t)1 << (abs(path[first].action) % 64);
+        }
+        int size = 0;
+        for (int i = 0; i < size_path; i++)
+            if (!removed[i])
+                path[size++] = path[i];
+        size_path = size;
+    }
+    free(candidate);
+    free(removed);
+    return size_path;
+}
+
+/**
+ * @brief Looks for a shortest deadlock by a breadth-first search from the initial state of @p product restricted to the states of @p path and the states at most @p radius steps away from them.
+ *
+ * @param product
+ * @param path A path leading to a deadlock.
+ * @param size_path The size of @p path.
+ * @param radius The number of steps the search may go away from the path.
+ * @param size_found Will contain the size of the path returned.
+ * @param neighbourhood Will contain the number of states of the neighbourhood.
+ * @return step* A newly allocated path, of size at most @p size_path (a copy of @p path if no deadlock is found).
+ */
+step *witness_search_neighbourhood(LockProduct product, const step *path, int size_path, int radius, int *size_found, long *neighbourhood)
+{
+    int size = lp_state_size(product);
+    step moves[lp_max_moves(product) + 1];
+    unsigned state[size];
+    StateSet allowed = lp_set_create(size);
+    lp_initial_state(product, state);
+    lp_set_insert(allowed, state);
+    for (int i = 0; i < size_path; i++)
+    {
+        lp_apply(product, state, path[i]);
+        lp_set_insert(allowed, state);
+    }
+    long begin = 0;
+    for (int layer = 0; layer < radius; layer++)
+    {
+        long end = lp_set_size(allowed);
+        for (long index = begin; index < end; index++)
+        {
+            memcpy(state, lp_set_get(allowed, index), size * sizeof(unsigned));
+            int num_moves = lp_enabled_moves(product, state, moves);
+            for (int i = 0; i < num_moves; i++)
+            {
+                lp_apply(product, state, moves[i]);
+                lp_set_insert(allowed, state);
+                lp_undo(product, state, moves[i]);
+            }
+        }
+        begin = end;
+    }
+    *neighbourhood = lp_set_size(allowed);
+
+    // The states visited are a subset of the neighbourhood, which bounds the arrays.
+    StateSet visited = lp_set_create(size);
+    long *parent = (long *)malloc(*neighbourhood * sizeof(long));
+    step *discovery = (step *)malloc(*neighbourhood * sizeof(step));
+    lp_initial_state(product, state);
+    lp_set_insert(visited, state);
+    parent[0] = -1;
+    long target = -1;
+    for (long index = 0; index < lp_set_size(visited) && target == -1; index++)
+    {
+        memcpy(state, lp_set_get(visited, index), size * sizeof(unsigned));
+        int num_moves = lp_enabled_moves(product, state, moves);
+        if (num_moves == 0)
+            target = index;
+        for (int i = 0; i < num_moves; i++)
+        {
+            lp_apply(product, state, moves[i]);
+            if (lp_set_contains(allowed, state) && lp_set_insert(visited, state))
+            {
+                parent[lp_set_size(visited) - 1] = index;
+                discovery[lp_set_size(visited) - 1] = moves[i];
+            }
+            lp_undo(product, state, moves[i]);
+        }
+    }
+    // Only a path not leading to a deadlock leaves no deadlock in the neighbourhood: it is given back as is.
+    if (target == -1)
+    {
+        step *copy = (step *)malloc((size_path + 1) * sizeof(step));
+        memcpy(copy, path, size_path * sizeof(step));
+        *size_found = size_path;
+        free(parent);
+        free(discovery);
+        lp_set_delete(visited);
+        lp_set_delete(allowed);
+        return copy;
+    }
+    int size_target = 0;
+    for (long current = target; parent[current] != -1; current = parent[current])
+        size_target++;
+    step *found = (step *)malloc((size_target + 1) * sizeof(step));
+    int position = size_target;
+    for (long current = target; parent[current] != -1; current = parent[current])
+        found[--position] = discovery[current];
+    *size_found = size_target;
+    free(parent);
+    free(discovery);
+    lp_set_delete(visited);
+    lp_set_delete(allowed);
+    return found;
+}
+
+step *witness_minimise(LockAutomaton *automata, int num_automata, const step *path, int size_path, int radius, int *size_minimised, witness_statistics *statistics)
+{
+    LockProduct product = lp_initialize(automata, num_automata);
+    step *pruned = (step *)malloc((size_path + 1) * sizeof(step));
+    memcpy(pruned, path, size_path * sizeof(step));
+    int size = witness_cut_cycles(product, pruned, size_path);
+    size = witness_remove_detours(product, pruned, size);
+    size = witness_cut_cycles(product, pruned, size);
+    int size_pruned = size;
+    long neighbourhood;
+    step *found = witness_search_neighbourhood(product, pruned, size, radius, size_minimised, &neighbourhood);
+    if (statistics != NULL)
+    {
+        statistics->original_size = size_path;
+        statistics->size_after_pruning = size_pruned;
+        statistics->size_after_search = *size_minimised;
+        statistics->neighbourhood = neighbourhood;
+    }
+    free(pruned);
+    lp_delete(product);
+    return found;
+}
+
+Z3_lbool witness_check_shortest(Z3_context ctx, LockAutomaton *automata, int num_automata, step **path, int *size_path)
+{
+    if (*size_path == 0)
+        return Z3_L_TRUE;
+    step *shorter = (step *)malloc(*size_path * sizeof(step));
+    int length;
+    bound_probe *probes;
+    int num_probes;
+    Z3_lbool result = deadlock_minimal_length(ctx, automata, num_automata, *size_path - 1, shorter, &length, &probes, &num_probes);
+    free(probes);
+    if (result != Z3_L_TRUE)
+    {
+        free(shorter);
+        return result == Z3_L_FALSE ? Z3_L_TRUE : Z3_L_UNDEF;
+    }
+    free(*path);
+    *path = shorter;
+    *size_path = length;
+    return Z3_L_FALSE;
+}
@@ -13,6 +13,16 @@ struct LockAutomaton_s
     int initial;       ///< The initial node of the automaton.
     int *edge_actions; ///< The action associated to each edge (positive for acquiring a lock, negative for releasing it, 0 for noop).
     int max_lock;      ///< The maximum lock number appearing in this automaton;
+    bool owns_graph;   ///< Whether the graph was built by la_create (and must be freed with the automaton).
+};
+
+struct LockSets_s
+{
+    int num_nodes;        ///< The number of nodes of the automaton analysed.
+    int words;            ///< The number of 64-bit words of a set of locks.
+    bool *reachable;      ///< Whether each node is reachable from the initial node.
+    uint64_t *may_hold;   ///< The locks each node may hold (num_nodes * words).
+    uint64_t *must_hold;  ///< The locks each node must hold (num_nodes * words).
 };
 
 int la_get_edge_pos(LockAutomaton automaton, int source, int target)
@@ -27,6 +37,7 @@ LockAutomaton la_initialize(Graph graph)
     int num_nodes = graph_num_nodes(graph);
     result->edge_actions = (int *)malloc(num_nodes * num_nodes * sizeof(int));
     result->max_lock = 0;
+    result->owns_graph = false;
     for (int node = 0; node < num_nodes; node++)
     {
         char *param = parameter_list_get_value(graph.parameters[node], "shape");
@@ -59,8 +70,43 @@ LockAutomaton la_initialize(Graph graph)
     return result;
 }
 
+LockAutomaton la_create(char *name, int num_nodes, char **node_names, int initial, bool *edges, int *edge_actions)
+{
+    LockAutomaton result = (LockAutomaton)malloc(sizeof(*result));
+    Graph *graph = &result->graph;
+    graph->name = (char *)malloc((strlen(name) + 1) * sizeof(char));
+    strcpy(graph->name, name);
+    graph->numNodes = num_nodes;
+    graph->numEdges = 0;
+    graph->nodes = (char **)malloc(num_nodes * sizeof(char *));
+    graph->edges = (bool *)malloc(num_nodes * num_nodes * sizeof(bool));
+    graph->parameters = (parameterList **)calloc(num_nodes, sizeof(parameterList *));
+    graph->edge_parameters = (parameterList **)calloc(num_nodes * num_nodes, sizeof(parameterList *));
+    for (int node = 0; node < num_nodes; node++)
+    {
+        graph->nodes[node] = (char *)malloc((strlen(node_names[node]) + 1) * sizeof(char));
+        strcpy(graph->nodes[node], node_names[node]);
+    }
+    result->initial = initial;
+    result->edge_actions = (int *)malloc(num_nodes * num_nodes * sizeof(int));
+    result->max_lock = 0;
+    result->owns_graph = true;
+    for (int pos = 0; pos < num_nodes * num_nodes; pos++)
+    {
+        graph->edges[pos] = edges[pos];
+        result->edge_actions[pos] = edges[pos] ? edge_actions[pos] : 0;
+        if (edges[pos])
+            graph->numEdges++;
+        if (result->max_lock < abs(result->edge_actions[pos]))
+            result->max_lock = abs(result->edge_actions[pos]);
+    }
+    return result;
+}
+
 void la_delete(LockAutomaton automaton)
 {
+    if (automaton->owns_graph)
+        graph_delete(automaton->graph);
     free(automaton->edge_actions);
     free(automaton);
 }
@@ -132,6 +178,29 @@ int la_get_initial(LockAutomaton automaton)
     return automaton->initial;
 }
 
+void la_distances_from_initial(LockAutomaton automaton, int *distances)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int queue[num_nodes];
+    int head = 0;
+    int tail = 0;
+    for (int node = 0; node < num_nodes; node++)
+        distances[node] = -1;
+    distances[automaton->initial] = 0;
+    queue[tail++] = automaton->initial;
+    while (head < tail)
+    {
+        int source = queue[head++];
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (distances[target] != -1 || !graph_is_edge(automaton->graph, source, target))
+                continue;
+            distances[target] = distances[source] + 1;
+            queue[tail++] = target;
+        }
+    }
+}
+
 int la_get_max_lock(LockAutomaton automaton)
 {
     return automaton->max_lock;
@@ -224,4 +293,211 @@ step la_step_create(int automaton, int source, int target, int action)
 step la_step_empty()
 {
     return la_step_create(0, 0, 0, 0);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Tells if @p lock is in the bitset @p set.
+ *
+ * @param set
+ * @param lock
+ * @return true
+ * @return false
+ */
+bool la_lockset_contains(const uint64_t *set, int lock)
+{
+    return (set[lock / 64] >> (lock % 64)) & 1;
+}
+
+/**
+ * @brief Applies @p action to the bitset @p set (adds the lock acquired, removes the lock released).
+ *
+ * @param set
+ * @param action
+ */
+void la_lockset_apply(uint64_t *set, int action)
+{
+    if (action > 0)
+        set[action / 64] |= (uint64_t)1 << (action % 64);
+    else if (action < 0)
+        set[-action / 64] &= ~((uint64_t)1 << (-action % 64));
+}
+
+/**
+ * @brief Merges the locksets obtained after taking an edge into the locksets of its @p target (union for may, intersection for must).
+ *
+ * @param sets
+ * @param target
+ * @param may The locks which may be held after the edge.
+ * @param must The locks which must be held after the edge.
+ * @return true if the locksets of @p target changed (or it was not reachable before).
+ * @return false otherwise.
+ */
+bool la_lockset_merge(LockSets sets, int target, const uint64_t *may, const uint64_t *must)
+{
+    int words = sets->words;
+    bool changed = !sets->reachable[target];
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t old_may = sets->may_hold[target * words + w];
+        uint64_t old_must = sets->must_hold[target * words + w];
+        uint64_t new_may = sets->reachable[target] ? old_may | may[w] : may[w];
+        uint64_t new_must = sets->reachable[target] ? old_must & must[w] : must[w];
+        changed = changed || new_may != old_may || new_must != old_must;
+        sets->may_hold[target * words + w] = new_may;
+        sets->must_hold[target * words + w] = new_must;
+    }
+    sets->reachable[target] = true;
+    return changed;
+}
+
+LockSets la_compute_locksets(LockAutomaton automaton)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int words = automaton->max_lock / 64 + 1;
+    LockSets sets = (LockSets)malloc(sizeof(*sets));
+    sets->num_nodes = num_nodes;
+    sets->words = words;
+    sets->reachable = (bool *)calloc(num_nodes, sizeof(bool));
+    sets->may_hold = (uint64_t *)calloc(num_nodes * words, sizeof(uint64_t));
+    sets->must_hold = (uint64_t *)calloc(num_nodes * words, sizeof(uint64_t));
+
+    int worklist[num_nodes];
+    bool in_worklist[num_nodes];
+    for (int node = 0; node < num_nodes; node++)
+        in_worklist[node] = false;
+    sets->reachable[automaton->initial] = true;
+    worklist[0] = automaton->initial;
+    in_worklist[automaton->initial] = true;
+    int size = 1;
+    while (size > 0)
+    {
+        int source = worklist[--size];
+        in_worklist[source] = false;
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target))
+                continue;
+            int action = la_get_edge_action(automaton, source, target);
+            uint64_t may[words];
+            uint64_t must[words];
+            memcpy(may, sets->may_hold + source * words, words * sizeof(uint64_t));
+            memcpy(must, sets->must_hold + source * words, words * sizeof(uint64_t));
+            la_lockset_apply(may, action);
+            la_lockset_apply(must, action);
+            if (la_lockset_merge(sets, target, may, must) && !in_worklist[target])
+            {
+                worklist[size++] = target;
+                in_worklist[target] = true;
+            }
+        }
+    }
+    return sets;
+}
+
+void la_delete_locksets(LockSets sets)
+{
+    free(sets->reachable);
+    free(sets->may_hold);
+    free(sets->must_hold);
+    free(sets);
+}
+
+int la_lockset_words(LockSets sets)
+{
+    return sets->words;
+}
+
+const uint64_t *la_get_may_hold(LockSets sets, int node)
+{
+    return sets->may_hold + node * sets->words;
+}
+
+const uint64_t *la_get_must_hold(LockSets sets, int node)
+{
+    return sets->must_hold + node * sets->words;
+}
+
+bool la_is_reachable(LockSets sets, int node)
+{
+    return sets->reachable[node];
+}
+
+bool la_may_hold(LockSets sets, int node, int lock)
+{
+    return lock < 64 * sets->words && la_lockset_contains(la_get_may_hold(sets, node), lock);
+}
+
+bool la_must_hold(LockSets sets, int node, int lock)
+{
+    return lock < 64 * sets->words && la_lockset_contains(la_get_must_hold(sets, node), lock);
+}
+
+bool la_acquires_lock(LockAutomaton automaton, LockSets sets, int lock)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+            if (sets->reachable[source] && la_is_edge(automaton, source, target) && la_get_edge_action(automaton, source, target) == lock)
+                return true;
+    return false;
+}
+
+bool la_releases_only_held_locks(LockAutomaton automaton, LockSets sets)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    for (int source = 0; source < num_nodes; source++)
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!sets->reachable[source] || !la_is_edge(automaton, source, target))
+                continue;
+            int action = la_get_edge_action(automaton, source, target);
+            if (action < 0 && !la_must_hold(sets, source, -action))
+                return false;
+        }
+    return true;
+}
+
+bool la_is_edge_never_blocked(LockAutomaton automaton, LockSets sets, int source, int target, bool releases_well_formed)
+{
+    int action = la_get_edge_action(automaton, source, target);
+    if (action == 0)
+        return true;
+    return action < 0 && releases_well_formed && la_must_hold(sets, source, -action);
+}
+
+bool la_is_node_never_deadlocked(LockAutomaton automaton, LockSets sets, int node, bool releases_well_formed)
+{
+    if (!sets->reachable[node])
+        return true;
+    int num_nodes = la_get_num_nodes(automaton);
+    for (int target = 0; target < num_nodes; target++)
+        if (la_is_edge(automaton, node, target) && la_is_edge_never_blocked(automaton, sets, node, target, releases_well_formed))
+            return true;
+    return false;
+}
+
+void la_distances_to_stuck_nodes(LockAutomaton automaton, LockSets sets, bool releases_well_formed, int *distances)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int queue[num_nodes];
+    int head = 0, tail = 0;
+    for (int node = 0; node < num_nodes; node++)
+    {
+        distances[node] = -1;
+        if (!la_is_node_never_deadlocked(automaton, sets, node, releases_well_formed))
+        {
+            distances[node] = 0;
+            queue[tail++] = node;
+        }
+    }
+    while (head < tail)
+    {
+        int target = queue[head++];
+        for (int source = 0; source < num_nodes; source++)
+            if (distances[source] == -1 && la_is_edge(automaton, source, target))
+            {
+                distances[source] = distances[target] + 1;
+                queue[tail++] = source;
+            }
+    }
+}
@@ -0,0 +1,369 @@
+#include "LockMinimisation.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+struct MinimisedAutomaton_s
+{
+    LockAutomaton original; ///< The automaton minimised.
+    LockAutomaton quotient; ///< The minimised automaton.
+    int *block;             ///< The node of the minimised automaton standing for each original node (-1 if there is none).
+    int *chain_next;        ///< For each original node collapsed, the target of its noop edge (-1 for nodes not collapsed).
+};
+
+/**
+ * @brief Returns the end of the chain of collapsed noop edges starting at @p node.
+ *
+ * @param chain_next The target of the noop edge of each collapsed node (-1 for the others).
+ * @param node
+ * @return int
+ */
+int lm_chain_end(const int *chain_next, int node)
+{
+    while (chain_next[node] != -1)
+        node = chain_next[node];
+    return node;
+}
+
+/**
+ * @brief Finds the nodes of @p automaton to collapse: nodes whose only outgoing edge is a noop towards another node. Cycles of such nodes are broken (the node closing the cycle is kept), so that every chain has an end.
+ *
+ * @param automaton
+ * @param collapse_noops If false, no node is collapsed.
+ * @param chain_next Receives the target of the noop edge of each node collapsed (-1 for the others).
+ */
+void lm_find_noop_chains(LockAutomaton automaton, bool collapse_noops, int *chain_next)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    for (int node = 0; node < num_nodes; node++)
+    {
+        chain_next[node] = -1;
+        if (!collapse_noops)
+            continue;
+        int num_successors = 0;
+        int successor = -1;
+        for (int target = 0; target < num_nodes; target++)
+            if (la_is_edge(automaton, node, target))
+            {
+                num_successors++;
+                successor = target;
+            }
+        if (num_successors == 1 && successor != node && la_get_edge_action(automaton, node, successor) == 0)
+            chain_next[node] = successor;
+    }
+    int visited[num_nodes];
+    for (int node = 0; node < num_nodes; node++)
+        visited[node] = -1;
+    for (int start = 0; start < num_nodes; start++)
+    {
+        visited[start] = start;
+        for (int node = chain_next[start]; node != -1; node = chain_next[node])
+        {
+            if (visited[node] == start)
+            {
+                chain_next[node] = -1;
+                break;
+            }
+            visited[node] = start;
+        }
+    }
+}
+
+/**
+ * @brief Computes the nodes of @p automaton to keep: the nodes reachable from the initial node once chains are collapsed (edges towards a collapsed node being redirected to the end of its chain).
+ *
+ * @param automaton
+ * @param chain_next See lm_find_noop_chains.
+ * @param alive Receives whether each node is kept.
+ */
+void lm_find_alive_nodes(LockAutomaton automaton, const int *chain_next, bool *alive)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int queue[num_nodes];
+    int head = 0, tail = 0;
+    for (int node = 0; node < num_nodes; node++)
+        alive[node] = false;
+    int initial = lm_chain_end(chain_next, la_get_initial(automaton));
+    alive[initial] = true;
+    queue[tail++] = initial;
+    while (head < tail)
+    {
+        int source = queue[head++];
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target))
+                continue;
+            int end = lm_chain_end(chain_next, target);
+            if (!alive[end])
+            {
+                alive[end] = true;
+                queue[tail++] = end;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Comparison of pairs of ints (action, block), for qsort.
+ *
+ * @param first
+ * @param second
+ * @return int
+ */
+int lm_compare_pairs(const void *first, const void *second)
+{
+    const int *a = (const int *)first;
+    const int *b = (const int *)second;
+    if (a[0] != b[0])
+        return a[0] < b[0] ? -1 : 1;
+    if (a[1] != b[1])
+        return a[1] < b[1] ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Computes the signature of @p node with respect to the partition @p block: the set of pairs (action, block of the target) of its edges, sorted without duplicates.
+ *
+ * @param automaton
+ * @param chain_next See lm_find_noop_chains.
+ * @param block The current partition.
+ * @param node
+ * @param signature Receives the pairs (array of size 2 * num_nodes).
+ * @return int The number of pairs.
+ */
+int lm_signature(LockAutomaton automaton, const int *chain_next, const int *block, int node, int *signature)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int size = 0;
+    for (int target = 0; target < num_nodes; target++)
+    {
+        if (!la_is_edge(automaton, node, target))
+            continue;
+        signature[2 * size] = la_get_edge_action(automaton, node, target);
+        signature[2 * size + 1] = block[lm_chain_end(chain_next, target)];
+        size++;
+    }
+    qsort(signature, size, 2 * sizeof(int), lm_compare_pairs);
+    int unique = 0;
+    for (int i = 0; i < size; i++)
+    {
+        if (unique > 0 && lm_compare_pairs(signature + 2 * i, signature + 2 * (unique - 1)) == 0)
+            continue;
+        signature[2 * unique] = signature[2 * i];
+        signature[2 * unique + 1] = signature[2 * i + 1];
+        unique++;
+    }
+    return unique;
+}
+
+/**
+ * @brief Computes the coarsest bisimulation of the alive nodes of @p automaton refining the partition given by @p colour, by partition refinement: blocks are split according to the signatures of their nodes until the partition is stable.
+ *
+ * @param automaton
+ * @param chain_next See lm_find_noop_chains.
+ * @param alive The nodes kept.
+ * @param colour The initial partition.
+ * @param block Receives the block of each alive node (numbered from 0), -1 for the others.
+ * @return int The number of blocks.
+ */
+int lm_refine_partition(LockAutomaton automaton, const int *chain_next, const bool *alive, const int *colour, int *block)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int *signatures = (int *)malloc(num_nodes * 2 * num_nodes * sizeof(int));
+    int sizes[num_nodes];
+    int new_block[num_nodes];
+    int representative[num_nodes];
+    for (int node = 0; node < num_nodes; node++)
+        block[node] = alive[node] ? colour[node] : -1;
+    int num_blocks = -1;
+    while (true)
+    {
+        for (int node = 0; node < num_nodes; node++)
+            if (alive[node])
+                sizes[node] = lm_signature(automaton, chain_next, block, node, signatures + node * 2 * num_nodes);
+        int count = 0;
+        for (int node = 0; node < num_nodes; node++)
+        {
+            new_block[node] = -1;
+            if (!alive[node])
+                continue;
+            for (int b = 0; b < count && new_block[node] == -1; b++)
+            {
+                int other = representative[b];
+                if (block[other] == block[node] && sizes[other] == sizes[node] && memcmp(signatures + other * 2 * num_nodes, signatures + node * 2 * num_nodes, 2 * sizes[node] * sizeof(int)) == 0)
+                    new_block[node] = b;
+            }
+            if (new_block[node] == -1)
+            {
+                representative[count] = node;
+                new_block[node] = count++;
+            }
+        }
+        memcpy(block, new_block, num_nodes * sizeof(int));
+        if (count == num_blocks)
+            break;
+        num_blocks = count;
+    }
+    free(signatures);
+    return num_blocks;
+}
+
+/**
+ * @brief Looks for a block whose nodes have two edges with distinct actions towards the same block: the quotient could not represent them (there is at most one edge between two nodes). Fixes the first one found, either by isolating one of the targets in a new colour, or by not collapsing one of them if both end at the same node.
+ *
+ * @param automaton
+ * @param chain_next See lm_find_noop_chains (modified if needed).
+ * @param block The partition.
+ * @param num_blocks The number of blocks.
+ * @param colour The colours of the nodes (modified if needed).
+ * @param next_colour The next colour unused (modified if needed).
+ * @return true if a conflict was found (and fixed, so that the partition must be recomputed).
+ * @return false otherwise.
+ */
+bool lm_fix_conflict(LockAutomaton automaton, int *chain_next, const int *block, int num_blocks, int *colour, int *next_colour)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    bool seen[num_blocks];
+    for (int b = 0; b < num_blocks; b++)
+        seen[b] = false;
+    for (int node = 0; node < num_nodes; node++)
+    {
+        if (block[node] == -1 || seen[block[node]])
+            continue;
+        seen[block[node]] = true;
+        for (int first = 0; first < num_nodes; first++)
+            for (int second = 0; second < first; second++)
+            {
+                if (!la_is_edge(automaton, node, first) || !la_is_edge(automaton, node, second) || la_get_edge_action(automaton, node, first) == la_get_edge_action(automaton, node, second))
+                    continue;
+                int first_end = lm_chain_end(chain_next, first);
+                int second_end = lm_chain_end(chain_next, second);
+                if (block[first_end] != block[second_end])
+                    continue;
+                if (first_end != second_end)
+                    colour[first_end] = (*next_colour)++;
+                else if (first != first_end)
+                    chain_next[first] = -1;
+                else
+                    chain_next[second] = -1;
+                return true;
+            }
+    }
+    return false;
+}
+
+MinimisedAutomaton lm_minimise(LockAutomaton automaton, bool collapse_noops)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    MinimisedAutomaton minimised = (MinimisedAutomaton)malloc(sizeof(*minimised));
+    minimised->original = automaton;
+    minimised->block = (int *)malloc(num_nodes * sizeof(int));
+    minimised->chain_next = (int *)malloc(num_nodes * sizeof(int));
+    lm_find_noop_chains(automaton, collapse_noops, minimised->chain_next);
+
+    int colour[num_nodes];
+    for (int node = 0; node < num_nodes; node++)
+        colour[node] = 0;
+    int next_colour = 1;
+    bool alive[num_nodes];
+    int num_blocks;
+    do
+    {
+        lm_find_alive_nodes(automaton, minimised->chain_next, alive);
+        num_blocks = lm_refine_partition(automaton, minimised->chain_next, alive, colour, minimised->block);
+    } while (lm_fix_conflict(automaton, minimised->chain_next, minimised->block, num_blocks, colour, &next_colour));
+
+    char *names[num_blocks];
+    bool *edges = (bool *)calloc(num_blocks * num_blocks, sizeof(bool));
+    int *actions = (int *)calloc(num_blocks * num_blocks, sizeof(int));
+    for (int b = 0; b < num_blocks; b++)
+        names[b] = NULL;
+    for (int node = 0; node < num_nodes; node++)
+    {
+        int source = minimised->block[node];
+        if (source == -1 || names[source] != NULL)
+            continue;
+        names[source] = la_get_node_name(automaton, node);
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, node, target))
+                continue;
+            int end = minimised->block[lm_chain_end(minimised->chain_next, target)];
+            edges[source * num_blocks + end] = true;
+            actions[source * num_blocks + end] = la_get_edge_action(automaton, node, target);
+        }
+    }
+    int initial = minimised->block[lm_chain_end(minimised->chain_next, la_get_initial(automaton))];
+    minimised->quotient = la_create(la_get_name(automaton), num_blocks, names, initial, edges, actions);
+    free(edges);
+    free(actions);
+    return minimised;
+}
+
+void lm_delete(MinimisedAutomaton minimised)
+{
+    la_delete(minimised->quotient);
+    free(minimised->block);
+    free(minimised->chain_next);
+    free(minimised);
+}
+
+LockAutomaton lm_get_automaton(MinimisedAutomaton minimised)
+{
+    return minimised->quotient;
+}
+
+int lm_get_minimised_node(MinimisedAutomaton minimised, int node)
+{
+    return minimised->block[node];
+}
+
+/**
+ * @brief Appends to @p path the noop edges of the chain collapsed starting at @p node.
+ *
+ * @param minimised
+ * @param aut The number of the automaton.
+ * @param node
+ * @param path The path being built.
+ * @param size The size of @p path (updated).
+ * @return int The end of the chain.
+ */
+int lm_append_chain(MinimisedAutomaton minimised, int aut, int node, step *path, int *size)
+{
+    while (minimised->chain_next[node] != -1)
+    {
+        path[(*size)++] = la_step_create(aut, node, minimised->chain_next[node], 0);
+        node = minimised->chain_next[node];
+    }
+    return node;
+}
+
+step *lm_translate_path(MinimisedAutomaton *minimised, int num_automata, step *path, int size_path, int *size_translated)
+{
+    int max_nodes = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        if (max_nodes < la_get_num_nodes(minimised[aut]->original))
+            max_nodes = la_get_num_nodes(minimised[aut]->original);
+    step *result = (step *)malloc(((size_path + num_automata) * (max_nodes + 1) + 1) * sizeof(step));
+    int size = 0;
+    int current[num_automata];
+    for (int aut = 0; aut < num_automata; aut++)
+        current[aut] = lm_append_chain(minimised[aut], aut, la_get_initial(minimised[aut]->original), result, &size);
+
+    for (int i = 0; i < size_path; i++)
+    {
+        int aut = path[i].automaton;
+        MinimisedAutomaton automaton = minimised[aut];
+        int num_nodes = la_get_num_nodes(automaton->original);
+        assert(automaton->block[current[aut]] == path[i].source);
+        int target = 0;
+        while (target < num_nodes && !(la_is_edge(automaton->original, current[aut], target) && la_get_edge_action(automaton->original, current[aut], target) == path[i].action && automaton->block[lm_chain_end(automaton->chain_next, target)] == path[i].target))
+            target++;
+        assert(target < num_nodes);
+        result[size++] = la_step_create(aut, current[aut], target, path[i].action);
+        current[aut] = lm_append_chain(automaton, aut, target, result, &size);
+    }
+    *size_translated = size;
+    return result;
+}
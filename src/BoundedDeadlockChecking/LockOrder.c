@@ -0,0 +1,243 @@
+#include "LockOrder.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+struct LockOrder_s
+{
+    int num_automata;      ///< The number of automata analysed.
+    int max_lock;          ///< The biggest lock used.
+    bool *order_edges;     ///< order_edges[l1 * (max_lock + 1) + l2] is true if some automaton may acquire l2 while holding l1.
+    bool *edge_automata;   ///< edge_automata[(l1 * (max_lock + 1) + l2) * num_automata + aut] is true if automaton aut induces the edge l1 -> l2.
+    int *component;        ///< The strongly connected component of each lock.
+    bool *cyclic;          ///< Whether each component (indexed as locks) contains a cycle.
+    int num_cycles;        ///< The number of cyclic components.
+    bool *bad_release;     ///< Whether each automaton may release a lock it does not hold.
+    bool *may_terminate;   ///< Whether each automaton may reach a node without outgoing edges.
+};
+
+/**
+ * @brief Adds to @p order the lock-order edges induced by automaton number @p aut, and records whether it may release a lock it does not hold or reach a node without outgoing edges.
+ *
+ * @param order The analysis being built.
+ * @param automaton The LockAutomaton.
+ * @param aut Its number.
+ */
+void lo_add_automaton(LockOrder order, LockAutomaton automaton, int aut)
+{
+    int num_nodes = la_get_num_nodes(automaton);
+    int num_locks = order->max_lock + 1;
+    LockSets sets = la_compute_locksets(automaton);
+    order->bad_release[aut] = !la_releases_only_held_locks(automaton, sets);
+
+    for (int source = 0; source < num_nodes; source++)
+    {
+        if (!la_is_reachable(sets, source))
+            continue;
+        bool has_successor = false;
+        for (int target = 0; target < num_nodes; target++)
+        {
+            if (!la_is_edge(automaton, source, target))
+                continue;
+            has_successor = true;
+            int action = la_get_edge_action(automaton, source, target);
+            if (action <= 0)
+                continue;
+            for (int held = 1; held <= order->max_lock; held++)
+            {
+                if (!la_may_hold(sets, source, held))
+                    continue;
+                order->order_edges[held * num_locks + action] = true;
+                order->edge_automata[(held * num_locks + action) * order->num_automata + aut] = true;
+            }
+        }
+        if (!has_successor)
+            order->may_terminate[aut] = true;
+    }
+    la_delete_locksets(sets);
+}
+
+/**
+ * @brief State of Tarjan's strongly connected components algorithm.
+ */
+typedef struct
+{
+    int *index;    ///< The visit index of each lock (-1 if not visited).
+    int *lowlink;  ///< The smallest index reachable from each lock through its subtree.
+    bool *on_stack; ///< Whether each lock is on the stack.
+    int *stack;    ///< The stack of locks.
+    int size;      ///< The size of the stack.
+    int counter;   ///< The next visit index.
+} lo_tarjan_state;
+
+/**
+ * @brief Recursive step of Tarjan's algorithm from @p lock.
+ *
+ * @param order The analysis being built.
+ * @param state The state of the algorithm.
+ * @param lock The lock visited.
+ */
+void lo_tarjan_visit(LockOrder order, lo_tarjan_state *state, int lock)
+{
+    int num_locks = order->max_lock + 1;
+    state->index[lock] = state->lowlink[lock] = state->counter++;
+    state->stack[state->size++] = lock;
+    state->on_stack[lock] = true;
+    for (int next = 1; next < num_locks; next++)
+    {
+        if (!order->order_edges[lock * num_locks + next])
+            continue;
+        if (state->index[next] == -1)
+        {
+            lo_tarjan_visit(order, state, next);
+            if (state->lowlink[next] < state->lowlink[lock])
+                state->lowlink[lock] = state->lowlink[next];
+        }
+        else if (state->on_stack[next] && state->index[next] < state->lowlink[lock])
+            state->lowlink[lock] = state->index[next];
+    }
+    if (state->lowlink[lock] != state->index[lock])
+        return;
+    int size_component = 0;
+    int member;
+    do
+    {
+        member = state->stack[--state->size];
+        state->on_stack[member] = false;
+        order->component[member] = lock;
+        size_component++;
+    } while (member != lock);
+    if (size_component > 1 || order->order_edges[lock * num_locks + lock])
+    {
+        order->cyclic[lock] = true;
+        order->num_cycles++;
+    }
+}
+
+/**
+ * @brief Computes the strongly connected components of the lock-order graph, and which ones are cyclic.
+ *
+ * @param order The analysis being built.
+ */
+void lo_compute_components(LockOrder order)
+{
+    int num_locks = order->max_lock + 1;
+    int index[num_locks];
+    int lowlink[num_locks];
+    bool on_stack[num_locks];
+    int stack[num_locks];
+    lo_tarjan_state state = {index, lowlink, on_stack, stack, 0, 0};
+    for (int lock = 0; lock < num_locks; lock++)
+    {
+        index[lock] = -1;
+        on_stack[lock] = false;
+        order->component[lock] = lock;
+    }
+    for (int lock = 1; lock < num_locks; lock++)
+        if (index[lock] == -1)
+            lo_tarjan_visit(order, &state, lock);
+}
+
+LockOrder lo_analyse(LockAutomaton *automata, int num_automata)
+{
+    LockOrder order = (LockOrder)malloc(sizeof(*order));
+    order->num_automata = num_automata;
+    order->max_lock = 0;
+    for (int aut = 0; aut < num_automata; aut++)
+        if (order->max_lock < la_get_max_lock(automata[aut]))
+            order->max_lock = la_get_max_lock(automata[aut]);
+    int num_locks = order->max_lock + 1;
+    order->order_edges = (bool *)calloc(num_locks * num_locks, sizeof(bool));
+    order->edge_automata = (bool *)calloc(num_locks * num_locks * num_automata, sizeof(bool));
+    order->component = (int *)malloc(num_locks * sizeof(int));
+    order->cyclic = (bool *)calloc(num_locks, sizeof(bool));
+    order->num_cycles = 0;
+    order->bad_release = (bool *)calloc(num_automata, sizeof(bool));
+    order->may_terminate = (bool *)calloc(num_automata, sizeof(bool));
+
+    for (int aut = 0; aut < num_automata; aut++)
+        lo_add_automaton(order, automata[aut], aut);
+    lo_compute_components(order);
+    return order;
+}
+
+void lo_delete(LockOrder order)
+{
+    free(order->order_edges);
+    free(order->edge_automata);
+    free(order->component);
+    free(order->cyclic);
+    free(order->bad_release);
+    free(order->may_terminate);
+    free(order);
+}
+
+bool lo_proves_deadlock_freedom(LockOrder order)
+{
+    if (order->num_cycles > 0)
+        return false;
+    for (int aut = 0; aut < order->num_automata; aut++)
+        if (order->bad_release[aut] || order->may_terminate[aut])
+            return false;
+    return true;
+}
+
+int lo_num_cycles(LockOrder order)
+{
+    return order->num_cycles;
+}
+
+bool lo_is_lock_in_cycle(LockOrder order, int lock)
+{
+    return lock <= order->max_lock && order->cyclic[order->component[lock]];
+}
+
+bool lo_is_automaton_involved(LockOrder order, int automaton)
+{
+    if (order->bad_release[automaton] || order->may_terminate[automaton])
+        return true;
+    int num_locks = order->max_lock + 1;
+    for (int l1 = 1; l1 < num_locks; l1++)
+        for (int l2 = 1; l2 < num_locks; l2++)
+            if (order->order_edges[l1 * num_locks + l2] && lo_is_lock_in_cycle(order, l1) && order->component[l1] == order->component[l2] && order->edge_automata[(l1 * num_locks + l2) * order->num_automata + automaton])
+                return true;
+    return false;
+}
+
+void lo_print(LockOrder order, LockAutomaton *automata)
+{
+    int num_locks = order->max_lock + 1;
+    printf("Lock-order graph: %d cycle(s).\n", order->num_cycles);
+    for (int root = 1; root < num_locks; root++)
+    {
+        if (!order->cyclic[root] || order->component[root] != root)
+            continue;
+        printf("Cycle on locks:");
+        for (int lock = 1; lock < num_locks; lock++)
+            if (order->component[lock] == root)
+                printf(" %d", lock);
+        printf("\n");
+        for (int l1 = 1; l1 < num_locks; l1++)
+            for (int l2 = 1; l2 < num_locks; l2++)
+            {
+                if (!order->order_edges[l1 * num_locks + l2] || order->component[l1] != root || order->component[l2] != root)
+                    continue;
+                printf(" %d -> %d (acquired while holding by:", l1, l2);
+                for (int aut = 0; aut < order->num_automata; aut++)
+                    if (order->edge_automata[(l1 * num_locks + l2) * order->num_automata + aut])
+                        printf(" %s(%d)", la_get_name(automata[aut]), aut);
+                printf(")\n");
+            }
+    }
+    for (int aut = 0; aut < order->num_automata; aut++)
+    {
+        if (order->may_terminate[aut])
+            printf("%s(%d) may reach a node without outgoing edges.\n", la_get_name(automata[aut]), aut);
+        if (order->bad_release[aut])
+            printf("%s(%d) may release a lock it does not hold.\n", la_get_name(automata[aut]), aut);
+    }
+    printf("Automata to focus on (inducing an edge of a cycle, or possibly stuck without waiting for a lock):");
+    for (int aut = 0; aut < order->num_automata; aut++)
+        if (lo_is_automaton_involved(order, aut))
+            printf(" %s(%d)", la_get_name(automata[aut]), aut);
+    printf("\n");
+}
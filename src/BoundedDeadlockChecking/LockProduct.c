@@ -0,0 +1,317 @@
+#include "LockProduct.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+struct LockProduct_s
+{
+    int num_automata;   ///< The number of automata.
+    int max_lock;       ///< The biggest lock used.
+    int state_size;     ///< The number of words of a state.
+    int max_moves;      ///< The maximal number of moves enabled in a state.
+    int *initial;       ///< The initial node of each automaton.
+    int **first_edge;   ///< For each automaton, the index of the first edge leaving each node in the arrays below (num_nodes + 1 entries).
+    int **edge_target;  ///< For each automaton, the target of each edge, sorted by source.
+    int **edge_action;  ///< For each automaton, the action of each edge, sorted by source.
+};
+
+struct StateSet_s
+{
+    int key_size;       ///< The number of words of a key.
+    long size;          ///< The number of keys stored.
+    long key_capacity;  ///< The number of keys the array keys can contain.
+    unsigned *keys;     ///< The keys, in insertion order (key_capacity * key_size words).
+    long capacity;      ///< The number of slots of the hash table (a power of 2).
+    long *table;        ///< The hash table: the index of a key in keys for each slot (-1 for empty slots).
+};
+
+LockProduct lp_initialize(LockAutomaton *automata, int num_automata)
+{
+    LockProduct product = (LockProduct)malloc(sizeof(*product));
+    product->num_automata = num_automata;
+    product->max_lock = 0;
+    product->max_moves = 0;
+    product->initial = (int *)malloc(num_automata * sizeof(int));
+    product->first_edge = (int **)malloc(num_automata * sizeof(int *));
+    product->edge_target = (int **)malloc(num_automata * sizeof(int *));
+    product->edge_action = (int **)malloc(num_automata * sizeof(int *));
+    for (int aut = 0; aut < num_automata; aut++)
+    {
+        LockAutomaton automaton = automata[aut];
+        int num_nodes = la_get_num_nodes(automaton);
+        product->initial[aut] = la_get_initial(automaton);
+        if (product->max_lock < la_get_max_lock(automaton))
+            product->max_lock = la_get_max_lock(automaton);
+        product->first_edge[aut] = (int *)malloc((num_nodes + 1) * sizeof(int));
+        product->edge_target[aut] = (int *)malloc((la_get_num_edges(automaton) + 1) * sizeof(int));
+        product->edge_action[aut] = (int *)malloc((la_get_num_edges(automaton) + 1) * sizeof(int));
+        int count = 0;
+        int max_degree = 0;
+        for (int source = 0; source < num_nodes; source++)
+        {
+            product->first_edge[aut][source] = count;
+            for (int target = 0; target < num_nodes; target++)
+            {
+                if (!la_is_edge(automaton, source, target))
+                    continue;
+                product->edge_target[aut][count] = target;
+                product->edge_action[aut][count] = la_get_edge_action(automaton, source, target);
+                count++;
+            }
+            if (max_degree < count - product->first_edge[aut][source])
+                max_degree = count - product->first_edge[aut][source];
+        }
+        product->first_edge[aut][num_nodes] = count;
+        product->max_moves += max_degree;
+    }
+    product->state_size = num_automata + product->max_lock / 32 + 1;
+    return product;
+}
+
+void lp_delete(LockProduct product)
+{
+    for (int aut = 0; aut < product->num_automata; aut++)
+    {
+        free(product->first_edge[aut]);
+        free(product->edge_target[aut]);
+        free(product->edge_action[aut]);
+    }
+    free(product->initial);
+    free(product->first_edge);
+    free(product->edge_target);
+    free(product->edge_action);
+    free(product);
+}
+
+int lp_get_num_automata(LockProduct product)
+{
+    return product->num_automata;
+}
+
+int lp_get_max_lock(LockProduct product)
+{
+    return product->max_lock;
+}
+
+int lp_state_size(LockProduct product)
+{
+    return product->state_size;
+}
+
+int lp_max_moves(LockProduct product)
+{
+    return product->max_moves;
+}
+
+void lp_initial_state(LockProduct product, unsigned *state)
+{
+    memset(state, 0, product->state_size * sizeof(unsigned));
+    for (int aut = 0; aut < product->num_automata; aut++)
+        state[aut] = product->initial[aut];
+}
+
+int lp_get_node(LockProduct product, const unsigned *state, int aut)
+{
+    return state[aut];
+}
+
+bool lp_is_lock_taken(LockProduct product, const unsigned *state, int lock)
+{
+    return (state[product->num_automata + lock / 32] >> (lock % 32)) & 1;
+}
+
+/**
+ * @brief Tells if @p action is possible in @p state.
+ *
+ * @param product
+ * @param state
+ * @param action An action code.
+ * @return true
+ * @return false
+ */
+bool lp_is_action_possible(LockProduct product, const unsigned *state, int action)
+{
+    if (action == 0)
+        return true;
+    bool taken = lp_is_lock_taken(product, state, abs(action));
+    return action > 0 ? !taken : taken;
+}
+
+/**
+ * @brief Flips the lock acted upon by @p action in @p state (acquiring and releasing are both a flip once the action is known to be possible).
+ *
+ * @param product
+ * @param state
+ * @param action An action code.
+ */
+void lp_flip_lock(LockProduct product, unsigned *state, int action)
+{
+    if (action != 0)
+        state[product->num_automata + abs(action) / 32] ^= 1u << (abs(action) % 32);
+}
+
+bool lp_is_enabled(LockProduct product, const unsigned *state, step move)
+{
+    return move.automaton >= 0 && move.automaton < product->num_automata && (int)state[move.automaton] == move.source && lp_is_action_possible(product, state, move.action);
+}
+
+void lp_apply(LockProduct product, unsigned *state, step move)
+{
+    state[move.automaton] = move.target;
+    lp_flip_lock(product, state, move.action);
+}
+
+void lp_undo(LockProduct product, unsigned *state, step move)
+{
+    state[move.automaton] = move.source;
+    lp_flip_lock(product, state, move.action);
+}
+
+int lp_enabled_moves(LockProduct product, const unsigned *state, step *moves)
+{
+    int count = 0;
+    for (int aut = 0; aut < product->num_automata; aut++)
+    {
+        int source = state[aut];
+        for (int edge = product->first_edge[aut][source]; edge < product->first_edge[aut][source + 1]; edge++)
+        {
+            int action = product->edge_action[aut][edge];
+            if (lp_is_action_possible(product, state, action))
+                moves[count++] = la_step_create(aut, source, product->edge_target[aut][edge], action);
+        }
+    }
+    return count;
+}
+
+bool lp_is_deadlock(LockProduct product, const unsigned *state)
+{
+    for (int aut = 0; aut < product->num_automata; aut++)
+    {
+        int source = state[aut];
+        for (int edge = product->first_edge[aut][source]; edge < product->first_edge[aut][source + 1]; edge++)
+            if (lp_is_action_possible(product, state, product->edge_action[aut][edge]))
+                return false;
+    }
+    return true;
+}
+
+uint64_t lp_hash(const unsigned *key, int size, uint64_t seed)
+{
+    uint64_t hash = seed ^ 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < size; i++)
+    {
+        hash ^= key[i];
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void lp_print_state(LockProduct product, LockAutomaton *automata, const unsigned *state)
+{
+    printf("(");
+    for (int aut = 0; aut < product->num_automata; aut++)
+        printf("%s%s", aut == 0 ? "" : ", ", la_get_node_name(automata[aut], state[aut]));
+    printf(") locks taken: {");
+    bool first = true;
+    for (int lock = 1; lock <= product->max_lock; lock++)
+        if (lp_is_lock_taken(product, state, lock))
+        {
+            printf("%s%d", first ? "" : ", ", lock);
+            first = false;
+        }
+    printf("}");
+}
+
+StateSet lp_set_create(int key_size)
+{
+    StateSet set = (StateSet)malloc(sizeof(*set));
+    set->key_size = key_size;
+    set->size = 0;
+    set->key_capacity = 512;
+    set->keys = (unsigned *)malloc(set->key_capacity * key_size * sizeof(unsigned));
+    set->capacity = 1024;
+    set->table = (long *)malloc(set->capacity * sizeof(long));
+    for (long slot = 0; slot < set->capacity; slot++)
+        set->table[slot] = -1;
+    return set;
+}
+
+void lp_set_delete(StateSet set)
+{
+    free(set->keys);
+    free(set->table);
+    free(set);
+}
+
+/**
+ * @brief Finds the slot of @p key in the hash table of @p set (linear probing): the slot containing its index, or the empty slot where it should be inserted.
+ *
+ * @param set
+ * @param key
+ * @return long The index of the slot.
+ */
+long lp_set_find_slot(StateSet set, const unsigned *key)
+{
+    long mask = set->capacity - 1;
+    long slot = lp_hash(key, set->key_size, 0) & mask;
+    while (set->table[slot] != -1 && memcmp(set->keys + set->table[slot] * set->key_size, key, set->key_size * sizeof(unsigned)) != 0)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+/**
+ * @brief Doubles the capacity of the hash table of @p set, reinserting its keys.
+ *
+ * @param set
+ */
+void lp_set_grow(StateSet set)
+{
+    free(set->table);
+    set->capacity *= 2;
+    set->table = (long *)malloc(set->capacity * sizeof(long));
+    for (long slot = 0; slot < set->capacity; slot++)
+        set->table[slot] = -1;
+    for (long index = 0; index < set->size; index++)
+        set->table[lp_set_find_slot(set, set->keys + index * set->key_size)] = index;
+}
+
+bool lp_set_insert(StateSet set, const unsigned *key)
+{
+    if (2 * (set->size + 1) > set->capacity)
+        lp_set_grow(set);
+    long slot = lp_set_find_slot(set, key);
+    if (set->table[slot] != -1)
+        return false;
+    if (set->size == set->key_capacity)
+    {
+        set->key_capacity *= 2;
+        set->keys = (unsigned *)realloc(set->keys, set->key_capacity * set->key_size * sizeof(unsigned));
+    }
+    memcpy(set->keys + set->size * set->key_size, key, set->key_size * sizeof(unsigned));
+    set->table[slot] = set->size++;
+    return true;
+}
+
+bool lp_set_contains(StateSet set, const unsigned *key)
+{
+    return set->table[lp_set_find_slot(set, key)] != -1;
+}
+
+long lp_set_find(StateSet set, const unsigned *key)
+{
+    return set->table[lp_set_find_slot(set, key)];
+}
+
+const unsigned *lp_set_get(StateSet set, long index)
+{
+    return set->keys + index * set->key_size;
+}
+
+long lp_set_size(StateSet set)
+{
+    return set->size;
+}
@@ -8,7 +8,7 @@
 #include <assert.h>
 
 /**
- * @brief Creates a formula containing only the variable representing that node @p node has color @p color.
+ * @brief Creates a formula containing only the variable representing that node @p node has color @p color. The formula is kept (see keep_formula).
  * 
  * @param ctx The solver context.
  * @param node A node.
@@ -19,11 +19,11 @@ Z3_ast variable_node_color(Z3_context ctx, int node, int color)
 {
     char name[40];
     snprintf(name, 40, "node %d, color %d", node, color);
-    return mk_bool_var(ctx, name);
+    return keep_formula(ctx, mk_bool_var(ctx, name));
 }
 
 /**
- * @brief Creates the formula stating that the edge (@p node1,@p node2) has its ends of different colours.
+ * @brief Creates the formula stating that the edge (@p node1,@p node2) has its ends of different colours. The formula is kept.
  * 
  * @param ctx The solver context.
  * @param node1 A node.
@@ -36,16 +36,23 @@ Z3_ast edge_formula(Z3_context ctx, int node1, int node2, int num_colours)
     Z3_ast edge_diff[num_colours];
     for (int colour = 0; colour < num_colours; colour++)
     {
+        Z3_ast colours[2];
+        colours[0] = variable_node_color(ctx, node1, colour);
+        colours[1] = variable_node_color(ctx, node2, colour);
         Z3_ast col_diff[2];
-        col_diff[0] = Z3_mk_not(ctx, variable_node_color(ctx, node1, colour));
-        col_diff[1] = Z3_mk_not(ctx, variable_node_color(ctx, node2, colour));
-        edge_diff[colour] = Z3_mk_or(ctx, 2, col_diff);
+        col_diff[0] = keep_formula(ctx, Z3_mk_not(ctx, colours[0]));
+        col_diff[1] = keep_formula(ctx, Z3_mk_not(ctx, colours[1]));
+        edge_diff[colour] = keep_formula(ctx, Z3_mk_or(ctx, 2, col_diff));
+        release_formulae(ctx, col_diff, 2);
+        release_formulae(ctx, colours, 2);
     }
-    return Z3_mk_and(ctx, num_colours, edge_diff);
+    Z3_ast formula = keep_formula(ctx, Z3_mk_and(ctx, num_colours, edge_diff));
+    release_formulae(ctx, edge_diff, num_colours);
+    return formula;
 }
 
 /**
- * @brief Creates the formula stating that all edges have their ends of different colours.
+ * @brief Creates the formula stating that all edges have their ends of different colours. The formula is kept.
  * 
  * @param ctx The solver context.
  * @param graph A ColouredGraph.
@@ -56,7 +63,7 @@ Z3_ast edges_have_different_colours_formula(Z3_context ctx, const ColouredGraph
 {
     int num_nodes = cg_get_num_nodes(graph);
     int current = 0;
-    Z3_ast edges_formula[num_nodes * num_nodes];
+    Z3_ast *edges_formula = (Z3_ast *)malloc((num_nodes * (num_nodes - 1) / 2 + 1) * sizeof(Z3_ast));
     for (int node1 = 0; node1 < num_nodes; node1++)
     {
         for (int node2 = node1 + 1; node2 < num_nodes; node2++)
@@ -67,11 +74,14 @@ Z3_ast edges_have_different_colours_formula(Z3_context ctx, const ColouredGraph
             current++;
         }
     }
-    return Z3_mk_and(ctx, current, edges_formula);
+    Z3_ast formula = keep_formula(ctx, Z3_mk_and(ctx, current, edges_formula));
+    release_formulae(ctx, edges_formula, current);
+    free(edges_formula);
+    return formula;
 }
 
 /**
- * @brief Creates a formula stating that every node has exactly one colour.
+ * @brief Creates a formula stating that every node has exactly one colour. The formula is kept.
  * 
  * @param ctx The solver context.
  * @param num_nodes The number of nodes.
@@ -81,7 +91,7 @@ Z3_ast edges_have_different_colours_formula(Z3_context ctx, const ColouredGraph
 Z3_ast each_node_has_one_colour_formula(Z3_context ctx, int num_nodes, int num_colours)
 {
 
-    Z3_ast nodes_coloured[num_nodes];
+    Z3_ast *nodes_coloured = (Z3_ast *)malloc((num_nodes + 1) * sizeof(Z3_ast));
     for (int node = 0; node < num_nodes; node++)
     {
         Z3_ast node_color_vars[num_colours];
@@ -89,9 +99,13 @@ Z3_ast each_node_has_one_colour_formula(Z3_context ctx, int num_nodes, int num_c
         {
             node_color_vars[colour] = variable_node_color(ctx, node, colour);
         }
-        nodes_coloured[node] = uniqueFormula(ctx, node_color_vars, num_colours);
+        nodes_coloured[node] = keep_formula(ctx, uniqueFormula(ctx, node_color_vars, num_colours));
+        release_formulae(ctx, node_color_vars, num_colours);
     }
-    return Z3_mk_and(ctx, num_nodes, nodes_coloured);
+    Z3_ast formula = keep_formula(ctx, Z3_mk_and(ctx, num_nodes, nodes_coloured));
+    release_formulae(ctx, nodes_coloured, num_nodes);
+    free(nodes_coloured);
+    return formula;
 }
 
 Z3_ast colouring_reduction(Z3_context ctx, const ColouredGraph graph, int num_colours)
@@ -100,7 +114,9 @@ Z3_ast colouring_reduction(Z3_context ctx, const ColouredGraph graph, int num_co
     Z3_ast result[2];
     result[0] = edges_have_different_colours_formula(ctx, graph, num_colours);
     result[1] = each_node_has_one_colour_formula(ctx, num_nodes, num_colours);
-    return Z3_mk_and(ctx, 2, result);
+    Z3_ast formula = keep_formula(ctx, Z3_mk_and(ctx, 2, result));
+    release_formulae(ctx, result, 2);
+    return formula;
 }
 
 void colour_graph_from_model(Z3_context ctx, Z3_model model, ColouredGraph graph, int num_colours)
@@ -110,7 +126,10 @@ void colour_graph_from_model(Z3_context ctx, Z3_model model, ColouredGraph graph
     {
         for (int colour = 0; colour < num_colours; colour++)
         {
-            if (value_of_var_in_model(ctx, model, variable_node_color(ctx, node, colour)))
+            Z3_ast variable = variable_node_color(ctx, node, colour);
+            bool coloured = value_of_var_in_model(ctx, model, variable);
+            release_formula(ctx, variable);
+            if (coloured)
             {
                 cg_set_node_colour(graph, node, colour);
                 break;
@@ -124,5 +143,9 @@ void colouring_print_model(Z3_context ctx, Z3_model model, ColouredGraph graph,
     int num_nodes = cg_get_num_nodes(graph);
     for (int node = 0; node < num_nodes; node++)
         for (int colour = 0; colour < num_colours; colour++)
-            printf("[%d:%d] = %d\n", node, colour, value_of_var_in_model(ctx, model, variable_node_color(ctx, node, colour)));
+        {
+            Z3_ast variable = variable_node_color(ctx, node, colour);
+            printf("[%d:%d] = %d\n", node, colour, value_of_var_in_model(ctx, model, variable));
+            release_formula(ctx, variable);
+        }
 }
\ No newline at end of file
@@ -0,0 +1,336 @@
+#include "Cardinality.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+card_encoding card_select(int size, int k)
+{
+    if (k == 1)
+    {
+        if (size <= 6)
+            return CARD_PAIRWISE;
+        return size <= 128 ? CARD_COMMANDER : CARD_PRODUCT;
+    }
+    return CARD_TOTALISER;
+}
+
+/**
+ * @brief Pairwise encoding of at most one: the disjunction of the negations of each pair.
+ *
+ * @param builder
+ * @param size
+ * @param formulae
+ * @return fb_node
+ */
+fb_node card_pairwise(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    if (size < 2)
+        return FB_TRUE;
+    fb_node *pairs = (fb_node *)malloc((long)size * (size - 1) / 2 * sizeof(fb_node));
+    long count = 0;
+    for (int i = 0; i < size; i++)
+        for (int j = 0; j < i; j++)
+            pairs[count++] = fb_or(builder, 2, (fb_node[]){fb_not(formulae[i]), fb_not(formulae[j])});
+    fb_node result = fb_and(builder, count, pairs);
+    free(pairs);
+    return result;
+}
+
+/**
+ * @brief Sequential counter encoding of at most @p k: after each formula, counts[j] states that at least j + 1 of the formulae seen so far are true (up to k + 1).
+ * The registers are shared (see fb_share): each one is the disjunction of two formulae, not of all the carries so far.
+ *
+ * @param builder
+ * @param size
+ * @param formulae
+ * @param k
+ * @return fb_node
+ */
+fb_node card_sequential(FormulaBuilder builder, int size, const fb_node *formulae, int k)
+{
+    fb_node *counts = (fb_node *)malloc((k + 1) * sizeof(fb_node));
+    for (int j = 0; j <= k; j++)
+        counts[j] = FB_FALSE;
+    for (int i = 0; i < size; i++)
+        // Downwards, so that counts[j - 1] is still the count before formula i.
+        for (int j = (i < k ? i : k); j >= 0; j--)
+        {
+            fb_node carried = j == 0 ? formulae[i] : fb_and(builder, 2, (fb_node[]){counts[j - 1], formulae[i]});
+            counts[j] = fb_share(builder, fb_or(builder, 2, (fb_node[]){counts[j], carried}));
+        }
+    fb_node result = fb_not(counts[k]);
+    free(counts);
+    return result;
+}
+
+/**
+ * @brief Writes in @p outputs the unary count of the formulae of @p formulae: outputs[j] states that at least j + 1 of them are true. The count is truncated to @p k + 1.
+ * The outputs are shared (see fb_share), so that the outputs of the parent do not copy the ones of the children.
+ *
+ * @param builder
+ * @param size At least 1.
+ * @param formulae
+ * @param k
+ * @param outputs An array of size at least @p k + 1.
+ * @return int The number of outputs written.
+ */
+int card_totaliser_count(FormulaBuilder builder, int size, const fb_node *formulae, int k, fb_node *outputs)
+{
+    if (size == 1)
+    {
+        outputs[0] = formulae[0];
+        return 1;
+    }
+    fb_node *left = (fb_node *)malloc((k + 1) * sizeof(fb_node));
+    fb_node *right = (fb_node *)malloc((k + 1) * sizeof(fb_node));
+    fb_node *terms = (fb_node *)malloc((k + 2) * sizeof(fb_node));
+    int num_left = card_totaliser_count(builder, size / 2, formulae, k, left);
+    int num_right = card_totaliser_count(builder, size - size / 2, formulae + size / 2, k, right);
+    int num_outputs = num_left + num_right < k + 1 ? num_left + num_right : k + 1;
+    for (int j = 1; j <= num_outputs; j++)
+    {
+        // At least j: at least a on the left and j - a on the right, for some a.
+        int count = 0;
+        for (int a = 0; a <= j && a <= num_left; a++)
+        {
+            int b = j - a;
+            if (b > num_right)
+                continue;
+            if (a == 0)
+                terms[count++] = right[b - 1];
+            else if (b == 0)
+                terms[count++] = left[a - 1];
+            else
+                terms[count++] = fb_and(builder, 2, (fb_node[]){left[a - 1], right[b - 1]});
+        }
+        outputs[j - 1] = fb_share(builder, fb_or(builder, count, terms));
+    }
+    free(left);
+    free(right);
+    free(terms);
+    return num_outputs;
+}
+
+/**
+ * @brief Totaliser encoding of at most @p k: no k + 1-th output of the unary count (see card_totaliser_count).
+ *
+ * @param builder
+ * @param size At least @p k + 1.
+ * @param formulae
+ * @param k
+ * @return fb_node
+ */
+fb_node card_totaliser(FormulaBuilder builder, int size, const fb_node *formulae, int k)
+{
+    fb_node *outputs = (fb_node *)malloc((k + 1) * sizeof(fb_node));
+    int num_outputs = card_totaliser_count(builder, size, formulae, k, outputs);
+    fb_node result = num_outputs == k + 1 ? fb_not(outputs[k]) : FB_TRUE;
+    free(outputs);
+    return result;
+}
+
+/**
+ * @brief Commander encoding of at most one: pairwise in each group of three formulae, and recursively among the disjunctions of the groups (their commanders).
+ *
+ * @param builder
+ * @param size
+ * @param formulae
+ * @return fb_node
+ */
+fb_node card_commander(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    if (size <= 3)
+        return card_pairwise(builder, size, formulae);
+    int num_groups = (size + 2) / 3;
+    fb_node *commanders = (fb_node *)malloc(num_groups * sizeof(fb_node));
+    fb_node *parts = (fb_node *)malloc((num_groups + 1) * sizeof(fb_node));
+    for (int group = 0; group < num_groups; group++)
+    {
+        int group_size = size - 3 * group < 3 ? size - 3 * group : 3;
+        commanders[group] = fb_share(builder, fb_or(builder, group_size, formulae + 3 * group));
+        parts[group] = card_pairwise(builder, group_size, formulae + 3 * group);
+    }
+    parts[num_groups] = card_commander(builder, num_groups, commanders);
+    fb_node result = fb_and(builder, num_groups + 1, parts);
+    free(commanders);
+    free(parts);
+    return result;
+}
+
+/**
+ * @brief Product encoding of at most one: the formulae are laid on a grid of about sqrt(@p size) rows and columns, and at most one row and at most one column (recursively) contain a true formula.
+ * Two true formulae differ either by their row or by their column.
+ *
+ * @param builder
+ * @param size
+ * @param formulae
+ * @return fb_node
+ */
+fb_node card_product(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    if (size <= 4)
+        return card_pairwise(builder, size, formulae);
+    int num_rows = 1;
+    while (num_rows * num_rows < size)
+        num_rows++;
+    int num_columns = (size + num_rows - 1) / num_rows;
+    fb_node *rows = (fb_node *)malloc(num_rows * sizeof(fb_node));
+    fb_node *columns = (fb_node *)malloc(num_columns * sizeof(fb_node));
+    fb_node *line = (fb_node *)malloc(num_rows * sizeof(fb_node));
+    for (int row = 0; row < num_rows; row++)
+    {
+        int start = row * num_columns;
+        int length = size - start < num_columns ? size - start : num_columns;
+        rows[row] = fb_share(builder, fb_or(builder, length > 0 ? length : 0, formulae + start));
+    }
+    for (int column = 0; column < num_columns; column++)
+    {
+        int length = 0;
+        for (int index = column; index < size; index += num_columns)
+            line[length++] = formulae[index];
+        columns[column] = fb_share(builder, fb_or(builder, length, line));
+    }
+    fb_node result = fb_and(builder, 2, (fb_node[]){card_product(builder, num_rows, rows), card_product(builder, num_columns, columns)});
+    free(rows);
+    free(columns);
+    free(line);
+    return result;
+}
+
+/**
+ * @brief Bimander encoding of at most one: pairwise in each pair of formulae, and for each bit of the number of the pairs, the pairs having this bit and the pairs not having it do not both have a true formula.
+ * Two distinct pairs differ by at least one bit.
+ *
+ * @param builder
+ * @param size
+ * @param formulae
+ * @return fb_node
+ */
+fb_node card_bimander(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    int num_groups = (size + 1) / 2;
+    int num_bits = 0;
+    while ((1 << num_bits) < num_groups)
+        num_bits++;
+    fb_node *groups = (fb_node *)malloc((num_groups + 1) * sizeof(fb_node));
+    fb_node *with = (fb_node *)malloc((num_groups + 1) * sizeof(fb_node));
+    fb_node *without = (fb_node *)malloc((num_groups + 1) * sizeof(fb_node));
+    fb_node *parts = (fb_node *)malloc((num_groups + num_bits + 1) * sizeof(fb_node));
+    int count = 0;
+    for (int group = 0; group < num_groups; group++)
+    {
+        int group_size = size - 2 * group < 2 ? size - 2 * group : 2;
+        groups[group] = fb_share(builder, fb_or(builder, group_size, formulae + 2 * group));
+        parts[count++] = card_pairwise(builder, group_size, formulae + 2 * group);
+    }
+    for (int bit = 0; bit < num_bits; bit++)
+    {
+        int num_with = 0;
+        int num_without = 0;
+        for (int group = 0; group < num_groups; group++)
+        {
+            if ((group >> bit) & 1)
+                with[num_with++] = groups[group];
+            else
+                without[num_without++] = groups[group];
+        }
+        parts[count++] = fb_or(builder, 2, (fb_node[]){fb_not(fb_or(builder, num_with, with)), fb_not(fb_or(builder, num_without, without))});
+    }
+    fb_node result = fb_and(builder, count, parts);
+    free(groups);
+    free(with);
+    free(without);
+    free(parts);
+    return result;
+}
+
+fb_node card_at_most_k(FormulaBuilder builder, int size, const fb_node *formulae, int k, card_encoding encoding)
+{
+    if (k < 0)
+        return FB_FALSE;
+    if (k >= size)
+        return FB_TRUE;
+    if (k == 0)
+    {
+        fb_node *negated = (fb_node *)malloc(size * sizeof(fb_node));
+        for (int i = 0; i < size; i++)
+            negated[i] = fb_not(formulae[i]);
+        fb_node result = fb_and(builder, size, negated);
+        free(negated);
+        return result;
+    }
+    bool at_most_one_only = encoding == CARD_PAIRWISE || encoding == CARD_COMMANDER || encoding == CARD_PRODUCT || encoding == CARD_BIMANDER;
+    if (encoding == CARD_AUTO || (at_most_one_only && k != 1))
+        encoding = card_select(size, k);
+    switch (encoding)
+    {
+    case CARD_PAIRWISE:
+        return card_pairwise(builder, size, formulae);
+    case CARD_SEQUENTIAL:
+        return card_sequential(builder, size, formulae, k);
+    case CARD_TOTALISER:
+        return card_totaliser(builder, size, formulae, k);
+    case CARD_COMMANDER:
+        return card_commander(builder, size, formulae);
+    case CARD_PRODUCT:
+        return card_product(builder, size, formulae);
+    case CARD_BIMANDER:
+        return card_bimander(builder, size, formulae);
+    case CARD_NATIVE:
+    default:
+        return fb_at_most(builder, size, formulae, k);
+    }
+}
+
+fb_node card_at_most_one(FormulaBuilder builder, int size, const fb_node *formulae, card_encoding encoding)
+{
+    return card_at_most_k(builder, size, formulae, 1, encoding);
+}
+
+fb_node card_exactly_one(FormulaBuilder builder, int size, const fb_node *formulae, card_encoding encoding)
+{
+    return fb_and(builder, 2, (fb_node[]){fb_or(builder, size, formulae), card_at_most_one(builder, size, formulae, encoding)});
+}
+
+/**
+ * @brief Builds the constraint that at most @p k (exactly one if @p exactly) of the formulae of @p formulae are true over the variables "card input N", lowers it, and replaces the variables by the formulae.
+ *
+ * @param ctx
+ * @param size
+ * @param formulae
+ * @param k
+ * @param exactly
+ * @param encoding
+ * @return Z3_ast The formula, the last one created.
+ */
+Z3_ast card_z3_constraint(Z3_context ctx, int size, Z3_ast *formulae, int k, bool exactly, card_encoding encoding)
+{
+    FormulaBuilder builder = fb_create();
+    fb_node *inputs = (fb_node *)malloc((size + 1) * sizeof(fb_node));
+    Z3_ast *variables = (Z3_ast *)malloc((size + 1) * sizeof(Z3_ast));
+    for (int i = 0; i < size; i++)
+    {
+        char name[40];
+        snprintf(name, 40, "card input %d", i);
+        inputs[i] = fb_var(builder, name);
+    }
+    fb_node root = exactly ? card_exactly_one(builder, size, inputs, encoding) : card_at_most_k(builder, size, inputs, k, encoding);
+    Z3_ast lowered = fb_to_z3(builder, ctx, root);
+    for (int i = 0; i < size; i++)
+        variables[i] = fb_to_z3(builder, ctx, inputs[i]);
+    // Releasing does not create formulae, so the substituted formula stays alive until the next call creating one.
+    Z3_ast result = Z3_substitute(ctx, lowered, size, variables, formulae);
+    fb_delete(builder);
+    free(inputs);
+    free(variables);
+    return result;
+}
+
+Z3_ast card_z3_at_most_k(Z3_context ctx, int size, Z3_ast *formulae, int k, card_encoding encoding)
+{
+    return card_z3_constraint(ctx, size, formulae, k, false, encoding);
+}
+
+Z3_ast card_z3_exactly_one(Z3_context ctx, int size, Z3_ast *formulae, card_encoding encoding)
+{
+    return card_z3_constraint(ctx, size, formulae, 1, true, encoding);
+}
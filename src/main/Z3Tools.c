@@ -1,8 +1,20 @@
-
 #include "Z3Tools.h"
+#include "Cardinality.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+
+/**
+ * @brief The context and solver reused by the calling thread (see pooled_context).
+ */
+typedef struct
+{
+    Z3_context context; ///< The pooled context (NULL until first used).
+    Z3_solver solver;   ///< The pooled solver of the context (NULL until first used).
+} solver_pool;
+
+static _Thread_local solver_pool pool = {NULL, NULL};
 
 Z3_context make_context(void)
 {
@@ -12,6 +24,73 @@ Z3_context make_context(void)
     return ctx;
 }
 
+Z3_context make_context_rc(void)
+{
+    Z3_config config = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context_rc(config);
+    Z3_del_config(config);
+    return ctx;
+}
+
+Z3_ast keep_formula(Z3_context ctx, Z3_ast formula)
+{
+    Z3_inc_ref(ctx, formula);
+    return formula;
+}
+
+void release_formula(Z3_context ctx, Z3_ast formula)
+{
+    Z3_dec_ref(ctx, formula);
+}
+
+void release_formulae(Z3_context ctx, Z3_ast *formulae, int size)
+{
+    for (int i = 0; i < size; i++)
+        Z3_dec_ref(ctx, formulae[i]);
+}
+
+Z3_context pooled_context(void)
+{
+    if (pool.context == NULL)
+        pool.context = make_context_rc();
+    return pool.context;
+}
+
+Z3_solver pooled_solver(Z3_context ctx)
+{
+    if (ctx != pool.context)
+    {
+        Z3_solver s = Z3_mk_solver(ctx);
+        Z3_solver_inc_ref(ctx, s);
+        return s;
+    }
+    if (pool.solver == NULL)
+    {
+        pool.solver = Z3_mk_solver(ctx);
+        Z3_solver_inc_ref(ctx, pool.solver);
+    }
+    else
+        Z3_solver_reset(ctx, pool.solver);
+    Z3_solver_inc_ref(ctx, pool.solver);
+    return pool.solver;
+}
+
+void reset_pool(void)
+{
+    if (pool.solver != NULL)
+        Z3_solver_reset(pool.context, pool.solver);
+}
+
+void free_pool(void)
+{
+    if (pool.solver != NULL)
+        Z3_solver_dec_ref(pool.context, pool.solver);
+    if (pool.context != NULL)
+        Z3_del_context(pool.context);
+    pool.solver = NULL;
+    pool.context = NULL;
+}
+
 Z3_ast mk_var(Z3_context ctx, const char *name, Z3_sort ty)
 {
     Z3_symbol s = Z3_mk_string_symbol(ctx, name);
@@ -26,38 +105,25 @@ Z3_ast mk_bool_var(Z3_context ctx, const char *name)
 
 Z3_ast uniqueFormula(Z3_context ctx, Z3_ast *formulae, int size)
 {
-    Z3_ast result[size * size];
-    result[0] = Z3_mk_or(ctx, size, formulae);
-    int count = 1;
-    for (int i = 0; i < size; i++)
-    {
-        for (int j = 0; j < i; j++)
-        {
-            Z3_ast subFor[2];
-            subFor[0] = Z3_mk_not(ctx, formulae[j]);
-            subFor[1] = Z3_mk_not(ctx, formulae[i]);
-            result[count] = Z3_mk_or(ctx, 2, subFor);
-            count++;
-        }
-    }
-    return Z3_mk_and(ctx, count, result);
+    return card_z3_exactly_one(ctx, size, formulae, CARD_AUTO);
 }
 
 Z3_lbool is_formula_sat(Z3_context ctx, Z3_ast formula)
 {
-    Z3_solver s = Z3_mk_solver(ctx);
-    Z3_solver_inc_ref(ctx, s);
+    keep_formula(ctx, formula);
+    Z3_solver s = pooled_solver(ctx);
     Z3_solver_assert(ctx, s, formula);
 
     Z3_lbool result = Z3_solver_check(ctx, s);
     Z3_solver_dec_ref(ctx, s);
+    release_formula(ctx, formula);
     return result;
 }
 
 Z3_model get_model_from_sat_formula(Z3_context ctx, Z3_ast formula)
 {
-    Z3_solver s = Z3_mk_solver(ctx);
-    Z3_solver_inc_ref(ctx, s);
+    keep_formula(ctx, formula);
+    Z3_solver s = pooled_solver(ctx);
     Z3_solver_assert(ctx, s, formula);
 
     Z3_model m = 0;
@@ -80,13 +146,14 @@ Z3_model get_model_from_sat_formula(Z3_context ctx, Z3_ast formula)
     if (m)
         Z3_model_inc_ref(ctx, m);
     Z3_solver_dec_ref(ctx, s);
+    release_formula(ctx, formula);
     return m;
 }
 
 Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model)
 {
-    Z3_solver s = Z3_mk_solver(ctx);
-    Z3_solver_inc_ref(ctx, s);
+    keep_formula(ctx, formula);
+    Z3_solver s = pooled_solver(ctx);
     Z3_solver_assert(ctx, s, formula);
 
     Z3_lbool result = Z3_solver_check(ctx, s);
@@ -106,6 +173,7 @@ Z3_lbool solve_formula(Z3_context ctx, Z3_ast formula, Z3_model *model)
     }
 
     Z3_solver_dec_ref(ctx, s);
+    release_formula(ctx, formula);
     return result;
 }
 
@@ -119,11 +187,598 @@ bool value_of_var_in_model(Z3_context ctx, Z3_model model, Z3_ast variable)
         return false;
     }
 
-    if (Z3_mk_true(ctx) == result)
+    switch (Z3_get_bool_value(ctx, result))
+    {
+    case Z3_L_TRUE:
         return true;
-    if (Z3_mk_false(ctx) == result)
+    case Z3_L_FALSE:
         return false;
+    default:
+        fprintf(stderr, "Error: Used on a non-boolean formula, or other unknown error\n");
+        exit(1);
+    }
+}
 
-    fprintf(stderr, "Error: Used on a non-boolean formula, or other unknown error\n");
-    exit(1);
+/**
+ * @brief The kinds of nodes of a FormulaBuilder.
+ */
+typedef enum
+{
+    FB_KIND_TRUE,     ///< The constant true (node 1).
+    FB_KIND_VARIABLE, ///< A variable, named.
+    FB_KIND_AND,      ///< The conjunction of its children.
+    FB_KIND_IFF,      ///< The equivalence of its two children.
+    FB_KIND_AT_MOST,  ///< At most bound of its children are true.
+    FB_KIND_SHARED    ///< Its only child, a conjunction, not flattened into the conjunctions using it (see fb_share).
+} fb_kind;
+
+/**
+ * @brief A node of a FormulaBuilder.
+ */
+typedef struct
+{
+    fb_kind kind; ///< The kind of the node.
+    int size;     ///< The number of children (0 for constants and variables).
+    long first;   ///< The position of the first child in the children of the builder (of the name in its names for a variable).
+    int bound;    ///< For an at-most node, the number of children which may be true (0 otherwise).
+    int next;     ///< The next node in the same bucket of the unique table (0 if last).
+} fb_entry;
+
+struct FormulaBuilder_s
+{
+    fb_entry *nodes;     ///< The nodes (0 is unused, 1 is true).
+    int num_nodes;       ///< The number of nodes.
+    int cap_nodes;       ///< The capacity of nodes.
+    fb_node *children;   ///< The children of all the nodes, sorted and contiguous for each node.
+    long num_children;   ///< The number of children.
+    long cap_children;   ///< The capacity of children.
+    char *names;         ///< The names of the variables, contiguous and null-terminated.
+    long size_names;     ///< The size used in names.
+    long cap_names;      ///< The capacity of names.
+    int *buckets;        ///< The unique table: the first node of each bucket (0 if empty).
+    int num_buckets;     ///< The number of buckets (a power of 2).
+    Z3_context ctx;      ///< The context the nodes are lowered to (NULL until the first lowering).
+    Z3_ast *lowered;     ///< The kept formula of each node lowered (NULL if not lowered yet).
+    Z3_ast *negated;     ///< The kept negation of each node lowered negatively (NULL if not lowered yet).
+    int cap_lowered;     ///< The capacity of lowered and negated.
+};
+
+/**
+ * @brief Returns the bucket of a node of kind @p kind and of children @p children (or of name @p name for a variable) in the unique table of @p builder.
+ *
+ * @param builder
+ * @param kind
+ * @param children
+ * @param size The number of children.
+ * @param bound The bound of an at-most node (0 otherwise).
+ * @param name The name of a variable (NULL otherwise).
+ * @return int
+ */
+int fb_hash(FormulaBuilder builder, fb_kind kind, const fb_node *children, int size, int bound, const char *name)
+{
+    unsigned hash = ((unsigned)kind * 2654435761u) ^ (unsigned)bound;
+    for (int i = 0; i < size; i++)
+        hash = (hash ^ (unsigned)children[i]) * 16777619u;
+    for (const char *c = name; c != NULL && *c != '\0'; c++)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    return (int)(hash & (unsigned)(builder->num_buckets - 1));
+}
+
+/**
+ * @brief Returns the bucket of node @p index of @p builder.
+ *
+ * @param builder
+ * @param index
+ * @return int
+ */
+int fb_node_hash(FormulaBuilder builder, int index)
+{
+    fb_entry *entry = &builder->nodes[index];
+    if (entry->kind == FB_KIND_VARIABLE)
+        return fb_hash(builder, entry->kind, NULL, 0, 0, builder->names + entry->first);
+    return fb_hash(builder, entry->kind, builder->children + entry->first, entry->size, entry->bound, NULL);
+}
+
+/**
+ * @brief Doubles the number of buckets of the unique table of @p builder.
+ *
+ * @param builder
+ */
+void fb_grow_table(FormulaBuilder builder)
+{
+    free(builder->buckets);
+    builder->num_buckets *= 2;
+    builder->buckets = (int *)calloc(builder->num_buckets, sizeof(int));
+    for (int index = 2; index < builder->num_nodes; index++)
+    {
+        int bucket = fb_node_hash(builder, index);
+        builder->nodes[index].next = builder->buckets[bucket];
+        builder->buckets[bucket] = index;
+    }
+}
+
+/**
+ * @brief Returns the node of kind @p kind and of children @p children (or of name @p name for a variable), creating it if it does not exist yet.
+ *
+ * @param builder
+ * @param kind
+ * @param children The children, normalised by the caller.
+ * @param size The number of children.
+ * @param bound The bound of an at-most node (0 otherwise).
+ * @param name The name of a variable (NULL otherwise).
+ * @return fb_node The (positive) node.
+ */
+fb_node fb_unique(FormulaBuilder builder, fb_kind kind, const fb_node *children, int size, int bound, const char *name)
+{
+    int bucket = fb_hash(builder, kind, children, size, bound, name);
+    for (int index = builder->buckets[bucket]; index != 0; index = builder->nodes[index].next)
+    {
+        fb_entry *entry = &builder->nodes[index];
+        if (entry->kind != kind || entry->size != size || entry->bound != bound)
+            continue;
+        if (name != NULL ? strcmp(builder->names + entry->first, name) == 0 : memcmp(builder->children + entry->first, children, size * sizeof(fb_node)) == 0)
+            return index;
+    }
+
+    if (builder->num_nodes == builder->cap_nodes)
+    {
+        builder->cap_nodes *= 2;
+        builder->nodes = (fb_entry *)realloc(builder->nodes, builder->cap_nodes * sizeof(fb_entry));
+    }
+    int index = builder->num_nodes++;
+    fb_entry *entry = &builder->nodes[index];
+    entry->kind = kind;
+    entry->size = size;
+    entry->bound = bound;
+    if (name != NULL)
+    {
+        long length = strlen(name) + 1;
+        if (builder->size_names + length > builder->cap_names)
+        {
+            while (builder->size_names + length > builder->cap_names)
+                builder->cap_names *= 2;
+            builder->names = (char *)realloc(builder->names, builder->cap_names);
+        }
+        entry->first = builder->size_names;
+        memcpy(builder->names + builder->size_names, name, length);
+        builder->size_names += length;
+    }
+    else
+    {
+        if (builder->num_children + size > builder->cap_children)
+        {
+            while (builder->num_children + size > builder->cap_children)
+                builder->cap_children *= 2;
+            builder->children = (fb_node *)realloc(builder->children, builder->cap_children * sizeof(fb_node));
+        }
+        entry->first = builder->num_children;
+        memcpy(builder->children + builder->num_children, children, size * sizeof(fb_node));
+        builder->num_children += size;
+    }
+    entry->next = builder->buckets[bucket];
+    builder->buckets[bucket] = index;
+    if (builder->num_nodes > 2 * builder->num_buckets)
+        fb_grow_table(builder);
+    return index;
+}
+
+FormulaBuilder fb_create(void)
+{
+    FormulaBuilder builder = (FormulaBuilder)malloc(sizeof(struct FormulaBuilder_s));
+    builder->cap_nodes = 1024;
+    builder->nodes = (fb_entry *)malloc(builder->cap_nodes * sizeof(fb_entry));
+    builder->num_nodes = 2;
+    builder->nodes[1].kind = FB_KIND_TRUE;
+    builder->nodes[1].size = 0;
+    builder->nodes[1].first = 0;
+    builder->nodes[1].bound = 0;
+    builder->nodes[1].next = 0;
+    builder->cap_children = 4096;
+    builder->children = (fb_node *)malloc(builder->cap_children * sizeof(fb_node));
+    builder->num_children = 0;
+    builder->cap_names = 16384;
+    builder->names = (char *)malloc(builder->cap_names);
+    builder->size_names = 0;
+    builder->num_buckets = 1024;
+    builder->buckets = (int *)calloc(builder->num_buckets, sizeof(int));
+    builder->ctx = NULL;
+    builder->lowered = NULL;
+    builder->negated = NULL;
+    builder->cap_lowered = 0;
+    return builder;
+}
+
+void fb_delete(FormulaBuilder builder)
+{
+    for (int index = 0; index < builder->cap_lowered; index++)
+    {
+        if (builder->lowered[index] != NULL)
+            release_formula(builder->ctx, builder->lowered[index]);
+        if (builder->negated[index] != NULL)
+            release_formula(builder->ctx, builder->negated[index]);
+    }
+    free(builder->lowered);
+    free(builder->negated);
+    free(builder->nodes);
+    free(builder->children);
+    free(builder->names);
+    free(builder->buckets);
+    free(builder);
+}
+
+int fb_num_nodes(FormulaBuilder builder)
+{
+    return builder->num_nodes - 1;
+}
+
+fb_node fb_var(FormulaBuilder builder, const char *name)
+{
+    return fb_unique(builder, FB_KIND_VARIABLE, NULL, 0, 0, name);
+}
+
+fb_node fb_not(fb_node f)
+{
+    return -f;
+}
+
+/**
+ * @brief Orders nodes by number, a node right before its negation.
+ *
+ * @param a A pointer to a fb_node.
+ * @param b A pointer to a fb_node.
+ * @return int
+ */
+int fb_compare(const void *a, const void *b)
+{
+    fb_node x = *(const fb_node *)a;
+    fb_node y = *(const fb_node *)b;
+    if (abs(x) != abs(y))
+        return abs(x) < abs(y) ? -1 : 1;
+    return (x < y) - (x > y);
+}
+
+fb_node fb_and(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    long total = 0;
+    for (int i = 0; i < size; i++)
+    {
+        if (formulae[i] == FB_FALSE)
+            return FB_FALSE;
+        if (formulae[i] > 0 && builder->nodes[formulae[i]].kind == FB_KIND_AND)
+            total += builder->nodes[formulae[i]].size;
+        else
+            total++;
+    }
+    fb_node *flat = (fb_node *)malloc((total + 1) * sizeof(fb_node));
+    int count = 0;
+    for (int i = 0; i < size; i++)
+    {
+        fb_node f = formulae[i];
+        if (f == FB_TRUE)
+            continue;
+        if (f > 0 && builder->nodes[f].kind == FB_KIND_AND)
+        {
+            memcpy(flat + count, builder->children + builder->nodes[f].first, builder->nodes[f].size * sizeof(fb_node));
+            count += builder->nodes[f].size;
+        }
+        else
+            flat[count++] = f;
+    }
+    qsort(flat, count, sizeof(fb_node), fb_compare);
+    int unique = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (unique > 0 && flat[unique - 1] == flat[i])
+            continue;
+        if (unique > 0 && flat[unique - 1] == -flat[i])
+        {
+            free(flat);
+            return FB_FALSE;
+        }
+        flat[unique++] = flat[i];
+    }
+    fb_node result = unique == 0 ? FB_TRUE : (unique == 1 ? flat[0] : fb_unique(builder, FB_KIND_AND, flat, unique, 0, NULL));
+    free(flat);
+    return result;
+}
+
+fb_node fb_or(FormulaBuilder builder, int size, const fb_node *formulae)
+{
+    fb_node *negated = (fb_node *)malloc((size + 1) * sizeof(fb_node));
+    for (int i = 0; i < size; i++)
+        negated[i] = -formulae[i];
+    fb_node result = -fb_and(builder, size, negated);
+    free(negated);
+    return result;
+}
+
+fb_node fb_implies(FormulaBuilder builder, fb_node premise, fb_node conclusion)
+{
+    return fb_or(builder, 2, (fb_node[]){-premise, conclusion});
+}
+
+fb_node fb_iff(FormulaBuilder builder, fb_node f, fb_node g)
+{
+    if (f == FB_TRUE || f == FB_FALSE)
+        return f == FB_TRUE ? g : -g;
+    if (g == FB_TRUE || g == FB_FALSE)
+        return g == FB_TRUE ? f : -f;
+    if (f == g || f == -g)
+        return f == g ? FB_TRUE : FB_FALSE;
+    // (¬f ⇔ g) is ¬(f ⇔ g): the children are stored positive, the sign goes on the node.
+    int sign = (f < 0) == (g < 0) ? 1 : -1;
+    fb_node children[2] = {abs(f) < abs(g) ? abs(f) : abs(g), abs(f) < abs(g) ? abs(g) : abs(f)};
+    return sign * fb_unique(builder, FB_KIND_IFF, children, 2, 0, NULL);
+}
+
+fb_node fb_share(FormulaBuilder builder, fb_node f)
+{
+    if (builder->nodes[abs(f)].kind != FB_KIND_AND)
+        return f;
+    fb_node child = abs(f);
+    return (f > 0 ? 1 : -1) * fb_unique(builder, FB_KIND_SHARED, &child, 1, 0, NULL);
+}
+
+fb_node fb_at_most(FormulaBuilder builder, int size, const fb_node *formulae, int bound)
+{
+    fb_node *children = (fb_node *)malloc((size + 1) * sizeof(fb_node));
+    int count = 0;
+    for (int i = 0; i < size; i++)
+    {
+        if (formulae[i] == FB_TRUE)
+            bound--;
+        else if (formulae[i] != FB_FALSE)
+            children[count++] = formulae[i];
+    }
+    fb_node result;
+    if (bound < 0)
+        result = FB_FALSE;
+    else if (bound >= count)
+        result = FB_TRUE;
+    else if (bound == 0)
+    {
+        for (int i = 0; i < count; i++)
+            children[i] = -children[i];
+        result = fb_and(builder, count, children);
+    }
+    else
+    {
+        // The order of the children does not change the count; duplicates do.
+        qsort(children, count, sizeof(fb_node), fb_compare);
+        result = fb_unique(builder, FB_KIND_AT_MOST, children, count, bound, NULL);
+    }
+    free(children);
+    return result;
+}
+
+/**
+ * @brief Returns the kept formula of the positive node @p index, lowering its children first.
+ *
+ * @param builder
+ * @param index
+ * @return Z3_ast
+ */
+Z3_ast fb_lower_node(FormulaBuilder builder, int index);
+
+/**
+ * @brief Returns the kept formula of @p f (a node or its negation). The negation of a conjunction is lowered as the disjunction of the negated children (an implication for two children, one of them positive), as it was built.
+ *
+ * @param builder
+ * @param f
+ * @return Z3_ast
+ */
+Z3_ast fb_lower(FormulaBuilder builder, fb_node f)
+{
+    if (f > 0)
+        return fb_lower_node(builder, f);
+    if (builder->negated[-f] != NULL)
+        return builder->negated[-f];
+    Z3_context ctx = builder->ctx;
+    fb_entry entry = builder->nodes[-f];
+    Z3_ast result;
+    if (entry.kind == FB_KIND_AND && entry.size == 2 && (builder->children[entry.first] > 0 || builder->children[entry.first + 1] > 0))
+    {
+        // ¬(p ∧ ¬q) is p ⇒ q: no negation of p to create.
+        int premise = builder->children[entry.first] > 0 ? 0 : 1;
+        result = Z3_mk_implies(ctx, fb_lower(builder, builder->children[entry.first + premise]), fb_lower(builder, -builder->children[entry.first + 1 - premise]));
+    }
+    else if (entry.kind == FB_KIND_AND)
+    {
+        Z3_ast *children = (Z3_ast *)malloc(entry.size * sizeof(Z3_ast));
+        for (int i = 0; i < entry.size; i++)
+            children[i] = fb_lower(builder, -builder->children[entry.first + i]);
+        result = Z3_mk_or(ctx, entry.size, children);
+        free(children);
+    }
+    else if (entry.kind == FB_KIND_SHARED)
+        result = fb_lower(builder, -builder->children[entry.first]);
+    else
+        result = Z3_mk_not(ctx, fb_lower_node(builder, -f));
+    builder->negated[-f] = keep_formula(ctx, result);
+    return builder->negated[-f];
+}
+
+Z3_ast fb_lower_node(FormulaBuilder builder, int index)
+{
+    if (builder->lowered[index] != NULL)
+        return builder->lowered[index];
+    Z3_context ctx = builder->ctx;
+    fb_entry entry = builder->nodes[index];
+    Z3_ast result;
+    if (entry.kind == FB_KIND_TRUE)
+        result = Z3_mk_true(ctx);
+    else if (entry.kind == FB_KIND_VARIABLE)
+        result = mk_bool_var(ctx, builder->names + entry.first);
+    else if (entry.kind == FB_KIND_SHARED)
+        result = fb_lower(builder, builder->children[entry.first]);
+    else
+    {
+        Z3_ast *children = (Z3_ast *)malloc(entry.size * sizeof(Z3_ast));
+        for (int i = 0; i < entry.size; i++)
+            children[i] = fb_lower(builder, builder->children[entry.first + i]);
+        if (entry.kind == FB_KIND_AND)
+            result = Z3_mk_and(ctx, entry.size, children);
+        else if (entry.kind == FB_KIND_IFF)
+            result = Z3_mk_iff(ctx, children[0], children[1]);
+        else
+            result = Z3_mk_atmost(ctx, entry.size, children, entry.bound);
+        free(children);
+    }
+    builder->lowered[index] = keep_formula(ctx, result);
+    return builder->lowered[index];
+}
+
+Z3_ast fb_to_z3(FormulaBuilder builder, Z3_context ctx, fb_node f)
+{
+    builder->ctx = ctx;
+    if (builder->cap_lowered < builder->num_nodes)
+    {
+        int capacity = builder->cap_nodes;
+        builder->lowered = (Z3_ast *)realloc(builder->lowered, capacity * sizeof(Z3_ast));
+        builder->negated = (Z3_ast *)realloc(builder->negated, capacity * sizeof(Z3_ast));
+        for (int index = builder->cap_lowered; index < capacity; index++)
+        {
+            builder->lowered[index] = NULL;
+            builder->negated[index] = NULL;
+        }
+        builder->cap_lowered = capacity;
+    }
+    return fb_lower(builder, f);
+}
+
+/**
+ * @brief Numbers, in @p ids, the nodes reachable from @p f which have not been numbered yet, children first, and counts in @p num_clauses the clauses of their Tseitin encoding.
+ * An at-most node is encoded with a sequential counter, whose variables are numbered right after the node (see fb_counter_literal). A shared node gets the literal of its child, and no clause.
+ *
+ * @param builder
+ * @param f
+ * @param ids The DIMACS literal of each node (0 if not numbered yet).
+ * @param num_vars The number of DIMACS variables so far. Updated.
+ * @param num_clauses The number of clauses so far. Updated.
+ */
+void fb_number_nodes(FormulaBuilder builder, fb_node f, int *ids, int *num_vars, long *num_clauses)
+{
+    int index = abs(f);
+    if (ids[index] != 0)
+        return;
+    fb_entry entry = builder->nodes[index];
+    for (int i = 0; i < entry.size; i++)
+        fb_number_nodes(builder, builder->children[entry.first + i], ids, num_vars, num_clauses);
+    if (entry.kind == FB_KIND_AT_MOST)
+        fb_number_nodes(builder, FB_TRUE, ids, num_vars, num_clauses);
+    if (entry.kind == FB_KIND_SHARED)
+    {
+        ids[index] = ids[builder->children[entry.first]];
+        return;
+    }
+    ids[index] = ++(*num_vars);
+    if (entry.kind == FB_KIND_TRUE)
+        *num_clauses += 1;
+    else if (entry.kind == FB_KIND_AND)
+        *num_clauses += entry.size + 1;
+    else if (entry.kind == FB_KIND_IFF)
+        *num_clauses += 4;
+    else if (entry.kind == FB_KIND_AT_MOST)
+    {
+        *num_vars += entry.size * (entry.bound + 1);
+        *num_clauses += 4L * entry.size * (entry.bound + 1) + 2;
+    }
+}
+
+/**
+ * @brief Returns the DIMACS literal stating that at least @p j of the first @p i children of an at-most node are true, in the sequential counter of the node.
+ *
+ * @param node The DIMACS variable of the node, followed by the variables of its counter.
+ * @param bound The bound of the node.
+ * @param truth The DIMACS variable of the constant true.
+ * @param i
+ * @param j Between 0 and @p bound + 1.
+ * @return int
+ */
+int fb_counter_literal(int node, int bound, int truth, int i, int j)
+{
+    if (j == 0)
+        return truth;
+    if (i == 0)
+        return -truth;
+    return node + 1 + (i - 1) * (bound + 1) + (j - 1);
+}
+
+/**
+ * @brief Returns the DIMACS literal of @p f.
+ *
+ * @param ids The DIMACS literal of each node.
+ * @param f
+ * @return int
+ */
+int fb_dimacs_literal(const int *ids, fb_node f)
+{
+    return f > 0 ? ids[f] : -ids[-f];
+}
+
+long fb_write_dimacs(FormulaBuilder builder, fb_node f, FILE *file)
+{
+    int *ids = (int *)calloc(builder->num_nodes, sizeof(int));
+    int num_vars = 0;
+    long num_clauses = 0;
+    // The conjuncts of a top-level conjunction are asserted directly, without a variable for the conjunction.
+    bool split = f > 0 && builder->nodes[f].kind == FB_KIND_AND;
+    int num_roots = split ? builder->nodes[f].size : 1;
+    const fb_node *roots = split ? builder->children + builder->nodes[f].first : &f;
+    for (int i = 0; i < num_roots; i++)
+        fb_number_nodes(builder, roots[i], ids, &num_vars, &num_clauses);
+    num_clauses += num_roots;
+
+    fprintf(file, "c Tseitin encoding of a formula of %d nodes\n", fb_num_nodes(builder));
+    for (int index = 2; index < builder->num_nodes; index++)
+        if (ids[index] != 0 && builder->nodes[index].kind == FB_KIND_VARIABLE)
+            fprintf(file, "c %d %s\n", ids[index], builder->names + builder->nodes[index].first);
+    fprintf(file, "p cnf %d %ld\n", num_vars, num_clauses);
+    for (int index = 1; index < builder->num_nodes; index++)
+    {
+        if (ids[index] == 0 || builder->nodes[index].kind == FB_KIND_SHARED)
+            continue;
+        fb_entry entry = builder->nodes[index];
+        const fb_node *children = builder->children + entry.first;
+        int node = ids[index];
+        if (entry.kind == FB_KIND_TRUE)
+            fprintf(file, "%d 0\n", node);
+        else if (entry.kind == FB_KIND_AND)
+        {
+            for (int i = 0; i < entry.size; i++)
+                fprintf(file, "%d %d 0\n", -node, fb_dimacs_literal(ids, children[i]));
+            fprintf(file, "%d", node);
+            for (int i = 0; i < entry.size; i++)
+                fprintf(file, " %d", -fb_dimacs_literal(ids, children[i]));
+            fprintf(file, " 0\n");
+        }
+        else if (entry.kind == FB_KIND_IFF)
+        {
+            int a = fb_dimacs_literal(ids, children[0]);
+            int b = fb_dimacs_literal(ids, children[1]);
+            fprintf(file, "%d %d %d 0\n%d %d %d 0\n%d %d %d 0\n%d %d %d 0\n", -node, -a, b, -node, a, -b, node, a, b, node, -a, -b);
+        }
+        else if (entry.kind == FB_KIND_AT_MOST)
+        {
+            // counter(i, j) ⇔ counter(i - 1, j) ∨ (counter(i - 1, j - 1) ∧ child i), and the node is ¬counter(size, bound + 1).
+            int truth = ids[FB_TRUE];
+            for (int i = 1; i <= entry.size; i++)
+            {
+                int x = fb_dimacs_literal(ids, children[i - 1]);
+                for (int j = 1; j <= entry.bound + 1; j++)
+                {
+                    int counter = fb_counter_literal(node, entry.bound, truth, i, j);
+                    int kept = fb_counter_literal(node, entry.bound, truth, i - 1, j);
+                    int carried = fb_counter_literal(node, entry.bound, truth, i - 1, j - 1);
+                    fprintf(file, "%d %d %d 0\n%d %d %d 0\n%d %d 0\n%d %d %d 0\n", -counter, kept, carried, -counter, kept, x, -kept, counter, -carried, -x, counter);
+                }
+            }
+            int full = fb_counter_literal(node, entry.bound, truth, entry.size, entry.bound + 1);
+            fprintf(file, "%d %d 0\n%d %d 0\n", -node, -full, node, full);
+        }
+    }
+    for (int i = 0; i < num_roots; i++)
+        fprintf(file, "%d 0\n", fb_dimacs_literal(ids, roots[i]));
+    free(ids);
+    return num_clauses;
 }
@@ -27,12 +27,26 @@
 #include "LockAutomaton.h"
 #include "DeadlockResolution.h"
 #include "DeadlockReduction.h"
+#include "DeadlockIC3.h"
+#include "LockMinimisation.h"
+#include "DeadlockScreening.h"
+#include "DeadlockCounter.h"
+#include "DeadlockCompiled.h"
+#include "DeadlockExplicit.h"
+#include "DeadlockExternal.h"
+#include "DeadlockSimulation.h"
+#include "DeadlockSymbolic.h"
+#include "DeadlockWitness.h"
+#include "DeadlockAbstraction.h"
+#include "LockOrder.h"
 #endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -76,17 +90,105 @@ void usage()
     printf(" -v         Activate verbose mode (displays parsed graphs)\n");
     printf(" -B         Solves the problem using the brute force algorithm\n");
     printf(" -R         Solves the problem using a reduction\n");
+#ifdef DEADLOCK_CHECKING
+    printf(" -E         With -R, uses the exists-step semantics for the Deadlock Checking problem: several automata acting on distinct locks may move at the same step. -c is then the number of parallel steps, and the deadlock found is linearised into a path of at least that size.\n");
+    printf(" -a         Solves the Deadlock Checking problem by abstraction refinement on the locks: the reduction to SAT only tracks some locks, and locks are added each time the solver finds a deadlock which is not one of the automata.\n");
+    printf(" -g MAX     Looks for the minimal length of a deadlock, up to MAX steps, with one incremental solver: the bound gallops (1, 2, 4, ...) until a deadlock is reachable within it, then a binary search finds the minimal one. Displays each query and its solving time.\n");
+    printf(" -O ENCODING With -R, encodes the owner of each lock instead of whether it is taken, which prunes earlier on instances with many locks. ENCODING is \"onehot\" (one variable per possible owner) or \"binary\" (the number of the owner in binary).\n");
+    printf(" -L         Runs the static lock-order analysis on the Deadlock Checking problem before any other algorithm. If it proves that no deadlock is reachable, the other algorithms are skipped. Otherwise, displays the cycles of locks and the automata possibly involved (the other algorithms still check all the automata).\n");
+    printf(" -m         Minimises the automata of the Deadlock Checking problem (bisimulation quotient) before running the algorithms. IC3 additionally gets chains of noop edges collapsed. Paths found are translated back to the original automata.\n");
+    printf(" -C         Solves the Deadlock Checking problem with the counter abstraction: identical automata (e.g. the same file given several times) are only counted in each node, which keeps the search polynomial in their number.\n");
+    printf(" -X         Solves the Deadlock Checking problem with a compiled model checker: a C program specialised for the input automata is generated, compiled with the system compiler ($CC, or cc) and run.\n");
+    printf(" -S ENGINE  Screens the Deadlock Checking problem without bound: looks for a deadlock among pairs, then triples of automata sharing locks (in parallel), then in the whole system. ENGINE is \"explicit\" (breadth-first search) or \"sat\" (IC3/PDR).\n");
+    printf(" -H BITS[,K] Looks for a deadlock without bound by bitstate hashing: a depth-first search storing each state as K bits (3 by default) of an array of 2^BITS bits. Uses bounded memory, but may miss states: displays the estimated coverage.\n");
+    printf(" -e DIR     Looks for a shortest deadlock without bound by an external-memory breadth-first search: the layers of the search are sorted files written in DIR, so that state spaces bigger than the memory can be explored exhaustively.\n");
+    printf(" -W SECONDS[,DEPTH] Hunts deadlocks by random executions (of at most DEPTH steps, 1000 by default) run in parallel with diverse scheduling biases during SECONDS seconds. Cannot prove the absence of deadlock.\n");
+    printf(" -x         Looks for a shortest deadlock without bound by a breadth-first search of the product in memory.\n");
+    printf(" -A HEURISTIC Looks for a deadlock without bound by a best-first search of the product. HEURISTIC is \"distance\" (A* on the distance of the automata to nodes where they may get stuck: finds a shortest deadlock), \"blocked\" (favours states where few automata can move) or \"locks\" (favours states where many locks are taken).\n");
+    printf(" -b         Looks for a shortest deadlock without bound by symbolic reachability: the reachable states are computed with binary decision diagrams (with dynamic variable reordering) and intersected with the deadlocked states.\n");
+    printf(" -d         Looks for a deadlock without bound backwards: the tuples of nodes where all the automata may be stuck are enumerated with binary decision diagrams, and the states which can reach each of them are computed by pre-images until the initial state is met. Cheap when few tuples of nodes can deadlock.\n");
+    printf(" -D KIND[,MAX] Looks for a deadlock without bound by iterative context bounding: explores the executions with no context switch between automata, then with one, and so on up to MAX (10 by default). KIND is \"context\" (every switch counts) or \"preemption\" (only the switches away from an automaton which could still move count). Finds the deadlock needing the fewest switches.\n");
+    printf(" -V         Replays every deadlock found on the input automata and checks that it is executable and really ends in a deadlock, to cross-check the engines.\n");
+    printf(" -w RADIUS[,sat] Shrinks the deadlocks found by -R, -W, -H, -I, -A, -d and -D: removes the cycles of states and the detours of single automata, then searches a shortest deadlock among the states at most RADIUS steps away from the path. With \"sat\", then checks with one incremental SAT search that no shorter deadlock exists.\n");
+    printf(" -K FILE[,SECONDS] Checkpoints the long searches (-x and -I) every SECONDS seconds (300 by default) in FILE.explicit and FILE.ic3.\n");
+    printf(" --resume   With -K, resumes the searches from their last checkpoint instead of restarting them.\n");
+    printf(" -I         Solves the Deadlock Checking problem without bound with the IC3/PDR algorithm (ignores -c): finds a deadlock of any length, or proves there is none. With -t, also displays the inductive invariant obtained.\n");
+#endif
     printf(" -F         Displays the formula computed ");
 #ifdef SUBJECT
     printf("(obviously not in this version)");
 #endif
-    printf(". Only active if -R is active. Writes it in a file in the folder 'sol' (see option -o)\n");
+    printf(". Only active if -R is active. Writes it in a file in the folder 'sol' (see option -o). For the Deadlock Checking problem, also writes it in CNF (DIMACS format) in NAME.cnf.\n");
     printf(" -M         Displays the model of the satisfied formula, to help understanding why it is true, especially when there are variables not representing a part of the solution.\n");
     printf(" -t         Displays the solution found [if not present, only displays the existence of the solution].\n");
     printf(" -f         Writes the result with colors in a .dot file. See next option for the name. These files will be produced in the folder 'sol'.\n");
     printf(" -o NAME    Writes the output graph in \"NAME_Brute.dot\" or \"NAME_SAT.dot\" depending of the algorithm used and the formula in \"NAME.formula\". [if not present: \"default_SAT.dot\", \"default_Brute.dot\" and \"default.formula\"]\n");
 }
 
+#ifdef DEADLOCK_CHECKING
+/**
+ * @brief Checks that @p path leads to a deadlock of @p automata (see witness_validate) and displays the verdict.
+ *
+ * @param automata The LockAutomata the path is over.
+ * @param num_automata The number of automata.
+ * @param path The path to check.
+ * @param size_path The size of @p path.
+ */
+void validate_witness(LockAutomaton *automata, int num_automata, step *path, int size_path)
+{
+    int position;
+    witness_verdict verdict = witness_validate(automata, num_automata, path, size_path, &position);
+    if (verdict == WITNESS_VALID)
+        printf("The deadlock was replayed and validated.\n");
+    else if (verdict == WITNESS_NOT_DEADLOCKED)
+        printf("INVALID deadlock: %s (automaton %s).\n", witness_verdict_description(verdict), la_get_name(automata[position]));
+    else
+        printf("INVALID deadlock: %s (step %d).\n", witness_verdict_description(verdict), position);
+}
+
+/**
+ * @brief Shrinks the path *@p path leading to a deadlock of @p automata (see witness_minimise) and, if @p prove, checks that no shorter deadlock exists (see witness_check_shortest). Displays the sizes obtained.
+ * The path is first replayed (see witness_validate), and left untouched if it does not lead to a deadlock.
+ *
+ * @param automata The LockAutomata the path was found in.
+ * @param num_automata The number of automata.
+ * @param path The path, allocated with malloc. Replaced by the shrunk path.
+ * @param size_path The size of *@p path, updated.
+ * @param radius The number of steps the search may go away from the path.
+ * @param prove Whether to check with the SAT reduction that the path obtained is a shortest one.
+ */
+void shrink_witness(LockAutomaton *automata, int num_automata, step **path, int *size_path, int radius, bool prove)
+{
+    // The shrinking replays the path without checking it: a wrong path from an engine is left to -V.
+    witness_verdict verdict = witness_validate(automata, num_automata, *path, *size_path, NULL);
+    if (verdict != WITNESS_VALID)
+    {
+        printf("Witness not shrunk: it does not replay to a deadlock (%s).\n", witness_verdict_description(verdict));
+        return;
+    }
+    clock_t start = clock();
+    witness_statistics statistics;
+    int size_shrunk;
+    step *shrunk = witness_minimise(automata, num_automata, *path, *size_path, radius, &size_shrunk, &statistics);
+    free(*path);
+    *path = shrunk;
+    *size_path = size_shrunk;
+    printf("Witness shrunk from %d to %d steps (%d after removing cycles and detours, %ld states around it searched)", statistics.original_size, size_shrunk, statistics.size_after_pruning, statistics.neighbourhood);
+    if (prove)
+    {
+        Z3_lbool shortest = witness_check_shortest(pooled_context(), automata, num_automata, path, size_path);
+        if (shortest == Z3_L_TRUE)
+            printf(", proven shortest");
+        else if (shortest == Z3_L_FALSE)
+            printf(", then to %d steps by the SAT reduction", *size_path);
+        else
+            printf(", undecided whether shortest (the solver gave up)");
+        reset_pool();
+    }
+    printf(" in %g seconds.\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+}
+#endif
+
 enum problemType
 {
     Repartition,
@@ -109,6 +211,37 @@ int main(int argc, char *argv[])
     bool printformula = false;
     bool bruteForce = false;
     bool reduction = false;
+    bool abstraction = false;
+    int minimalBound = -1;
+    bool ic3 = false;
+    bool parallelSteps = false;
+    lock_encoding lockEncoding = LOCK_ENCODING_TAKEN;
+    bool lockOrder = false;
+    bool minimise = false;
+    bool screening = false;
+    bool counter = false;
+    bool compiled = false;
+    bool bitstate = false;
+    int bitstateLogSize = 27;
+    int bitstateHashes = 3;
+    char *externalDirectory = NULL;
+    bool explicitSearch = false;
+    double simulationTime = 0;
+    bool heuristicSearch = false;
+    search_heuristic heuristic = HEURISTIC_DISTANCE;
+    int simulationDepth = 1000;
+    bool contextBounded = false;
+    bool symbolic = false;
+    bool backward = false;
+    switch_bound contextBound = BOUND_CONTEXT_SWITCHES;
+    int maxSwitches = 10;
+    bool validate = false;
+    int shrinkRadius = -1;
+    bool shrinkProve = false;
+    char *checkpointName = NULL;
+    double checkpointInterval = 300;
+    bool resume = false;
+    screening_engine screeningEngine = SCREENING_EXPLICIT;
     bool printModel = false;
     char *problem_parameter = "";
     char *solutionName = "default";
@@ -116,8 +249,11 @@ int main(int argc, char *argv[])
     int numArgs = 0;*/
 
     int option;
+    static struct option longOptions[] = {
+        {"resume", no_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}};
 
-    while ((option = getopt(argc, argv, ":hP:c:vFBGRMtfo:")) != -1)
+    while ((option = getopt_long(argc, argv, ":hP:c:vFBGRag:EO:ILmS:CXH:e:xK:W:A:D:bdVw:Mtfo:", longOptions, NULL)) != -1)
     {
         switch (option)
         {
@@ -145,6 +281,156 @@ int main(int argc, char *argv[])
         case 'R':
             reduction = true;
             break;
+        case 'a':
+            abstraction = true;
+            break;
+        case 'g':
+            minimalBound = atoi(optarg);
+            if (minimalBound < 0)
+            {
+                printf("Invalid maximal bound %s. Exiting.\n", optarg);
+                return 1;
+            }
+            break;
+        case 'E':
+            parallelSteps = true;
+            break;
+        case 'O':
+            if (strcmp(optarg, "onehot") == 0)
+                lockEncoding = LOCK_ENCODING_ONE_HOT;
+            else if (strcmp(optarg, "binary") == 0)
+                lockEncoding = LOCK_ENCODING_BINARY;
+            else
+            {
+                printf("Invalid lock encoding %s. Exiting.\n", optarg);
+                usage();
+                return 1;
+            }
+            break;
+        case 'I':
+            ic3 = true;
+            break;
+        case 'L':
+            lockOrder = true;
+            break;
+        case 'm':
+            minimise = true;
+            break;
+        case 'C':
+            counter = true;
+            break;
+        case 'X':
+            compiled = true;
+            break;
+        case 'e':
+            externalDirectory = optarg;
+            break;
+        case 'x':
+            explicitSearch = true;
+            break;
+        case 'K':
+            checkpointName = strtok(optarg, ",");
+            char *interval = strtok(NULL, ",");
+            if (interval != NULL)
+                checkpointInterval = atof(interval);
+            break;
+        case 'r':
+            resume = true;
+            break;
+        case 'A':
+            heuristicSearch = true;
+            if (strcmp(optarg, "distance") == 0)
+                heuristic = HEURISTIC_DISTANCE;
+            else if (strcmp(optarg, "blocked") == 0)
+                heuristic = HEURISTIC_BLOCKED;
+            else if (strcmp(optarg, "locks") == 0)
+                heuristic = HEURISTIC_LOCKS;
+            else
+            {
+                printf("Invalid heuristic %s. Exiting.\n", optarg);
+                usage();
+                return 1;
+            }
+            break;
+        case 'b':
+            symbolic = true;
+            break;
+        case 'd':
+            backward = true;
+            break;
+        case 'D':
+            contextBounded = true;
+            char *max = strchr(optarg, ',');
+            int kind_length = max != NULL ? max - optarg : strlen(optarg);
+            if (kind_length == 7 && strncmp(optarg, "context", 7) == 0)
+                contextBound = BOUND_CONTEXT_SWITCHES;
+            else if (kind_length == 10 && strncmp(optarg, "preemption", 10) == 0)
+                contextBound = BOUND_PREEMPTIONS;
+            else
+            {
+                printf("Invalid context bounding %s. Exiting.\n", optarg);
+                usage();
+                return 1;
+            }
+            if (max != NULL)
+            {
+                char *max_end;
+                long value = strtol(max + 1, &max_end, 10);
+                if (max_end == max + 1 || *max_end != '\0' || value < 0 || value > INT_MAX)
+                {
+                    printf("Invalid number of context switches %s. Exiting.\n", max + 1);
+                    usage();
+                    return 1;
+                }
+                maxSwitches = value;
+            }
+            break;
+        case 'V':
+            validate = true;
+            break;
+        case 'w':
+            // Parsed without strtok, so that optarg stays whole for the error message.
+            char *radius_end;
+            long radius = strtol(optarg, &radius_end, 10);
+            shrinkProve = strcmp(radius_end, ",sat") == 0;
+            if (radius_end == optarg || (*radius_end != '\0' && !shrinkProve) || radius < 0 || radius > INT_MAX)
+            {
+                printf("Invalid shrinking parameters %s. Exiting.\n", optarg);
+                usage();
+                return 1;
+            }
+            shrinkRadius = radius;
+            break;
+        case 'W':
+            sscanf(optarg, "%lf,%d", &simulationTime, &simulationDepth);
+            if (simulationTime <= 0 || simulationDepth < 1)
+            {
+                printf("Invalid simulation parameters %s. Exiting.\n", optarg);
+                return 1;
+            }
+            break;
+        case 'H':
+            bitstate = true;
+            sscanf(optarg, "%d,%d", &bitstateLogSize, &bitstateHashes);
+            if (bitstateLogSize < 6 || bitstateLogSize > 40 || bitstateHashes < 1)
+            {
+                printf("Invalid bitstate parameters %s. Exiting.\n", optarg);
+                return 1;
+            }
+            break;
+        case 'S':
+            screening = true;
+            if (strcmp(optarg, "explicit") == 0)
+                screeningEngine = SCREENING_EXPLICIT;
+            else if (strcmp(optarg, "sat") == 0)
+                screeningEngine = SCREENING_SAT;
+            else
+            {
+                printf("Invalid screening engine %s. Exiting.\n", optarg);
+                usage();
+                return 1;
+            }
+            break;
         case 'F':
             // printf("Don't insist, I'm not showing you the solution of the assignment yet!\n");
             printformula = true;
@@ -351,7 +637,7 @@ int main(int argc, char *argv[])
         {
             printf("\n************************\n*** Reduction to SAT ***\n************************\n\n");
 
-            Z3_context ctx = make_context();
+            Z3_context ctx = pooled_context();
 
             clock_t start = clock();
 
@@ -418,10 +704,12 @@ int main(int argc, char *argv[])
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
 
+                Z3_model_dec_ref(ctx, model);
                 break;
             }
 
-            Z3_del_context(ctx);
+            release_formula(ctx, formula);
+            reset_pool();
         }
 
         cg_delete(coloured_graph);
@@ -446,12 +734,69 @@ int main(int argc, char *argv[])
             }
         }
 
+        if (lockOrder)
+        {
+            printf("\n***************************\n*** Lock-order analysis ***\n***************************\n\n");
+            clock_t start = clock();
+            LockOrder order = lo_analyse(automata, num_graphs);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Lock-order analysis computed in %g seconds:\n", end);
+            if (lo_proves_deadlock_freedom(order))
+            {
+                printf("No deadlock is reachable, whatever the length (the lock-order graph is acyclic). Other algorithms skipped.\n");
+                bruteForce = false;
+                reduction = false;
+                abstraction = false;
+                minimalBound = -1;
+                ic3 = false;
+                screening = false;
+                counter = false;
+                compiled = false;
+                bitstate = false;
+                externalDirectory = NULL;
+                explicitSearch = false;
+                simulationTime = 0;
+                heuristicSearch = false;
+                contextBounded = false;
+                symbolic = false;
+                backward = false;
+            }
+            else
+            {
+                printf("The analysis cannot prove the absence of deadlock.\n");
+                lo_print(order, automata);
+            }
+            lo_delete(order);
+        }
+
+        MinimisedAutomaton minimised[num_graphs];
+        MinimisedAutomaton minimised_collapsed[num_graphs];
+        LockAutomaton reduced[num_graphs];
+        LockAutomaton collapsed[num_graphs];
+        LockAutomaton *checked = automata;
+        LockAutomaton *checked_unbounded = automata;
+        if (minimise)
+        {
+            printf("\n*****************************\n*** Automata minimisation ***\n*****************************\n\n");
+            for (int i = 0; i < num_graphs; i++)
+            {
+                minimised[i] = lm_minimise(automata[i], false);
+                reduced[i] = lm_get_automaton(minimised[i]);
+                minimised_collapsed[i] = lm_minimise(automata[i], true);
+                collapsed[i] = lm_get_automaton(minimised_collapsed[i]);
+                printf("Automaton %s: %d nodes, %d edges. Minimised: %d nodes, %d edges. With noop chains collapsed: %d nodes, %d edges.\n", la_get_name(automata[i]), la_get_num_nodes(automata[i]), la_get_num_edges(automata[i]), la_get_num_nodes(reduced[i]), la_get_num_edges(reduced[i]), la_get_num_nodes(collapsed[i]), la_get_num_edges(collapsed[i]));
+            }
+            checked = reduced;
+            checked_unbounded = collapsed;
+        }
+
         int bound = 10;
         if (strcmp(problem_parameter, "") != 0)
             bound = atoi(problem_parameter);
 
-        step path[bound];
-        for (int step = 0; step < bound; step++)
+        int path_capacity = parallelSteps ? bound * num_graphs : bound;
+        step path[path_capacity];
+        for (int step = 0; step < path_capacity; step++)
         {
             path[step] = la_step_empty();
         }
@@ -460,37 +805,124 @@ int main(int argc, char *argv[])
         {
             printf("\n*******************\n*** Brute Force ***\n*******************\n\n");
             clock_t start = clock();
-            bool res = deadlock_brute_force(automata, num_graphs, bound, path);
+            bool res = deadlock_brute_force(checked, num_graphs, bound, path);
             double end = (double)(clock() - start) / CLOCKS_PER_SEC;
             printf("Brute force computed the solution in %g seconds:\n", end);
             if (res)
             {
                 printf("There is a deadlock of size %d.\n", bound);
+                step *shown_path = path;
+                int shown_size = bound;
+                if (minimise)
+                    shown_path = lm_translate_path(minimised, num_graphs, path, bound, &shown_size);
+                if (validate)
+                    validate_witness(automata, num_graphs, shown_path, shown_size);
                 if (displayTerminal)
-                    la_print_path(automata, num_graphs, path, bound);
+                    la_print_path(automata, num_graphs, shown_path, shown_size);
                 if (outputFile)
                 {
                     int length = strlen(solutionName) + 12;
                     char nameFile[length];
                     snprintf(nameFile, length, "%s_Brute", solutionName);
-                    la_create_dot(automata, num_graphs, path, bound, nameFile);
+                    la_create_dot(automata, num_graphs, shown_path, shown_size, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                if (minimise)
+                    free(shown_path);
+            }
+            else
+                printf("There is no deadlock of size %d.\n", bound);
+        }
+
+        if (counter)
+        {
+            printf("\n***************************\n*** Counter abstraction ***\n***************************\n\n");
+            clock_t start = clock();
+            step *counter_path;
+            int counter_length;
+            long num_states;
+            bool res = deadlock_counter_search(checked, num_graphs, bound, &counter_path, &counter_length, &num_states);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Counter abstraction computed the solution in %g seconds (%d classes of identical automata, %ld abstract states):\n", end, counter_num_classes(checked, num_graphs), num_states);
+            if (res)
+            {
+                printf("There is a deadlock of size %d.\n", bound);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, counter_path, counter_length, &counter_length);
+                    free(counter_path);
+                    counter_path = translated;
+                }
+                if (validate)
+                    validate_witness(automata, num_graphs, counter_path, counter_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, counter_path, counter_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Counter", solutionName);
+                    la_create_dot(automata, num_graphs, counter_path, counter_length, nameFile);
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
             }
             else
                 printf("There is no deadlock of size %d.\n", bound);
+            free(counter_path);
+        }
+
+        if (compiled)
+        {
+            printf("\n******************************\n*** Compiled model checker ***\n******************************\n\n");
+            // The search runs in a child process, whose time clock() does not count.
+            struct timespec start, stop;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            step *compiled_path;
+            int compiled_length;
+            long num_states;
+            Z3_lbool res = deadlock_compiled_search(checked, num_graphs, bound, &compiled_path, &compiled_length, &num_states);
+            clock_gettime(CLOCK_MONOTONIC, &stop);
+            double end = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+            if (res == Z3_L_UNDEF)
+                printf("The compiled model checker could not be built or run.\n");
+            else
+                printf("Compiled model checker computed the solution in %g seconds (%ld states):\n", end, num_states);
+            if (res == Z3_L_TRUE)
+            {
+                printf("There is a deadlock of size %d.\n", bound);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, compiled_path, compiled_length, &compiled_length);
+                    free(compiled_path);
+                    compiled_path = translated;
+                }
+                if (validate)
+                    validate_witness(automata, num_graphs, compiled_path, compiled_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, compiled_path, compiled_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Compiled", solutionName);
+                    la_create_dot(automata, num_graphs, compiled_path, compiled_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else if (res == Z3_L_FALSE)
+                printf("There is no deadlock of size %d.\n", bound);
+            free(compiled_path);
         }
 
         if (reduction)
         {
             printf("\n************************\n*** Reduction to SAT ***\n************************\n\n");
 
-            Z3_context ctx = make_context();
+            Z3_context ctx = pooled_context();
 
             clock_t start = clock();
 
-            Z3_ast formula;
-            formula = deadlock_reduction(ctx, automata, num_graphs, bound);
+            Z3_ast formula = deadlock_encoded_reduction(ctx, checked, num_graphs, bound, parallelSteps, lockEncoding);
 
             clock_t timeFormula = clock();
 
@@ -509,6 +941,11 @@ int main(int argc, char *argv[])
                 fprintf(file, "%s\n", Z3_ast_to_string(ctx, formula));
                 fclose(file);
                 printf("Formula printed in sol/%s.formula\n", solutionName);
+                snprintf(nameFile, length, "sol/%s.cnf", solutionName);
+                file = fopen(nameFile, "w");
+                long numClauses = deadlock_reduction_dimacs(checked, num_graphs, bound, parallelSteps, lockEncoding, file);
+                fclose(file);
+                printf("Formula printed in DIMACS (%ld clauses) in sol/%s.cnf\n", numClauses, solutionName);
 #else
                 printf("Nah, I'm not displaying the formula in the given executable\n");
 #endif
@@ -534,38 +971,631 @@ int main(int argc, char *argv[])
             case Z3_L_TRUE:
                 printf("There is a deadlock.\n");
 
-                if (!(displayTerminal || outputFile || printModel))
+                if (!(displayTerminal || outputFile || printModel || validate || shrinkRadius >= 0))
+                {
+                    Z3_model_dec_ref(ctx, model);
                     break;
+                }
 
-                la_path_from_model(ctx, model, automata, num_graphs, path, bound);
+                int size_path = bound;
+                if (parallelSteps)
+                {
+                    size_path = la_parallel_path_from_model(ctx, model, checked, num_graphs, path, bound);
+                    printf("The deadlock found has size %d (%d parallel steps).\n", size_path, bound);
+                }
+                else
+                    la_path_from_model(ctx, model, checked, num_graphs, path, bound);
 
+                step *found_path = path;
+                if (shrinkRadius >= 0)
+                {
+                    found_path = (step *)malloc((size_path + 1) * sizeof(step));
+                    memcpy(found_path, path, size_path * sizeof(step));
+                    shrink_witness(checked, num_graphs, &found_path, &size_path, shrinkRadius, shrinkProve);
+                }
+                step *shown_path = found_path;
+                int shown_size = size_path;
+                if (minimise)
+                    shown_path = lm_translate_path(minimised, num_graphs, found_path, size_path, &shown_size);
+                if (validate)
+                    validate_witness(automata, num_graphs, shown_path, shown_size);
                 if (displayTerminal)
                 {
-                    la_print_path(automata, num_graphs, path, bound);
+                    la_print_path(automata, num_graphs, shown_path, shown_size);
                 }
                 if (printModel)
-                    la_print_model(ctx, model, automata, num_graphs, bound);
+                    la_print_model(ctx, model, checked, num_graphs, bound, lockEncoding);
 
                 if (outputFile)
                 {
                     int length = strlen(solutionName) + 12;
                     char nameFile[length];
                     snprintf(nameFile, length, "%s_Sat", solutionName);
-                    la_create_dot(automata, num_graphs, path, bound, nameFile);
+                    la_create_dot(automata, num_graphs, shown_path, shown_size, nameFile);
                     printf("Solution printed in sol/%s.dot.\n", nameFile);
                 }
+                if (minimise)
+                    free(shown_path);
+                if (shrinkRadius >= 0)
+                    free(found_path);
 
+                Z3_model_dec_ref(ctx, model);
                 break;
             }
 
-            Z3_del_context(ctx);
+            release_formula(ctx, formula);
+            reset_pool();
+        }
+
+        if (abstraction)
+        {
+            printf("\n**********************************\n*** Lock abstraction refinement ***\n**********************************\n\n");
+            Z3_context ctx = pooled_context();
+            clock_t start = clock();
+            abstraction_statistics statistics;
+            Z3_lbool res = deadlock_abstraction_refinement(ctx, checked, num_graphs, bound, path, &statistics);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Abstraction refinement computed the solution in %g seconds (%d iterations, %d locks tracked out of %d):\n", end, statistics.num_iterations, statistics.num_tracked, statistics.num_locks);
+
+            switch (res)
+            {
+            case Z3_L_FALSE:
+                printf("There is no deadlock of size %d.\n", bound);
+                break;
+
+            case Z3_L_UNDEF:
+                printf("Not able to decide if there is a deadlock.\n");
+                break;
+
+            case Z3_L_TRUE:
+                printf("There is a deadlock of size %d.\n", bound);
+                step *shown_path = path;
+                int shown_size = bound;
+                if (minimise)
+                    shown_path = lm_translate_path(minimised, num_graphs, path, bound, &shown_size);
+                if (validate)
+                    validate_witness(automata, num_graphs, shown_path, shown_size);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, shown_path, shown_size);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_CEGAR", solutionName);
+                    la_create_dot(automata, num_graphs, shown_path, shown_size, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                if (minimise)
+                    free(shown_path);
+                break;
+            }
+
+            reset_pool();
+        }
+
+        if (minimalBound >= 0)
+        {
+            printf("\n*******************************\n*** Minimal deadlock length ***\n*******************************\n\n");
+            Z3_context ctx = pooled_context();
+            clock_t start = clock();
+            step *minimal_path = (step *)malloc((minimalBound + 1) * sizeof(step));
+            int minimal_length;
+            bound_probe *probes;
+            int num_probes;
+            Z3_lbool res = deadlock_minimal_length(ctx, checked, num_graphs, minimalBound, minimal_path, &minimal_length, &probes, &num_probes);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Minimal length computed in %g seconds (%d queries):\n", end, num_probes);
+            for (int i = 0; i < num_probes; i++)
+                printf("Deadlock within %d steps: %s (solved in %g seconds).\n", probes[i].bound, probes[i].result == Z3_L_TRUE ? "yes" : (probes[i].result == Z3_L_FALSE ? "no" : "unknown"), probes[i].seconds);
+
+            switch (res)
+            {
+            case Z3_L_FALSE:
+                printf("There is no deadlock of size at most %d.\n", minimalBound);
+                break;
+
+            case Z3_L_UNDEF:
+                printf("Not able to decide the minimal length of a deadlock.\n");
+                break;
+
+            case Z3_L_TRUE:
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, minimal_path, minimal_length, &minimal_length);
+                    free(minimal_path);
+                    minimal_path = translated;
+                }
+                printf("The shortest deadlock has size %d.\n", minimal_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, minimal_path, minimal_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, minimal_path, minimal_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Minimal", solutionName);
+                    la_create_dot(automata, num_graphs, minimal_path, minimal_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                break;
+            }
+
+            free(probes);
+            free(minimal_path);
+            reset_pool();
+        }
+
+        int checkpointLength = checkpointName != NULL ? strlen(checkpointName) + 10 : 1;
+        char explicitCheckpoint[checkpointLength];
+        char ic3Checkpoint[checkpointLength];
+        checkpoint_options explicitOptions = {explicitCheckpoint, checkpointInterval, resume};
+        checkpoint_options ic3Options = {ic3Checkpoint, checkpointInterval, resume};
+        if (checkpointName != NULL)
+        {
+            snprintf(explicitCheckpoint, checkpointLength, "%s.explicit", checkpointName);
+            snprintf(ic3Checkpoint, checkpointLength, "%s.ic3", checkpointName);
+        }
+
+        if (simulationTime > 0)
+        {
+            printf("\n******************\n*** Simulation ***\n******************\n\n");
+            step *simulation_path;
+            int simulation_length;
+            simulation_statistics statistics;
+            bool res = deadlock_simulation(checked_unbounded, num_graphs, simulationDepth, simulationTime, sysconf(_SC_NPROCESSORS_ONLN), time(NULL), &simulation_path, &simulation_length, &statistics);
+            printf("Simulation ran %ld executions (%ld steps) in %g seconds: %.0f executions per second, at least %ld distinct states hit.\n", statistics.num_walks, statistics.num_steps, statistics.seconds, statistics.num_walks / statistics.seconds, statistics.distinct_states);
+            if (res)
+            {
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked_unbounded, num_graphs, &simulation_path, &simulation_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised_collapsed, num_graphs, simulation_path, simulation_length, &simulation_length);
+                    free(simulation_path);
+                    simulation_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", simulation_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, simulation_path, simulation_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, simulation_path, simulation_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Simul", solutionName);
+                    la_create_dot(automata, num_graphs, simulation_path, simulation_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock found by the executions run.\n");
+            free(simulation_path);
+        }
+
+        if (explicitSearch)
+        {
+            printf("\n***********************\n*** Explicit search ***\n***********************\n\n");
+            clock_t start = clock();
+            step *explicit_path;
+            int explicit_length;
+            long num_states;
+            bool res = deadlock_explicit_search_checkpointed(checked, num_graphs, &explicit_path, &explicit_length, &num_states, checkpointName != NULL ? &explicitOptions : NULL);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Explicit search computed the solution in %g seconds (%ld states):\n", end, num_states);
+            if (res)
+            {
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, explicit_path, explicit_length, &explicit_length);
+                    free(explicit_path);
+                    explicit_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", explicit_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, explicit_path, explicit_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, explicit_path, explicit_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Explicit", solutionName);
+                    la_create_dot(automata, num_graphs, explicit_path, explicit_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock is reachable, whatever the length.\n");
+            free(explicit_path);
+        }
+
+        if (heuristicSearch)
+        {
+            printf("\n*************************\n*** Best-first search ***\n*************************\n\n");
+            clock_t start = clock();
+            step *heuristic_path;
+            int heuristic_length;
+            long num_states;
+            bool res = deadlock_heuristic_search(checked, num_graphs, heuristic, &heuristic_path, &heuristic_length, &num_states);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Best-first search computed the solution in %g seconds (%ld states):\n", end, num_states);
+            if (res)
+            {
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked, num_graphs, &heuristic_path, &heuristic_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, heuristic_path, heuristic_length, &heuristic_length);
+                    free(heuristic_path);
+                    heuristic_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", heuristic_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, heuristic_path, heuristic_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, heuristic_path, heuristic_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_BestFirst", solutionName);
+                    la_create_dot(automata, num_graphs, heuristic_path, heuristic_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock is reachable, whatever the length.\n");
+            free(heuristic_path);
+        }
+
+        if (symbolic)
+        {
+            printf("\n*****************************\n*** Symbolic reachability ***\n*****************************\n\n");
+            clock_t start = clock();
+            step *symbolic_path;
+            int symbolic_length;
+            symbolic_statistics statistics;
+            bool res = deadlock_symbolic_search(checked, num_graphs, true, &symbolic_path, &symbolic_length, &statistics);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Symbolic reachability computed the solution in %g seconds (%d variables, %d images, %.0f states in a BDD of %ld nodes, %ld nodes at most, %d reorderings):\n", end, statistics.num_vars, statistics.depth, statistics.num_states, statistics.reachable_nodes, statistics.peak_nodes, statistics.num_reorderings);
+            if (res)
+            {
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, symbolic_path, symbolic_length, &symbolic_length);
+                    free(symbolic_path);
+                    symbolic_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", symbolic_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, symbolic_path, symbolic_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, symbolic_path, symbolic_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Symbolic", solutionName);
+                    la_create_dot(automata, num_graphs, symbolic_path, symbolic_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock is reachable, whatever the length.\n");
+            free(symbolic_path);
+        }
+
+        if (backward)
+        {
+            printf("\n*****************************\n*** Backward reachability ***\n*****************************\n\n");
+            clock_t start = clock();
+            step *backward_path;
+            int backward_length;
+            backward_statistics statistics;
+            bool res = deadlock_backward_search(checked, num_graphs, true, &backward_path, &backward_length, &statistics);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Backward reachability computed the solution in %g seconds (%d candidate deadlocks, %d refuted, %ld pre-images, %.0f states proven unreachable, %ld nodes at most):\n", end, statistics.num_candidates, statistics.num_refuted, statistics.num_preimages, statistics.unreachable_states, statistics.peak_nodes);
+            if (res)
+            {
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked, num_graphs, &backward_path, &backward_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, backward_path, backward_length, &backward_length);
+                    free(backward_path);
+                    backward_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", backward_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, backward_path, backward_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, backward_path, backward_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Backward", solutionName);
+                    la_create_dot(automata, num_graphs, backward_path, backward_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock is reachable, whatever the length.\n");
+            free(backward_path);
+        }
+
+        if (contextBounded)
+        {
+            printf("\n******************************\n*** Context-bounded search ***\n******************************\n\n");
+            clock_t start = clock();
+            step *bounded_path;
+            int bounded_length;
+            int switches;
+            long num_states;
+            Z3_lbool res = deadlock_context_bounded_search(checked, num_graphs, contextBound, maxSwitches, &bounded_path, &bounded_length, &switches, &num_states);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Context-bounded search computed the solution in %g seconds (%ld states):\n", end, num_states);
+            const char *unit = contextBound == BOUND_PREEMPTIONS ? "preemption" : "context switch";
+            if (res == Z3_L_TRUE)
+            {
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked, num_graphs, &bounded_path, &bounded_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, bounded_path, bounded_length, &bounded_length);
+                    free(bounded_path);
+                    bounded_path = translated;
+                }
+                printf("There is a deadlock of size %d with %d %s%s.\n", bounded_length, switches, unit, switches == 1 ? "" : (contextBound == BOUND_PREEMPTIONS ? "s" : "es"));
+                if (validate)
+                    validate_witness(automata, num_graphs, bounded_path, bounded_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, bounded_path, bounded_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Context", solutionName);
+                    la_create_dot(automata, num_graphs, bounded_path, bounded_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else if (res == Z3_L_FALSE)
+                printf("No deadlock is reachable, whatever the length.\n");
+            else
+                printf("No deadlock is reachable with at most %d %s%s.\n", maxSwitches, unit, maxSwitches == 1 ? "" : (contextBound == BOUND_PREEMPTIONS ? "s" : "es"));
+            free(bounded_path);
+        }
+
+        if (ic3)
+        {
+            printf("\n**************\n*** IC3/PDR ***\n**************\n\n");
+
+            Z3_context ctx = pooled_context();
+            clock_t start = clock();
+            step *ic3_path;
+            int ic3_length;
+            Z3_lbool res = deadlock_ic3_checkpointed(ctx, checked_unbounded, num_graphs, &ic3_path, &ic3_length, displayTerminal, checkpointName != NULL ? &ic3Options : NULL);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("IC3 computed the solution in %g seconds:\n", end);
+
+            switch (res)
+            {
+            case Z3_L_FALSE:
+                printf("No deadlock is reachable, whatever the length.\n");
+                break;
+
+            case Z3_L_UNDEF:
+                printf("Not able to decide if there is a deadlock.\n");
+                break;
+
+            case Z3_L_TRUE:
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked_unbounded, num_graphs, &ic3_path, &ic3_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised_collapsed, num_graphs, ic3_path, ic3_length, &ic3_length);
+                    free(ic3_path);
+                    ic3_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", ic3_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, ic3_path, ic3_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, ic3_path, ic3_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_IC3", solutionName);
+                    la_create_dot(automata, num_graphs, ic3_path, ic3_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                break;
+            }
+
+            free(ic3_path);
+            reset_pool();
         }
 
+        if (screening)
+        {
+            printf("\n*****************\n*** Screening ***\n*****************\n\n");
+            clock_t start = clock();
+            bool subset[num_graphs];
+            step *screening_path;
+            int screening_length;
+            Z3_lbool res = deadlock_screening(checked, num_graphs, 3, screeningEngine, sysconf(_SC_NPROCESSORS_ONLN), subset, &screening_path, &screening_length);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Screening computed the solution in %g seconds (processor time):\n", end);
+
+            switch (res)
+            {
+            case Z3_L_FALSE:
+                printf("No deadlock is reachable, whatever the length.\n");
+                break;
+
+            case Z3_L_UNDEF:
+                printf("Not able to decide if there is a deadlock.\n");
+                break;
+
+            case Z3_L_TRUE:
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, screening_path, screening_length, &screening_length);
+                    free(screening_path);
+                    screening_path = translated;
+                }
+                int subset_size = 0;
+                for (int i = 0; i < num_graphs; i++)
+                    if (subset[i])
+                        subset_size++;
+                if (subset_size == num_graphs)
+                    printf("There is a deadlock of size %d.\n", screening_length);
+                else
+                {
+                    printf("Automata");
+                    for (int i = 0; i < num_graphs; i++)
+                        if (subset[i])
+                            printf(" %s(%d)", la_get_name(automata[i]), i);
+                    printf(" get stuck together after %d steps, the others staying in their initial node (partial deadlock).\n", screening_length);
+                }
+                if (validate)
+                {
+                    // A partial deadlock is only a deadlock of its subset: it is checked on these automata.
+                    LockAutomaton stuck[subset_size];
+                    int renumbering[num_graphs];
+                    for (int i = 0, j = 0; i < num_graphs; i++)
+                        if (subset[i])
+                        {
+                            renumbering[i] = j;
+                            stuck[j++] = automata[i];
+                        }
+                        else
+                            renumbering[i] = -1;
+                    step renumbered[screening_length + 1];
+                    for (int i = 0; i < screening_length; i++)
+                    {
+                        renumbered[i] = screening_path[i];
+                        renumbered[i].automaton = renumbering[screening_path[i].automaton];
+                    }
+                    validate_witness(stuck, subset_size, renumbered, screening_length);
+                }
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, screening_path, screening_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Screen", solutionName);
+                    la_create_dot(automata, num_graphs, screening_path, screening_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                break;
+            }
+            free(screening_path);
+        }
+
+        if (bitstate)
+        {
+            printf("\n*************************\n*** Bitstate hashing ***\n*************************\n\n");
+            clock_t start = clock();
+            step *bitstate_path;
+            int bitstate_length;
+            bitstate_statistics statistics;
+            bool res = deadlock_bitstate_search(checked_unbounded, num_graphs, bitstateLogSize, bitstateHashes, &bitstate_path, &bitstate_length, &statistics);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("Bitstate hashing computed the solution in %g seconds:\n", end);
+            printf("%ld states stored in 2^%d bits (%d bits per state), %.4g%% of the bits set, %.3g states expected to be missed (estimated coverage %.4g%%).\n", statistics.num_states, bitstateLogSize, bitstateHashes, 100 * statistics.fill_ratio, statistics.expected_omissions, 100 * statistics.coverage);
+            if (res)
+            {
+                if (shrinkRadius >= 0)
+                    shrink_witness(checked_unbounded, num_graphs, &bitstate_path, &bitstate_length, shrinkRadius, shrinkProve);
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised_collapsed, num_graphs, bitstate_path, bitstate_length, &bitstate_length);
+                    free(bitstate_path);
+                    bitstate_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", bitstate_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, bitstate_path, bitstate_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, bitstate_path, bitstate_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_Bitstate", solutionName);
+                    la_create_dot(automata, num_graphs, bitstate_path, bitstate_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+            }
+            else
+                printf("No deadlock found among the states visited.\n");
+            free(bitstate_path);
+        }
+
+        if (externalDirectory != NULL)
+        {
+            printf("\n***********************\n*** External memory ***\n***********************\n\n");
+            clock_t start = clock();
+            step *external_path;
+            int external_length;
+            long num_states;
+            Z3_lbool res = deadlock_external_search(checked, num_graphs, -1, externalDirectory, 1 << 20, &external_path, &external_length, &num_states);
+            double end = (double)(clock() - start) / CLOCKS_PER_SEC;
+            printf("External-memory search computed the solution in %g seconds (%ld states):\n", end, num_states);
+
+            switch (res)
+            {
+            case Z3_L_FALSE:
+                printf("No deadlock is reachable, whatever the length.\n");
+                break;
+
+            case Z3_L_UNDEF:
+                printf("Not able to decide if there is a deadlock (the files of the search could not be written or read in %s).\n", externalDirectory);
+                break;
+
+            case Z3_L_TRUE:
+                if (minimise)
+                {
+                    step *translated = lm_translate_path(minimised, num_graphs, external_path, external_length, &external_length);
+                    free(external_path);
+                    external_path = translated;
+                }
+                printf("There is a deadlock of size %d.\n", external_length);
+                if (validate)
+                    validate_witness(automata, num_graphs, external_path, external_length);
+                if (displayTerminal)
+                    la_print_path(automata, num_graphs, external_path, external_length);
+                if (outputFile)
+                {
+                    int length = strlen(solutionName) + 12;
+                    char nameFile[length];
+                    snprintf(nameFile, length, "%s_External", solutionName);
+                    la_create_dot(automata, num_graphs, external_path, external_length, nameFile);
+                    printf("Solution printed in sol/%s.dot.\n", nameFile);
+                }
+                break;
+            }
+            free(external_path);
+        }
+
+        if (minimise)
+            for (int i = 0; i < num_graphs; i++)
+            {
+                lm_delete(minimised[i]);
+                lm_delete(minimised_collapsed[i]);
+            }
         for (int i = 0; i < num_graphs; i++)
             la_delete(automata[i]);
     }
 #endif
 
+    free_pool();
     for (int i = 0; i < num_graphs; i++)
         graph_delete(graphs[i]);
 
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "Cardinality.h"
+
+/**
+ * @brief The encodings checked, with their names.
+ */
+const card_encoding encodings[] = {CARD_AUTO, CARD_PAIRWISE, CARD_SEQUENTIAL, CARD_TOTALISER, CARD_COMMANDER, CARD_PRODUCT, CARD_BIMANDER, CARD_NATIVE};
+const char *encoding_names[] = {"auto", "pairwise", "sequential", "totaliser", "commander", "product", "bimander", "native"};
+const int num_encodings = 8;
+
+/**
+ * @brief Returns the number of clauses of the CNF of at most @p k of @p size variables with @p encoding (see fb_write_dimacs).
+ *
+ * @param size
+ * @param k
+ * @param encoding
+ * @return long
+ */
+long count_clauses(int size, int k, card_encoding encoding)
+{
+    FormulaBuilder builder = fb_create();
+    fb_node *inputs = (fb_node *)malloc(size * sizeof(fb_node));
+    for (int i = 0; i < size; i++)
+    {
+        char name[40];
+        snprintf(name, 40, "x%d", i);
+        inputs[i] = fb_var(builder, name);
+    }
+    FILE *file = tmpfile();
+    long num_clauses = fb_write_dimacs(builder, card_at_most_k(builder, size, inputs, k, encoding), file);
+    fclose(file);
+    free(inputs);
+    fb_delete(builder);
+    return num_clauses;
+}
+
+/**
+ * @brief Checks that the CNF of at most @p k grows linearly with the number of formulae: multiplying it by 8 must not multiply the clauses by more than 10.
+ *        The bimander encoding is in n log n, and gets a factor 14 instead.
+ *
+ * @param k
+ * @param encoding The encoding, index in encodings.
+ * @return true if the growth is linear.
+ * @return false otherwise.
+ */
+bool check_linear(int k, int encoding)
+{
+    long small = count_clauses(250, k, encodings[encoding]);
+    long big = count_clauses(2000, k, encodings[encoding]);
+    double limit = encodings[encoding] == CARD_BIMANDER ? 14 : 10;
+    bool ok = big <= limit * small;
+    printf("at most %d, %s: %ld clauses for 250 formulae, %ld for 2000: %s.\n", k, encoding_names[encoding], small, big, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/**
+ * @brief Checks with Z3 that at most @p k of @p size variables with @p encoding is equivalent to the native pseudo-Boolean constraint.
+ *
+ * @param ctx A context with reference counting.
+ * @param size At least 1.
+ * @param k
+ * @param encoding The encoding, index in encodings.
+ * @return true if both are equivalent.
+ * @return false otherwise.
+ */
+bool check_equivalent(Z3_context ctx, int size, int k, int encoding)
+{
+    Z3_ast variables[size];
+    for (int i = 0; i < size; i++)
+    {
+        char name[40];
+        snprintf(name, 40, "x%d", i);
+        variables[i] = keep_formula(ctx, mk_bool_var(ctx, name));
+    }
+    Z3_ast encoded = keep_formula(ctx, card_z3_at_most_k(ctx, size, variables, k, encodings[encoding]));
+    Z3_ast native = keep_formula(ctx, k < 0 ? Z3_mk_false(ctx) : Z3_mk_atmost(ctx, size, variables, k));
+    Z3_ast differ = keep_formula(ctx, Z3_mk_xor(ctx, encoded, native));
+    bool ok = is_formula_sat(ctx, differ) == Z3_L_FALSE;
+    if (!ok)
+        printf("at most %d of %d, %s: FAILED.\n", k, size, encoding_names[encoding]);
+    release_formula(ctx, differ);
+    release_formula(ctx, native);
+    release_formula(ctx, encoded);
+    release_formulae(ctx, variables, size);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    int failures = 0;
+    for (int k = 1; k <= 4; k++)
+        for (int encoding = 0; encoding < num_encodings; encoding++)
+        {
+            // Pairwise is quadratic by design (beyond at most one, it is replaced by the automatic choice).
+            if (encodings[encoding] == CARD_PAIRWISE)
+                continue;
+            failures += !check_linear(k, encoding);
+        }
+
+    Z3_context ctx = pooled_context();
+    int checks = 0;
+    for (int size = 1; size <= 9; size++)
+        for (int k = -1; k <= 4; k++)
+            for (int encoding = 0; encoding < num_encodings; encoding++)
+            {
+                failures += !check_equivalent(ctx, size, k, encoding);
+                checks++;
+            }
+    printf("%d constraints proved equivalent to the native ones.\n", checks);
+    free_pool();
+
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}
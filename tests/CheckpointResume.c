@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Graph.h"
+#include "Parsing.h"
+#include "LockAutomaton.h"
+#include "Checkpoint.h"
+#include "DeadlockExplicit.h"
+#include "DeadlockIC3.h"
+#include "DeadlockWitness.h"
+#include "Z3Tools.h"
+
+/**
+ * @brief An instance of the Deadlock Checking problem.
+ */
+typedef struct
+{
+    char *files[7];            ///< The automata, NULL-terminated.
+    Graph graphs[7];           ///< Their graphs.
+    LockAutomaton automata[7]; ///< The automata.
+    int num_automata;          ///< Their number.
+} checkpoint_instance;
+
+/**
+ * @brief Loads the automata of @p instance.
+ *
+ * @param instance
+ */
+void load_instance(checkpoint_instance *instance)
+{
+    instance->num_automata = 0;
+    while (instance->files[instance->num_automata] != NULL)
+    {
+        instance->graphs[instance->num_automata] = get_graph_from_file(instance->files[instance->num_automata]);
+        instance->automata[instance->num_automata] = la_initialize(instance->graphs[instance->num_automata]);
+        instance->num_automata++;
+    }
+}
+
+/**
+ * @brief Deallocates the automata of @p instance.
+ *
+ * @param instance
+ */
+void delete_instance(checkpoint_instance *instance)
+{
+    for (int i = 0; i < instance->num_automata; i++)
+    {
+        la_delete(instance->automata[i]);
+        graph_delete(instance->graphs[i]);
+    }
+}
+
+/**
+ * @brief Tells if the file of @p options holds a checkpoint of @p kind for @p instance.
+ *
+ * @param options
+ * @param kind
+ * @param instance
+ * @return true
+ * @return false
+ */
+bool has_checkpoint(const checkpoint_options *options, checkpoint_kind kind, checkpoint_instance *instance)
+{
+    checkpoint_options resuming = *options;
+    resuming.resume = true;
+    checkpoint_mapping mapping;
+    if (!checkpoint_map(&resuming, kind, checkpoint_fingerprint(instance->automata, instance->num_automata), &mapping))
+        return false;
+    checkpoint_unmap(&mapping);
+    return true;
+}
+
+/**
+ * @brief Runs the explicit search on @p instance while checkpointing it as often as possible, then resumes it from the last checkpoint, and checks that both runs give the same answer, states and path.
+ *
+ * @param instance
+ * @param file The checkpoint file (removed at the end).
+ * @return true if the resumed search gives the same result.
+ * @return false otherwise.
+ */
+bool check_explicit(checkpoint_instance *instance, const char *file)
+{
+    checkpoint_options options = {file, 0, false};
+    step *path;
+    int size_path;
+    long num_states;
+    bool found = deadlock_explicit_search_checkpointed(instance->automata, instance->num_automata, &path, &size_path, &num_states, &options);
+    bool written = has_checkpoint(&options, CHECKPOINT_EXPLICIT, instance);
+
+    options.resume = true;
+    step *resumed_path;
+    int resumed_size;
+    long resumed_states;
+    bool resumed = deadlock_explicit_search_checkpointed(instance->automata, instance->num_automata, &resumed_path, &resumed_size, &resumed_states, &options);
+    bool ok = written && resumed == found && resumed_states == num_states && resumed_size == size_path && (size_path == 0 || memcmp(path, resumed_path, size_path * sizeof(step)) == 0);
+    printf("explicit, %s, ...: %s, %ld states (%s).\n", instance->files[0], found ? "deadlock" : "no deadlock", num_states, ok ? "ok" : "FAILED");
+    free(path);
+    free(resumed_path);
+    unlink(file);
+    return ok;
+}
+
+/**
+ * @brief Runs IC3 on @p instance while checkpointing it after every frame, then resumes it from the last checkpoint, and checks that both runs give the same answer, with a deadlock which replays if any.
+ *
+ * @param ctx A context with reference counting.
+ * @param instance
+ * @param file The checkpoint file (removed at the end).
+ * @return true if the resumed search gives the same answer.
+ * @return false otherwise.
+ */
+bool check_ic3(Z3_context ctx, checkpoint_instance *instance, const char *file)
+{
+    checkpoint_options options = {file, 0, false};
+    step *path;
+    int size_path;
+    Z3_lbool res = deadlock_ic3_checkpointed(ctx, instance->automata, instance->num_automata, &path, &size_path, false, &options);
+    bool written = has_checkpoint(&options, CHECKPOINT_IC3, instance);
+    reset_pool();
+
+    options.resume = true;
+    step *resumed_path;
+    int resumed_size;
+    Z3_lbool resumed = deadlock_ic3_checkpointed(ctx, instance->automata, instance->num_automata, &resumed_path, &resumed_size, false, &options);
+    reset_pool();
+    bool ok = written && res != Z3_L_UNDEF && resumed == res;
+    if (ok && res == Z3_L_TRUE && witness_validate(instance->automata, instance->num_automata, resumed_path, resumed_size, NULL) != WITNESS_VALID)
+        ok = false;
+    printf("IC3, %s, ...: %s (%s).\n", instance->files[0], res == Z3_L_TRUE ? "deadlock" : res == Z3_L_FALSE ? "no deadlock" : "undecided", ok ? "ok" : "FAILED");
+    free(path);
+    free(resumed_path);
+    unlink(file);
+    return ok;
+}
+
+/**
+ * @brief Checkpoints the explicit search on @p written, then resumes it on @p other: the checkpoint must be ignored, and the answer be that of a search from scratch.
+ *
+ * @param written
+ * @param other Another instance.
+ * @param file The checkpoint file (removed at the end).
+ * @return true if the checkpoint was ignored.
+ * @return false otherwise.
+ */
+bool check_mismatch(checkpoint_instance *written, checkpoint_instance *other, const char *file)
+{
+    checkpoint_options options = {file, 0, false};
+    step *path;
+    int size_path;
+    long num_states;
+    deadlock_explicit_search_checkpointed(written->automata, written->num_automata, &path, &size_path, &num_states, &options);
+    free(path);
+    bool found = deadlock_explicit_search(other->automata, other->num_automata, &path, &size_path, &num_states);
+    free(path);
+
+    bool matches = has_checkpoint(&options, CHECKPOINT_EXPLICIT, other);
+    options.resume = true;
+    long resumed_states;
+    bool resumed = deadlock_explicit_search_checkpointed(other->automata, other->num_automata, &path, &size_path, &resumed_states, &options);
+    free(path);
+    bool ok = !matches && resumed == found && resumed_states == num_states;
+    printf("checkpoint of %s, ... resumed on %s, ...: %s.\n", written->files[0], other->files[0], ok ? "ignored (ok)" : "FAILED");
+    unlink(file);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    checkpoint_instance instances[] = {
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_17/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_4.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_5.dot", NULL}},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", "graphs/DeadlockChecking/dining_philosophers/confucius.dot",
+          "graphs/DeadlockChecking/dining_philosophers/democrite.dot", "graphs/DeadlockChecking/dining_philosophers/epicure.dot", NULL}},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", NULL}}};
+    int num_instances = sizeof(instances) / sizeof(instances[0]);
+    for (int i = 0; i < num_instances; i++)
+        load_instance(&instances[i]);
+
+    // The engines write the checkpoint next to this file and rename it.
+    char file[] = "/tmp/checkpointXXXXXX";
+    int descriptor = mkstemp(file);
+    if (descriptor == -1)
+    {
+        printf("Cannot create a temporary file.\n");
+        return 1;
+    }
+    close(descriptor);
+    unlink(file);
+
+    int failures = 0;
+    for (int i = 0; i < num_instances; i++)
+        failures += !check_explicit(&instances[i], file);
+    for (int i = 0; i < num_instances; i++)
+        failures += !check_ic3(pooled_context(), &instances[i], file);
+    failures += !check_mismatch(&instances[0], &instances[2], file);
+    free_pool();
+
+    for (int i = 0; i < num_instances; i++)
+        delete_instance(&instances[i]);
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "Graph.h"
+#include "Parsing.h"
+#include "LockAutomaton.h"
+#include "DeadlockExplicit.h"
+#include "DeadlockExternal.h"
+#include "DeadlockWitness.h"
+
+/**
+ * @brief The automata of an instance, NULL-terminated.
+ */
+typedef struct
+{
+    char *files[7]; ///< The automata, NULL-terminated.
+} external_instance;
+
+/**
+ * @brief Tells if @p directory is empty.
+ *
+ * @param directory
+ * @return true
+ * @return false
+ */
+bool is_empty(const char *directory)
+{
+    DIR *dir = opendir(directory);
+    struct dirent *entry;
+    bool empty = true;
+    while ((entry = readdir(dir)) != NULL)
+        if (entry->d_name[0] != '.')
+        {
+            printf("  left behind: %s\n", entry->d_name);
+            empty = false;
+        }
+    closedir(dir);
+    return empty;
+}
+
+/**
+ * @brief Runs the external search on @p automata with runs of at most @p buffer_states states, and checks it against the search in memory (see deadlock_explicit_search): same answer, same number of states, and a deadlock of the same size which replays.
+ * With a buffer of one state, every successor is a run of its own: the runs are merged in several passes, and all duplicates are removed by the merges and the subtraction of the visited states.
+ *
+ * @param automata
+ * @param num_automata
+ * @param directory An empty directory, which must be left empty.
+ * @param buffer_states
+ * @return true if both searches agree.
+ * @return false otherwise.
+ */
+bool check_search(LockAutomaton *automata, int num_automata, const char *directory, long buffer_states)
+{
+    step *expected_path;
+    int expected_size;
+    long expected_states;
+    bool expected = deadlock_explicit_search(automata, num_automata, &expected_path, &expected_size, &expected_states);
+    step *path;
+    int size_path;
+    long num_states;
+    Z3_lbool res = deadlock_external_search(automata, num_automata, -1, directory, buffer_states, &path, &size_path, &num_states);
+    bool ok = res == (expected ? Z3_L_TRUE : Z3_L_FALSE) && is_empty(directory);
+    // Without deadlock, both searches visit all the reachable states. Otherwise the external one stops after the layer of the deadlock.
+    if (!expected && num_states != expected_states)
+        ok = false;
+    if (expected && (size_path != expected_size || witness_validate(automata, num_automata, path, size_path, NULL) != WITNESS_VALID))
+        ok = false;
+    printf("buffer of %ld states: %s, %ld states, %d steps (%s).\n", buffer_states, res == Z3_L_TRUE ? "deadlock" : res == Z3_L_FALSE ? "no deadlock" : "undecided", num_states, size_path, ok ? "ok" : "FAILED");
+    free(path);
+    free(expected_path);
+    return ok;
+}
+
+/**
+ * @brief Runs the external search on @p automata with files limited to @p max_bytes bytes, so that writes fail, and checks that it gives up without leaving any file.
+ *
+ * @param automata
+ * @param num_automata
+ * @param directory An empty directory, which must be left empty.
+ * @param max_bytes The limit of the size of the files.
+ * @return true if the search is undecided (or right, if the files were small enough) and left no file.
+ * @return false otherwise.
+ */
+bool check_failure(LockAutomaton *automata, int num_automata, const char *directory, rlim_t max_bytes)
+{
+    step *expected_path;
+    int expected_size;
+    bool expected = deadlock_explicit_search(automata, num_automata, &expected_path, &expected_size, NULL);
+    free(expected_path);
+    struct rlimit previous, limited;
+    getrlimit(RLIMIT_FSIZE, &previous);
+    limited = previous;
+    limited.rlim_cur = max_bytes;
+    setrlimit(RLIMIT_FSIZE, &limited);
+    step *path;
+    int size_path;
+    Z3_lbool res = deadlock_external_search(automata, num_automata, -1, directory, 3, &path, &size_path, NULL);
+    setrlimit(RLIMIT_FSIZE, &previous);
+    bool ok = (res == Z3_L_UNDEF || res == (expected ? Z3_L_TRUE : Z3_L_FALSE)) && is_empty(directory);
+    printf("files of at most %ld bytes: %s (%s).\n", (long)max_bytes, res == Z3_L_TRUE ? "deadlock" : res == Z3_L_FALSE ? "no deadlock" : "undecided", ok ? "ok" : "FAILED");
+    free(path);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    const external_instance instances[] = {
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_17/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_4.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_5.dot", NULL}},
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_2.dot", NULL}},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", NULL}}};
+    const long buffers[] = {1, 3, 100, 1 << 20};
+    const rlim_t limits[] = {0, 16, 256, 4096};
+    int num_instances = sizeof(instances) / sizeof(instances[0]);
+    int failures = 0;
+
+    // The writes beyond the limit of size must fail, instead of killing the process.
+    signal(SIGXFSZ, SIG_IGN);
+    char directory[] = "/tmp/externalXXXXXX";
+    if (mkdtemp(directory) == NULL)
+    {
+        printf("Cannot create a temporary directory.\n");
+        return 1;
+    }
+    for (int i = 0; i < num_instances; i++)
+    {
+        Graph graphs[7];
+        LockAutomaton automata[7];
+        int num_automata = 0;
+        while (instances[i].files[num_automata] != NULL)
+        {
+            graphs[num_automata] = get_graph_from_file(instances[i].files[num_automata]);
+            automata[num_automata] = la_initialize(graphs[num_automata]);
+            num_automata++;
+        }
+        printf("%s, ... (%d automata):\n", instances[i].files[0], num_automata);
+        for (int j = 0; j < (int)(sizeof(buffers) / sizeof(buffers[0])); j++)
+            failures += !check_search(automata, num_automata, directory, buffers[j]);
+        for (int j = 0; j < (int)(sizeof(limits) / sizeof(limits[0])); j++)
+            failures += !check_failure(automata, num_automata, directory, limits[j]);
+        for (int j = 0; j < num_automata; j++)
+        {
+            la_delete(automata[j]);
+            graph_delete(graphs[j]);
+        }
+    }
+    rmdir(directory);
+
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}
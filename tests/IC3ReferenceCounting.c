@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "Graph.h"
+#include "Parsing.h"
+#include "LockAutomaton.h"
+#include "DeadlockIC3.h"
+#include "DeadlockWitness.h"
+#include "Z3Tools.h"
+
+/**
+ * @brief An instance of the Deadlock Checking problem and its expected answer.
+ */
+typedef struct
+{
+    char *files[7];       ///< The automata, NULL-terminated.
+    bool deadlock;        ///< Whether a deadlock is reachable.
+} ic3_instance;
+
+/**
+ * @brief Runs IC3 on @p instance in @p ctx and checks its answer, replaying the deadlock found if any.
+ *
+ * @param ctx A context with reference counting.
+ * @param instance The instance.
+ * @return true if the answer is the expected one.
+ * @return false otherwise.
+ */
+bool check_instance(Z3_context ctx, const ic3_instance *instance)
+{
+    Graph graphs[7];
+    LockAutomaton automata[7];
+    int num_automata = 0;
+    while (instance->files[num_automata] != NULL)
+    {
+        graphs[num_automata] = get_graph_from_file(instance->files[num_automata]);
+        automata[num_automata] = la_initialize(graphs[num_automata]);
+        num_automata++;
+    }
+    step *path;
+    int size_path;
+    Z3_lbool res = deadlock_ic3(ctx, automata, num_automata, &path, &size_path, false);
+    bool ok = res == (instance->deadlock ? Z3_L_TRUE : Z3_L_FALSE);
+    int position;
+    if (ok && instance->deadlock && witness_validate(automata, num_automata, path, size_path, &position) != WITNESS_VALID)
+        ok = false;
+    printf("%s%s: %s (%d steps).\n", instance->files[0], num_automata > 1 ? ", ..." : "", ok ? "ok" : "FAILED", size_path);
+    free(path);
+    for (int i = 0; i < num_automata; i++)
+    {
+        la_delete(automata[i]);
+        graph_delete(graphs[i]);
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    const ic3_instance instances[] = {
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_17/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_4.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_5.dot", NULL},
+         true},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", "graphs/DeadlockChecking/dining_philosophers/confucius.dot",
+          "graphs/DeadlockChecking/dining_philosophers/democrite.dot", "graphs/DeadlockChecking/dining_philosophers/epicure.dot", NULL},
+         true},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", NULL}, false},
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", NULL}, false}};
+    int num_instances = sizeof(instances) / sizeof(instances[0]);
+    int failures = 0;
+
+    // Twice in the pooled context, which must be reusable once reset, then in a context of its own.
+    for (int round = 0; round < 2; round++)
+        for (int i = 0; i < num_instances; i++)
+        {
+            failures += !check_instance(pooled_context(), &instances[i]);
+            reset_pool();
+        }
+    free_pool();
+    Z3_context ctx = make_context_rc();
+    for (int i = 0; i < num_instances; i++)
+        failures += !check_instance(ctx, &instances[i]);
+    Z3_del_context(ctx);
+
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}
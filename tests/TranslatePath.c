@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "Graph.h"
+#include "Parsing.h"
+#include "LockAutomaton.h"
+#include "LockMinimisation.h"
+#include "DeadlockExplicit.h"
+#include "DeadlockWitness.h"
+
+/**
+ * @brief An instance of the Deadlock Checking problem.
+ */
+typedef struct
+{
+    char *files[7]; ///< The automata, NULL-terminated.
+} translate_instance;
+
+/**
+ * @brief Minimises the automata of @p automata (collapsing noop chains if @p collapse_noops), looks for a shortest deadlock of the minimised automata and translates it back with lm_translate_path.
+ * The translated path must replay to a deadlock of the original automata. Without collapse, it must be a shortest deadlock of the original automata, and follow the minimised path node by node; with collapse, it can only be longer.
+ *
+ * @param automata
+ * @param num_automata
+ * @param collapse_noops
+ * @param name The name of the instance.
+ * @return true if the translation is right.
+ * @return false otherwise.
+ */
+bool check_translation(LockAutomaton *automata, int num_automata, bool collapse_noops, const char *name)
+{
+    MinimisedAutomaton minimised[num_automata];
+    LockAutomaton reduced[num_automata];
+    int nodes = 0, reduced_nodes = 0;
+    for (int i = 0; i < num_automata; i++)
+    {
+        minimised[i] = lm_minimise(automata[i], collapse_noops);
+        reduced[i] = lm_get_automaton(minimised[i]);
+        nodes += la_get_num_nodes(automata[i]);
+        reduced_nodes += la_get_num_nodes(reduced[i]);
+    }
+    step *expected_path;
+    int expected_size;
+    bool expected = deadlock_explicit_search(automata, num_automata, &expected_path, &expected_size, NULL);
+    step *path;
+    int size_path;
+    bool found = deadlock_explicit_search(reduced, num_automata, &path, &size_path, NULL);
+    bool ok = found == expected;
+    int size_translated = 0;
+    if (ok && found)
+    {
+        step *translated = lm_translate_path(minimised, num_automata, path, size_path, &size_translated);
+        if (witness_validate(automata, num_automata, translated, size_translated, NULL) != WITNESS_VALID)
+            ok = false;
+        else if (!collapse_noops)
+        {
+            ok = size_translated == size_path && size_path == expected_size;
+            for (int i = 0; i < size_translated && ok; i++)
+                ok = translated[i].automaton == path[i].automaton && lm_get_minimised_node(minimised[path[i].automaton], translated[i].target) == path[i].target;
+        }
+        else
+            ok = size_translated >= size_path;
+        free(translated);
+    }
+    printf("%s, ... (%d automata)%s: %d nodes minimised into %d, %s of %d steps translated into %d (%s).\n", name, num_automata, collapse_noops ? ", noops collapsed" : "", nodes, reduced_nodes, found ? "deadlock" : "no deadlock", size_path, size_translated, ok ? "ok" : "FAILED");
+    free(path);
+    free(expected_path);
+    for (int i = 0; i < num_automata; i++)
+        lm_delete(minimised[i]);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    const translate_instance instances[] = {
+        {{"graphs/DeadlockChecking/auto_generated/auto_17/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_17/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_4.dot", "graphs/DeadlockChecking/auto_generated/auto_17/a_5.dot", NULL}},
+        {{"graphs/DeadlockChecking/auto_generated/auto_19/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_19/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_19/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_19/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_19/a_4.dot", "graphs/DeadlockChecking/auto_generated/auto_19/a_5.dot", NULL}},
+        {{"graphs/DeadlockChecking/auto_generated/auto_7/a_0.dot", "graphs/DeadlockChecking/auto_generated/auto_7/a_1.dot", "graphs/DeadlockChecking/auto_generated/auto_7/a_2.dot",
+          "graphs/DeadlockChecking/auto_generated/auto_7/a_3.dot", "graphs/DeadlockChecking/auto_generated/auto_7/a_4.dot", NULL}},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", "graphs/DeadlockChecking/dining_philosophers/confucius.dot",
+          "graphs/DeadlockChecking/dining_philosophers/democrite.dot", "graphs/DeadlockChecking/dining_philosophers/epicure.dot", NULL}},
+        {{"graphs/DeadlockChecking/dining_philosophers/aristote.dot", "graphs/DeadlockChecking/dining_philosophers/bacon.dot", NULL}}};
+    int num_instances = sizeof(instances) / sizeof(instances[0]);
+    int failures = 0;
+    for (int i = 0; i < num_instances; i++)
+    {
+        Graph graphs[7];
+        LockAutomaton automata[7];
+        int num_automata = 0;
+        while (instances[i].files[num_automata] != NULL)
+        {
+            graphs[num_automata] = get_graph_from_file(instances[i].files[num_automata]);
+            automata[num_automata] = la_initialize(graphs[num_automata]);
+            num_automata++;
+        }
+        failures += !check_translation(automata, num_automata, false, instances[i].files[0]);
+        failures += !check_translation(automata, num_automata, true, instances[i].files[0]);
+        for (int j = 0; j < num_automata; j++)
+        {
+            la_delete(automata[j]);
+            graph_delete(graphs[j]);
+        }
+    }
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "Graph.h"
+#include "Parsing.h"
+#include "LockAutomaton.h"
+#include "DeadlockWitness.h"
+
+/**
+ * @brief A hand-built path and the verdict expected from witness_validate.
+ */
+typedef struct
+{
+    const char *name;         ///< What the path checks.
+    step steps[5];            ///< The path.
+    int size;                 ///< Its size.
+    witness_verdict expected; ///< The verdict expected.
+    int position;             ///< The position expected (step at fault, or automaton still able to move).
+} replay_case;
+
+/**
+ * @brief Checks the verdict of witness_validate on @p test.
+ *
+ * @param automata The automata the path is over.
+ * @param num_automata The number of automata.
+ * @param test The path and the verdict expected.
+ * @return true if the verdict and position are the expected ones.
+ * @return false otherwise.
+ */
+bool check_case(LockAutomaton *automata, int num_automata, const replay_case *test)
+{
+    int position;
+    witness_verdict verdict = witness_validate(automata, num_automata, test->steps, test->size, &position);
+    bool ok = verdict == test->expected && position == test->position;
+    printf("%s: %s at %d (%s).\n", test->name, witness_verdict_description(verdict), position, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    // A_0 takes lock 1 then lock 2, A_1 takes lock 2 then lock 1: acq(l) has action l, rel(l) has action -l.
+    char *files[] = {"graphs/DeadlockChecking/two_threads_two_locks/A_0.dot", "graphs/DeadlockChecking/two_threads_two_locks/A_1.dot"};
+    Graph graphs[3];
+    LockAutomaton automata[3];
+    for (int i = 0; i < 2; i++)
+    {
+        graphs[i] = get_graph_from_file(files[i]);
+        automata[i] = la_initialize(graphs[i]);
+    }
+    const replay_case cases[] = {
+        {"deadlock", {{0, 0, 1, 1}, {1, 0, 1, 2}}, 2, WITNESS_VALID, -1},
+        {"empty path", {}, 0, WITNESS_NOT_DEADLOCKED, 0},
+        {"prefix of the deadlock", {{0, 0, 1, 1}}, 1, WITNESS_NOT_DEADLOCKED, 0},
+        {"unknown automaton", {{0, 0, 1, 1}, {2, 0, 1, 2}}, 2, WITNESS_UNKNOWN_STEP, 1},
+        {"unknown node", {{0, 0, 7, 1}}, 1, WITNESS_UNKNOWN_STEP, 0},
+        {"wrong source", {{0, 0, 1, 1}, {0, 0, 1, 1}}, 2, WITNESS_WRONG_SOURCE, 1},
+        {"missing edge", {{0, 0, 2, 2}}, 1, WITNESS_MISSING_EDGE, 0},
+        {"wrong action", {{0, 0, 1, 2}}, 1, WITNESS_WRONG_ACTION, 0},
+        {"lock taken", {{0, 0, 1, 1}, {1, 0, 1, 2}, {0, 1, 2, 2}}, 3, WITNESS_LOCK_TAKEN, 2},
+        {"full round, back to the initial state", {{0, 0, 1, 1}, {0, 1, 2, 2}, {0, 2, 3, -2}, {0, 3, 0, -1}}, 4, WITNESS_NOT_DEADLOCKED, 0}};
+    int failures = 0;
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+        failures += !check_case(automata, 2, &cases[i]);
+
+    // The release of a free lock needs an automaton releasing a lock it does not hold: locks have no owner.
+    char name[] = "/tmp/releaseXXXXXX";
+    int descriptor = mkstemp(name);
+    FILE *file = fdopen(descriptor, "w");
+    fprintf(file, "digraph release{\n0 [shape=square];\n1;\n0 -> 1 [xlabel=\"rel(1)\"];\n}\n");
+    fclose(file);
+    graphs[2] = get_graph_from_file(name);
+    automata[2] = la_initialize(graphs[2]);
+    unlink(name);
+    LockAutomaton releasing[2] = {automata[0], automata[2]};
+    const replay_case release_cases[] = {
+        {"lock free", {{1, 0, 1, -1}}, 1, WITNESS_LOCK_FREE, 0},
+        {"release by its owner of a lock released by another", {{0, 0, 1, 1}, {1, 0, 1, -1}, {0, 1, 2, 2}, {0, 2, 3, -2}, {0, 3, 0, -1}}, 5, WITNESS_LOCK_FREE, 4}};
+    for (int i = 0; i < (int)(sizeof(release_cases) / sizeof(release_cases[0])); i++)
+        failures += !check_case(releasing, 2, &release_cases[i]);
+
+    for (int i = 0; i < 3; i++)
+    {
+        la_delete(automata[i]);
+        graph_delete(graphs[i]);
+    }
+    printf("%d failure(s).\n", failures);
+    return failures != 0;
+}